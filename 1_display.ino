@@ -8,8 +8,82 @@
 display functions
 drawframe(), displayLabel(), displayValue(), drawMeterScale(), displayMeter()
 invertLabel(), eraseFrame();
+setValue(), setMeter(), displayFlush() - compositor, display task draws at DISP_FPS not measure() rate
 */
 
+/*--------------------------------------  setValue() ------------------------------------------------
+record latest value for posn, drawn by displayFlush()
+only the last value before each flush is drawn
+*/
+void setValue(int posn, float curr)
+{
+	pending* pPtr = &dispQue[posn];
+
+	if (!frs.isEnable[posn]) return;
+
+	pPtr->curr = curr;
+	pPtr->isMeter = false;
+	pPtr->isDirty = (curr != val[posn].prevValue) || val[posn].isUpdate;
+#if !DISP_COMPOSE
+	displayFlush();
+#endif
+}
+
+/*--------------------------------------  setMeter() ------------------------------------------------
+record latest meter value and peak for posn, drawn by displayFlush()
+*/
+void setMeter(int posn, float curr, float peak)
+{
+	pending* pPtr = &dispQue[posn];
+
+	if (!frs.isEnable[posn]) return;
+
+	if (curr != val[posn].prevValue || peak != pPtr->peak)
+		pPtr->isDirty = true;							// stays set until drawn
+	pPtr->curr = curr;
+	pPtr->peak = peak;
+	pPtr->isMeter = true;
+#if !DISP_COMPOSE
+	displayFlush();
+#endif
+}
+
+/*--------------------------------------  displayFlush() --------------------------------------------
+draws changed frames in one batch. no frame started after DISP_SLICE, so a pass is DISP_SLICE
+plus one frame (restore and value). frames to restore first, then changed values from the frame
+the last pass stopped at, so none waits more than a few passes
+Called by: display task, every 1 / DISP_FPS secs
+*/
+void displayFlush()
+{
+	PROFILE_ZONE(PZ_DISPFLUSH);
+
+	static int next;										// first changed value of this pass
+	unsigned long start = micros();
+
+	for (int k = 0; k < 2 * NUM_FRAMES; k++)
+	{
+		int i = (k < NUM_FRAMES) ? k : (next + k) % NUM_FRAMES;
+		pending* pPtr = &dispQue[i];
+
+		if (k < NUM_FRAMES ? !pPtr->isRestore : !pPtr->isDirty)
+			continue;
+		if (micros() - start > DISP_SLICE)
+		{
+			next = i;										// pass full
+			return;
+		}
+		if (pPtr->isRestore && frs.isEnable[i])
+			restoreFrame(i);								// forces value redraw, not if erased since
+		pPtr->isRestore = false;
+		if (pPtr->isMeter)
+			displayMeter(i, pPtr->curr, pPtr->peak);
+		else
+			displayValue(i, pPtr->curr);		// clears isDirty
+		pPtr->isDirty = false;
+	}
+}
+
 /*--------------------------------------  displayLabel() --------------------------------------------
 display frame and lable at posn
  Calls:	displayLabelStr()
@@ -26,17 +100,17 @@ Calls:	drawFrame()
 void displayLabelStr(int posn, char* txt)
 {
 	int x, y;
-	frame* fPtr = &fr[posn];
+	const frame* fPtr = &fr[posn];
 	label* lPtr = &lab[posn];
 
-	if (!fPtr->isEnable) return;							// check enabled
+	if (!frs.isEnable[posn]) return;						// check enabled
 
 	// draw associated frame
 	drawFrame(posn);
 
 	// set label txt colour and font size
 	tft.setTextColor(lPtr->colour);
-	tft.setFont(lPtr->font);
+	tft.setFont(*lPtr->font);
 
 	// horizontal justify label position in frame
 	switch (lPtr->xJustify)
@@ -59,11 +133,11 @@ void displayLabelStr(int posn, char* txt)
 		y = fPtr->y + GAP;
 		break;
 	case 'M':												// middle of frame
-		y = fPtr->y + (fPtr->h - lPtr->font.cap_height) / 2;
+		y = fPtr->y + (fPtr->h - lPtr->font->cap_height) / 2;
 		break;
 	case 'B':												// bottom, default
 	default:
-		y = fPtr->y + fPtr->h - GAP - lPtr->font.cap_height;
+		y = fPtr->y + fPtr->h - GAP - lPtr->font->cap_height;
 		break;
 	}
 
@@ -75,71 +149,65 @@ void displayLabelStr(int posn, char* txt)
 /*------------------------------  displayValue() --------------------------------------------------
 updates value if changed from previous.
 use value.updateflg = true to force update
-Calls:	dtostrf()  - decimal to string formatted
+value formatted as integer fixed point, width from glyph cache.
+only characters from the first change are erased and redrawn, from glyph cells if font has them
+Calls:	fmtValue(), glyphFind(), glyphLen(), glyphDraw()
 */
 void displayValue(int posn, float curr)						// frame position, float current value to display
 {
-	frame* fPtr = &fr[posn];
+	PROFILE_ZONE(PZ_DISPVALUE);
+
+	const frame* fPtr = &fr[posn];
 	value* vPtr = &val[posn];
 	label* lPtr = &lab[posn];
-	int x, xp, y;
-	const int buffSize = 10;								// char buffer size
-	char strCurr[buffSize + 1],								// char buffers for converted string
-		strPrev[buffSize + 1],
-		strKeep[buffSize + 1];
+	glyphCache* gPtr;
+	int x, xp, y, k;
+	char strCurr[VAL_DIGITS + 1],							// char buffers for converted string
+		strPrev[VAL_DIGITS + 1];
 	int pixLenCurr, pixLenPrev, pixLenLabel, pixLenKeep;	// pixel lentghs of string values
 
-	// return if disabled
-	if (!fPtr->isEnable) return;
+	dispQue[posn].isDirty = false;							// drawn now, supersedes pending value
 
-	tft.setFont(vPtr->font);								// set font attribs
-	tft.setTextColor(vPtr->colour);
+	// return if disabled
+	if (!frs.isEnable[posn]) return;
 
-	// convert float values to strings
-	int digits = 0;
-	dtostrf(vPtr->prevValue, digits, vPtr->decs, strPrev); 	// convert prevValue to char txt
-	dtostrf(curr, digits, vPtr->decs, strCurr);   			// convert float to char txt
+	// convert float values to fixed point strings
+	fmtValue(strPrev, vPtr->prevValue, vPtr->decs);
+	fmtValue(strCurr, curr, vPtr->decs);
 	if (!vPtr->isUpdate)									// update not forced
 		if (!strcmp(strPrev, strCurr))
 			return;											// return if no change in value - reduces flicker
 
-	/*
-		compare strings left to right. strKeep[] will contain matching character/digits
-		use pixel length of strKeep to calculate blanking rectangle  ie - remaning digits to right
-		In case 123.00 is confused with 12.3, check the num of digits to left of decimal
-	*/
-
-	// initialise keep buffer - this the left->right Value string to keep.
-	for (int i = 0; i < buffSize; i++)
-		strKeep[i] = '\0';
+	tft.setFont(*vPtr->font);								// set font attribs
+	tft.setTextColor(vPtr->colour);
 
-	for (int i = 0; i < buffSize; i++)
-	{		// compare prev to current
-		if (strPrev[i] == strCurr[i])
-			strKeep[i] = strPrev[i];						// strKeep = Prev if curr different to previous
-	}
+	// first changed character. chars to left are same in both strings
+	for (k = 0; strPrev[k] && strPrev[k] == strCurr[k]; k++)
+		;
 
 	// pixel length of value strings
-	pixLenCurr = tft.strPixelLen(strCurr);
-	pixLenPrev = tft.strPixelLen(strPrev);
-	pixLenKeep = tft.strPixelLen(strKeep);
-	// different values with same start digit cause problems with erase, eg 10.23 ans 100.34
-	// compare first characters and stricng lengths
-	if (strPrev[0] == strCurr[0] && pixLenPrev != pixLenCurr) pixLenKeep = 0;
+	gPtr = glyphFind(*vPtr->font);
+	pixLenCurr = glyphLen(gPtr, strCurr, VAL_DIGITS);
+	pixLenPrev = glyphLen(gPtr, strPrev, VAL_DIGITS);
+	pixLenKeep = glyphLen(gPtr, strCurr, k);
 
 	// check for label position.  adjust value to be middle of free space
 	// vertical text justify
-	y = fPtr->y + (fPtr->h - vPtr->font.cap_height) / 2;
+	y = fPtr->y + (fPtr->h - vPtr->font->cap_height) / 2;
 	if (lPtr->yJustify == 'T')
-		y = y + lPtr->font.cap_height / 2;
+		y = y + lPtr->font->cap_height / 2;
 	if (lPtr->yJustify == 'B')
-		y = y - lPtr->font.cap_height / 2;
+		y = y - lPtr->font->cap_height / 2;
 
 	// set x, xp depending on xJustify and label position.
 	// x is current value position, xp is previous value
-	tft.setFont(lPtr->font);								// set label font
-	pixLenLabel = tft.strPixelLen(lPtr->txt);				// get label length
-	tft.setFont(vPtr->font);								// reset to value font
+	pixLenLabel = 0;
+	if (lPtr->xJustify == 'L' || lPtr->xJustify == 'R')
+	{
+		tft.setFont(*lPtr->font);							// set label font
+		pixLenLabel = tft.strPixelLen(lPtr->txt);			// get label length
+		tft.setFont(*vPtr->font);							// reset to value font
+	}
 
 	// label text centred
 	x = fPtr->x + (fPtr->w - pixLenCurr) / 2;
@@ -159,14 +227,39 @@ void displayValue(int posn, float curr)						// frame position, float current va
 		xp = fPtr->x + (fPtr->w - pixLenLabel - pixLenPrev) / 2;
 	}
 
-	//Erase previous value from first digit change
-	tft.fillRect(xp - 2 + pixLenKeep, y - 2,				// fill rectangle from pixLenKeep
-		pixLenPrev - pixLenKeep + 2,
-		vPtr->font.cap_height + 5, fPtr->bg);
+	// string moved (width changed) or forced, redraw all
+	if (x != xp || vPtr->isUpdate)
+	{
+		k = 0;
+		pixLenKeep = 0;
+	}
 
-	// update current value.  overprint entire string.  Not worth trying to print only erased portion
-	tft.setCursor(x, y);
-	tft.print(strCurr);
+	// erase previous value from first changed character, margin if whole string
+	// glyph cells draw their background, only previous string and margin outside the new one are erased
+	if (gPtr && gPtr->bmp)
+	{
+		int xl = (k == 0) ? xp - 2 : x,						// erased region, previous string
+			xr = (k == 0) ? xp + pixLenPrev + 2 : x + pixLenPrev;
+
+		if (x > xl)
+			tft.fillRect(xl, y - 2, x - xl, gPtr->h, frs.bg[posn]);
+		if (xr > x + pixLenCurr)
+			tft.fillRect(x + pixLenCurr, y - 2, xr - x - pixLenCurr, gPtr->h, frs.bg[posn]);
+	}
+	else if (k == 0)
+		tft.fillRect(xp - 2, y - 2, pixLenPrev + 4, vPtr->font->cap_height + 5, frs.bg[posn]);
+	else if (pixLenPrev > pixLenKeep)
+		tft.fillRect(xp + pixLenKeep, y - 2, pixLenPrev - pixLenKeep + 2, vPtr->font->cap_height + 5, frs.bg[posn]);
+
+	// draw changed characters only
+	if (gPtr && gPtr->bmp)
+		glyphDraw(gPtr, &strCurr[k], x + pixLenKeep, y, vPtr->colour, frs.bg[posn]);
+	else
+	{
+		tft.setCursor(x + pixLenKeep, y);
+		tft.print(&strCurr[k]);
+	}
+	traceDigest(posn, strCurr, strlen(strCurr));
 
 	// save to previous value
 	vPtr->prevValue = curr;
@@ -174,6 +267,226 @@ void displayValue(int posn, float curr)						// frame position, float current va
 	vPtr->isUpdate = false;
 }
 
+/*------------------------------  fmtValue() --------------------------------------------------
+formats v with decs decimals, integer arithmetic. same text as dtostrf(v, 0, decs)
+buff: at least VAL_DIGITS + 1 chars
+*/
+void fmtValue(char* buff, float v, int decs)
+{
+	static const uint32_t pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+	char tmp[VAL_DIGITS + 1];
+	int n = 0, i = 0;
+	bool isNeg = v < 0;
+	uint32_t u;
+
+	decs = constrain(decs, 0, 6);
+	if (isNeg)
+		v = -v;
+	v = v * pow10[decs] + 0.5;								// fixed point, rounded
+	u = (v < 99999999.0) ? (uint32_t)v : 99999999;			// clamp, 8 digits fit with '.' and '-'
+	if (u == 0)
+		isNeg = false;										// no "-0"
+
+	// digits right to left, decimal point after decs digits
+	do
+	{
+		tmp[n++] = '0' + u % 10;
+		u /= 10;
+		if (n == decs)
+			tmp[n++] = '.';
+	} while ((u || n < (decs ? decs + 2 : 1)) && n < VAL_DIGITS - 1);	// leading zero, room for '-'
+
+	if (isNeg)
+		buff[i++] = '-';
+	while (n)
+		buff[i++] = tmp[--n];
+	buff[i] = '\0';
+}
+
+/*------------------------------  glyphFind() --------------------------------------------------
+glyph cache for font, measures and adds font on first use. glyph cells for large fonts
+Returns: cache entry, NULL if cache full
+*/
+glyphCache* glyphFind(const ILI9341_t3_font_t& font)
+{
+	char str[2] = { 0, 0 };
+
+	for (int i = 0; i < NUM_GLYPH_FONTS; i++)
+	{
+		glyphCache* gPtr = &glyphs[i];
+
+		if (gPtr->data == font.data)
+			return gPtr;
+		if (gPtr->data == NULL)								// new font, measure glyphs
+		{
+			tft.setFont(font);
+			for (int j = 0; j < NUM_GLYPHS; j++)
+			{
+				str[0] = GLYPH_CHARS[j];
+				gPtr->adv[j] = tft.strPixelLen(str);
+			}
+			gPtr->data = font.data;
+			if (font.cap_height >= GLYPH_BMP_CAP)
+				glyphRender(gPtr, font);
+			return gPtr;
+		}
+	}
+	return NULL;
+}
+
+/*------------------------------  glyphLen() --------------------------------------------------
+pixel length of first n chars of str, from glyph cache
+uses strPixelLen() (current font) for chars not in cache or no cache
+*/
+int glyphLen(glyphCache* gPtr, const char* str, int n)
+{
+	char tmp[VAL_DIGITS + 1];
+	int len = 0;
+
+	if (gPtr)
+	{
+		int i;
+		for (i = 0; i < n && str[i]; i++)
+		{
+			const char* c = strchr(GLYPH_CHARS, str[i]);
+			if (!c)
+				break;
+			len += gPtr->adv[c - GLYPH_CHARS];
+		}
+		if (i == n || !str[i])
+			return len;										// all from cache
+	}
+
+	// fall back, measure with font
+	strncpy(tmp, str, VAL_DIGITS);
+	tmp[constrain(n, 0, VAL_DIGITS)] = '\0';
+	return tft.strPixelLen(tmp);
+}
+
+/*------------------------------  glyphRender() --------------------------------------------------
+decodes GLYPH_CHARS of font into 1 bit per pixel cells. ILI9341_t3 packed font format, as drawFontChar()
+cell top row is 2 pixels above the text cursor, as the displayValue() erase. ink outside the cell is clipped
+no cells (bmp NULL) if glyphPool is full
+*/
+void glyphRender(glyphCache* gPtr, const ILI9341_t3_font_t& font)
+{
+	int size = 0, off = 0;
+
+	gPtr->h = font.cap_height + 5;
+	for (int j = 0; j < NUM_GLYPHS; j++)
+		size += (gPtr->adv[j] + 7) / 8 * gPtr->h;
+	if (glyphPoolUsed + size > GLYPH_POOL)
+		return;
+	gPtr->bmp = &glyphPool[glyphPoolUsed];
+	glyphPoolUsed += size;
+	memset(gPtr->bmp, 0, size);
+
+	for (int j = 0; j < NUM_GLYPHS; j++)
+	{
+		int rowBytes = (gPtr->adv[j] + 7) / 8;
+		uint8_t* cell = gPtr->bmp + off;
+		const uint8_t* data = fontGlyph(font, GLYPH_CHARS[j]);
+		uint32_t bit = 3;									// after encoding
+		int width, height, xoffset, yoffset, top, line = 0;
+
+		gPtr->cell[j] = off;
+		off += rowBytes * gPtr->h;
+		if (!data)
+			continue;										// not in font, blank cell
+
+		width = fontBits(data, bit, font.bits_width);
+		bit += font.bits_width;
+		height = fontBits(data, bit, font.bits_height);
+		bit += font.bits_height;
+		xoffset = fontBitsSigned(data, bit, font.bits_xoffset);
+		bit += font.bits_xoffset;
+		yoffset = fontBitsSigned(data, bit, font.bits_yoffset);
+		bit += font.bits_yoffset + font.bits_delta;
+		top = font.cap_height - height - yoffset + 2;		// cell row of first glyph line
+
+		while (line < height)
+		{
+			int n = 1;										// lines with these bits
+
+			if (fontBits(data, bit++, 1))					// repeated line
+			{
+				n = fontBits(data, bit, 3) + 2;
+				bit += 3;
+			}
+			for (int r = top + line; r < top + line + n; r++)
+				for (int x = 0; x < width; x++)
+				{
+					int cx = xoffset + x;
+					if (r >= 0 && r < gPtr->h && cx >= 0 && cx < gPtr->adv[j] && fontBits(data, bit + x, 1))
+						cell[r * rowBytes + cx / 8] |= 0x80 >> (cx & 7);
+				}
+			bit += width;
+			line += n;
+		}
+	}
+}
+
+/*------------------------------  glyphDraw() --------------------------------------------------
+draws str from glyph cells, text cursor at x, y. one writeRect1BPP() per char, background included
+str: GLYPH_CHARS only, as fmtValue()
+Returns: pixel length drawn
+*/
+int glyphDraw(glyphCache* gPtr, const char* str, int x, int y, uint16_t colour, uint16_t bg)
+{
+	uint16_t palette[2] = { bg, colour };					// bit 0 background, 1 ink
+	int x0 = x;
+
+	for (; *str; str++)
+	{
+		const char* c = strchr(GLYPH_CHARS, *str);
+		if (!c)
+			break;
+		int j = c - GLYPH_CHARS;
+		tft.writeRect1BPP(x, y - 2, gPtr->adv[j], gPtr->h, gPtr->bmp + gPtr->cell[j], palette);
+		x += gPtr->adv[j];
+	}
+	return x - x0;
+}
+
+/*------------------------------  fontGlyph() --------------------------------------------------
+Returns: packed glyph data of char c in font, NULL if not in font or not a supported encoding
+*/
+const uint8_t* fontGlyph(const ILI9341_t3_font_t& font, unsigned int c)
+{
+	uint32_t bitoffset;
+	const uint8_t* data;
+
+	if (c >= font.index1_first && c <= font.index1_last)
+		bitoffset = (c - font.index1_first) * font.bits_index;
+	else if (c >= font.index2_first && c <= font.index2_last)
+		bitoffset = (c - font.index2_first + font.index1_last - font.index1_first + 1) * font.bits_index;
+	else
+		return NULL;
+	data = font.data + fontBits(font.index, bitoffset, font.bits_index);
+	return fontBits(data, 0, 3) == 0 ? data : NULL;
+}
+
+/*------------------------------  fontBits() --------------------------------------------------
+n bits from bit index of p, MSB first. fontBitsSigned(): two's complement
+*/
+uint32_t fontBits(const uint8_t* p, uint32_t index, int n)
+{
+	uint32_t v = 0;
+
+	for (int i = 0; i < n; i++, index++)
+		v = (v << 1) | ((p[index >> 3] >> (7 - (index & 7))) & 1);
+	return v;
+}
+
+int32_t fontBitsSigned(const uint8_t* p, uint32_t index, int n)
+{
+	uint32_t v = fontBits(p, index, n);
+
+	if (n == 0)
+		return 0;
+	return (v & (1UL << (n - 1))) ? (int32_t)v - (1L << n) : (int32_t)v;
+}
+
 /*---------------------------------  displayMeter() --------------------------------------------
 Draws the meter bar in the frame
 	indicator is used to show peak power.
@@ -182,9 +495,11 @@ Draws the meter bar in the frame
 */
 void displayMeter(int posn, float curr, float peak)
 {
-	frame* fPtr = &fr[posn];								// display value in this frame
+	PROFILE_ZONE(PZ_DISPMETER);
+
+	const frame* fPtr = &fr[posn];							// display value in this frame
 	value* vPtr = &val[posn];
-	meter* mPtr = &mtr[posn - nettPwrMeter];				// adjust for array position
+	const meter* mPtr = &mtr[posn - nettPwrMeter];			// adjust for array position
 	int yb;													// meter base line y co-ord
 	int ym;													// y co-ord for meter bar
 	int x, xPeak;											// x c-ords
@@ -192,12 +507,14 @@ void displayMeter(int posn, float curr, float peak)
 	int thick;
 	int span;
 
+	dispQue[posn].isDirty = false;							// drawn now, supersedes pending value
+
 	// if frame disabled return
-	if (!fPtr->isEnable) return;
+	if (!frs.isEnable[posn]) return;
 
 	x = fPtr->x + mPtr->xGap + 5;											// match scale start position
 	span = fPtr->w - 2 * mPtr->xGap - 5;									// adjust for GAP to frame
-	yb = fPtr->y + fPtr->h - mPtr->font.cap_height - mPtr->yGap - 7;		// baseline Y for meter scale (same as drawMeterScale)
+	yb = fPtr->y + fPtr->h - mPtr->font->cap_height - mPtr->yGap - 7;		// baseline Y for meter scale (same as drawMeterScale)
 
 	wCurr = map(curr, mPtr->sStart, mPtr->sEnd, 0, span);					// scale for main value
 	wPrev = map(vPtr->prevValue, mPtr->sStart, mPtr->sEnd, 0, span);		// scale for previous value
@@ -209,14 +526,14 @@ void displayMeter(int posn, float curr, float peak)
 
 	// erase previous peak indicator value before drawing power
 	xPeak = x + wPeak - mPtr->pkWidth;										// for indicator
-	if (mPtr->pkPrevPosn != xPeak)
-		tft.fillRect(mPtr->pkPrevPosn, ym, mPtr->pkWidth, thick, mPtr->bColour);	// erase indicator if not same as previous
+	if (mtrPkPosn[posn - nettPwrMeter] != xPeak)
+		tft.fillRect(mtrPkPosn[posn - nettPwrMeter], ym, mPtr->pkWidth, thick, mPtr->bColour);	// erase indicator if not same as previous
 
 	// draw meter, erase only changed meter value
 	wCurr -= mPtr->pkWidth;													// adjust for peak indicator width
 	wPrev -= mPtr->pkWidth;
 	if (wCurr < wPrev)														// chech if curr < prev ...
-		tft.fillRect(x + wCurr, ym, wPrev - wCurr, thick, fPtr->bg);		// ... erase difference
+		tft.fillRect(x + wCurr, ym, wPrev - wCurr, thick, frs.bg[posn]);	// ... erase difference
 	else
 		//draw new meter value if curr > prev.  draws start line if wCurr = wPrev
 		tft.fillRectVGradient(x + wPrev, ym, wCurr - wPrev, thick, mPtr->tColour, mPtr->bColour);
@@ -227,7 +544,11 @@ void displayMeter(int posn, float curr, float peak)
 
 	// save current values to previous
 	vPtr->prevValue = curr;
-	mPtr->pkPrevPosn = xPeak;
+	mtrPkPosn[posn - nettPwrMeter] = xPeak;
+	{
+		int16_t bar[2] = { (int16_t)wCurr, (int16_t)xPeak };
+		traceDigest(posn, bar, sizeof(bar));
+	}
 }
 
 /*---------------------------------  drawMeterScale() ----------------------------------------------
@@ -237,24 +558,24 @@ draws scale for meter.
 */
 void drawMeterScale(int posn)
 {
-	frame* fPtr = &fr[posn];
-	meter* mPtr = &mtr[posn - nettPwrMeter];
+	const frame* fPtr = &fr[posn];
+	const meter* mPtr = &mtr[posn - nettPwrMeter];
 	int x, xs; 												// x co-ords, xs scale co-ord
 	int y, yTxt, yLine;										// y co-ords for text and line
 	int span;												// pixel span of meter
 	float scale = mPtr->sEnd - mPtr->sStart;				// get scale factor
 
-	if (!fPtr->isEnable)
+	if (!frs.isEnable[posn])
 		return;
 
 	tft.setTextColor(mPtr->colour);
-	tft.setFont(mPtr->font);								// set font attribs
+	tft.setFont(*mPtr->font);								// set font attribs
 
 	span = fPtr->w - 2 * mPtr->xGap;						// adjust for GAP to frame
 	x = fPtr->x + mPtr->xGap;
 	y = fPtr->y + fPtr->h - mPtr->yGap;						// base Y for meter (bottom)
 
-	yTxt = y - mPtr->font.cap_height - 2;					// y coord for scale text
+	yTxt = y - mPtr->font->cap_height - 2;					// y coord for scale text
 	yLine = yTxt - 5;										// y coord for line (allow two rows text)
 
 	// draw base line
@@ -295,8 +616,8 @@ void invertLabel(int posn)
 {
 	int col;
 
-	col = fr[posn].bg;										// save bg colour
-	fr[posn].bg = lab[posn].colour;							// swap colour
+	col = frs.bg[posn];										// save bg colour
+	frs.bg[posn] = lab[posn].colour;						// swap colour
 	lab[posn].colour = col;
 	displayLabel(posn);										// draw label
 }
@@ -307,13 +628,13 @@ draws frame if enabled, fills background colour and draws outline
 */
 void drawFrame(int posn)
 {
-	frame* fPtr = &fr[posn];
+	const frame* fPtr = &fr[posn];
 
 	// draw frame if enabled
-	if (fPtr->isEnable)
+	if (frs.isEnable[posn])
 	{
 		// filled rectangle
-		tft.fillRoundRect(fPtr->x, fPtr->y, fPtr->w, fPtr->h, RADIUS, fPtr->bg);
+		tft.fillRoundRect(fPtr->x, fPtr->y, fPtr->w, fPtr->h, RADIUS, frs.bg[posn]);
 		// draw outline
 		if (fPtr->isOutLine)
 			tft.drawRoundRect(fPtr->x, fPtr->y, fPtr->w, fPtr->h, RADIUS, LINE_COLOUR);
@@ -325,8 +646,8 @@ void drawFrame(int posn)
 */
 void eraseFrame(int posn)
 {
-	fr[posn].isEnable = false;							// disable flags
-	fr[posn].isTouch = false;
+	frs.isEnable[posn] = false;							// disable flags
+	frs.isTouch[posn] = false;
 	// fill inside frame with background
 	tft.fillRoundRect(fr[posn].x, fr[posn].y,			// erase frame - fill with background colour
 		fr[posn].w, fr[posn].h, RADIUS, BG_COLOUR);
@@ -335,13 +656,12 @@ void eraseFrame(int posn)
 /*--------------------------------  restoreFrame() -------------------------------------------------
 arg: frame position
 restores frame after possible mess up such as font change, or overwite by other data
+no erase first, drawFrame() fills the same rounded rectangle. displayLabel() draws the frame, once
 */
 void restoreFrame(int posn)
 {
-	eraseFrame(posn);									// erases and disables frame
-	fr[posn].isEnable = true;							// enable flags
-	fr[posn].isTouch = true;
-	drawFrame(posn);									// redraw frame
-	displayLabel(posn);									// redisplay label
+	frs.isEnable[posn] = true;							// enable flags
+	frs.isTouch[posn] = true;
+	displayLabel(posn);									// redraw frame and label
 	val[posn].isUpdate = true;							// force value redraw
 }
\ No newline at end of file
@@ -7,56 +7,132 @@
 /*------------------------------------------------------------------------------------------
    XPT2046 touch functions
    Uses XPT2046 interrupts, check for a touch (ts.tirqTouched())
-   Interrupt driven - only get here if screen touched
+   touchChk() / touchPoll() non-blocking gesture state machine for main screen
+   touch() blocking, for option screens
 */
 
 /*-------------------------------- touchChk() -----------------------------------------------------------
-checks for touch on enabled frames
-arg: num of frames
+checks for touch on enabled frames. doesn't wait, call every loop
+touch while dimmed only resets dimmer
 */
 void touchChk()
 {
-	int x = 0, y = 0;							// local variables
-	TS_Point p;									// touch screen result structure
-	int tStatus;								// 0= not touched, 1 = shorttouch, 2 = longtouch,
-	bool isTouch = false;
+	PROFILE_ZONE(PZ_TOUCH);
+
+	int tEvent = touchPoll();
+
+	if (tEvent != TOUCH_NONE)
+		touchEvent(touchFrame, tEvent);
+}
+
+/*-------------------------------- touchEvent() -----------------------------------------------------------
+act on touch event in frame. trace replay calls this with recorded events
+*/
+void touchEvent(int frame, int tEvent)
+{
+	uint8_t ev[2] = { (uint8_t)frame, (uint8_t)tEvent };
 
-	//tStatus = 1;								// default short touch. 0= not touched, 1 = shorttouch, 2 = longtouch
+	traceRec(TRC_TOUCH, ev, 2);
+	if (tEvent == TOUCH_PRESS && isDim)
+	{
+		resetDimmer();							// reset dimmer
+		touchState = TOUCH_HELD;				// ignore rest of touch
+	}
+	else if ((tEvent == TOUCH_TAP || tEvent == TOUCH_LONG) && frame >= 0)
+		touchActions(frame, tEvent);
+}
+
+/*-------------------------------- touchPoll() -----------------------------------------------------------
+touch gesture state machine, one step per call
+Returns: TOUCH_NONE, TOUCH_PRESS (first contact), TOUCH_TAP (released before longTouchTimer),
+TOUCH_LONG (still touched at longTouchTimer). touchFrame is frame touched, -1 if none
+*/
+int touchPoll()
+{
+	TS_Point p;									// touch screen result structure
 
-	do
+	switch (touchState)
 	{
-		tStatus = touch();						// check for touch
-		if (!tStatus) 							// tStatus: 0 = no touch, 1 = touched, 2 = long touch
-			return;
-		p = ts.getPoint();						// get position result
+	case TOUCH_IDLE:
+		if (ts.tirqTouched() && ts.touched())	// interrupt, then +ve touch
+		{
+			p = ts.getPoint();					// get position result
+			touchFrame = touchHit(MAPX, MAPY);
+			longTouchTimer.reset();				// Metro timer
+			touchState = TOUCH_DOWN;
+			return TOUCH_PRESS;
+		}
+		break;
+
+	case TOUCH_DOWN:
+		if (!ts.touched())
+		{
+			touchState = TOUCH_IDLE;
+			return TOUCH_TAP;
+		}
+		if (longTouchTimer.check())
+		{
+			touchState = TOUCH_HELD;
+			return TOUCH_LONG;
+		}
+		break;
+
+	case TOUCH_HELD:
+	default:
+		if (!ts.touched())						// wait for release
+			touchState = TOUCH_IDLE;
+		break;
+	}
+	return TOUCH_NONE;
+}
+
+/*-------------------------------- touchHit() -----------------------------------------------------------
+frame at screen position x, y. grid cell gives candidate frames,
+first touch enabled frame containing x, y is used (similar posn frames)
+Returns: frame, -1 if none
+*/
+int touchHit(int x, int y)
+{
+	uint32_t cell;
 
-		// map(value, fromLow, fromHigh, toLow, toHigh). defined in touchOptions.h
-		x = map(p.x, xMapL, xMapR, 0, 320);
-		y = map(p.y, yMapT, yMapB, 0, 240);
+	if (x < 0 || x >= TOUCH_COLS * TOUCH_CELL || y < 0 || y >= TOUCH_ROWS * TOUCH_CELL)
+		return -1;
 
-		// get frame that was touched
-		for (int i = 0; i <= NUM_FRAMES; i++)				// for all frames
+	cell = touchCells[y / TOUCH_CELL][x / TOUCH_CELL];
+	for (int i = 0; cell; i++, cell >>= 1)
+	{
+		if (!(cell & 1) || !frs.isTouch[i])
+			continue;
+		if (x > fr[i].x && x < (fr[i].x + fr[i].w)		// x,y between frame width and height
+			&& y > fr[i].y && (y < fr[i].y + fr[i].h))
+			return i;
+	}
+	return -1;
+}
+
+/*-------------------------------- touchGrid() -----------------------------------------------------------
+builds hit test grid from fr[] positions. call after frame layout change (initDisplay())
+enable/touch flags are checked by touchHit(), not here
+*/
+void touchGrid()
+{
+	for (int r = 0; r < TOUCH_ROWS; r++)
+		for (int c = 0; c < TOUCH_COLS; c++)
 		{
-			if (x > fr[i].x && x < (fr[i].x + fr[i].w)		// x,y between frame width and height
-				&& y > fr[i].y && (y < fr[i].y + fr[i].h))
+			int x = c * TOUCH_CELL, y = r * TOUCH_CELL;
+
+			touchCells[r][c] = 0;
+			for (int i = 0; i < NUM_FRAMES; i++)
 			{
-				// touch enabled frame? break on first occurance for similar posn frames
-				if (fr[i].isTouch)
-				{
-					touchActions(i, tStatus);
-					isTouch = true;
-					break;
-				}
+				if (fr[i].x < x + TOUCH_CELL && fr[i].x + fr[i].w > x		// frame overlaps cell
+					&& fr[i].y < y + TOUCH_CELL && fr[i].y + fr[i].h > y)
+					touchCells[r][c] |= 1UL << i;
 			}
 		}
-	} while (!isTouch);
-
-	// empty touch buffer for excess long touch
-	while (ts.touched());
 }
 
 /*------------------------------- touched() ------------------------------------------------------------
-check for screen touch
+check for screen touch, waits for release or long touch. used by option screens
 returns 0 = no touch, 1 = short touch, 2 = long touch
 */
 int touch()
@@ -109,12 +185,22 @@ void touchActions(int button, int tStat)				// touch actions for frame i, touch
 		break;
 
 	case nettPwrMeter:							// swap with swrmeter
+		if (tStat == LONGTOUCH)
+		{
+			histStart();						// long press, power / swr trend graph
+			break;
+		}
 		eraseFrame(nettPwrMeter);
 		restoreFrame(swrMeter);
 		drawMeterScale(swrMeter);
 		break;
 
 	case swrMeter:								// swap with nettPwrMeter
+		if (tStat == LONGTOUCH)
+		{
+			sweepStart();						// long press, SWR sweep of current band
+			break;
+		}
 		eraseFrame(swrMeter);
 		restoreFrame(nettPwrMeter);
 		drawMeterScale(nettPwrMeter);
@@ -158,6 +244,25 @@ void touchActions(int button, int tStat)				// touch actions for frame i, touch
 		sRefButton(tStat);
 		break;
 
+	case sweepGraph:							// stop sweep, back to meters
+		sweepStop();
+		initDisplay();
+		break;
+
+	case trendGraph:							// swap 10 min / 12 hrs, long press back to meters
+		if (tStat == LONGTOUCH)
+			initDisplay();
+		else
+			histShow(histView == HIST_SEC ? HIST_MIN : HIST_SEC);
+		break;
+
+	case fwdPwr:								// calMode, add / clear band cal points
+	case refPwr:
+	case fwdVolts:
+	case refVolts:
+		calButton(button, tStat);
+		break;
+
 	default:									// default - do nothin
 		break;
 	}
@@ -9,171 +9,200 @@
    calculates forward, reflected power, nett power, peak envelope power
    peak power calculated and held for 3-4 secs
    swr calculated from fwd and reflected power
+   one pass per call, scheduler measure task. doesn't wait for power off
    Calls: pwrCalc()
 */
 void measure()
 {
-	unsigned long cr0, cr1, cr0Pk, cr1Pk;
+	PROFILE_ZONE(PZ_MEASURE);
+
+	adcChan* cPtr = &chan[CH_MAIN];						// meters show main coupler
+	uint32_t fmW, rmW, fPkmW, rPkmW, nmW;				// fixed point powers (milliWatts)
 	float fVolts, rVolts, fPkVolts, rPkVolts;
 	float fPwr, rPwr, nPwr,								// calculated forward, reflected, nett power
 		fPkPwr, rPkPwr, pep,							// pep powers
 		dbm = 0,										// dBm
 		swrV = 1.0;										// vSWR calculated from voltage
-	float pkPwr = 0;									// PEAK POWER
+	static float pkPwr = 0;								// PEAK POWER, held between passes while power on
+	static bool isPwrOn = false;						// power on last pass
 
-	lab[nettPwr].stat = true;							// set true for nettPwr colour change
+	// r0, r1 etc are measured independantly by timer interrupt function getADC()
+	// come here to check results
+	setADCWindows();								// window sizes follow samples params, no reset
+	for (int c = 0; c < NUM_CHANS; c++)
+		chanCalc(c);								// every coupler, same window
 
-	do
+	// voltage calculations
 	{
-		// r0, r1 etc are measured independantly by timer interrupt function getADC()
-		// come here to check results
-		initADCSamples();								// check if cyclic buffers need initialised (samplesAvg change)
-
-		// get ACD reults
-		noInterrupts();									// stop interrupts while copying data
-		cr1 = buf1Tot;									// buffer totals
-		cr0 = buf0Tot;
-		cr1Pk = buf1Pk;
-		cr0Pk = buf0Pk;
-		interrupts();									// restart interrupts
-
-		// voltage calculations
-		{
-			fVolts = cr1 * 3.3 / adc->adc0->getMaxValue() / samplesAvg + FV_ZEROADJ;		// fwd volts zero Adjusted
-			rVolts = cr0 * 3.3 / adc->adc1->getMaxValue() / samplesAvg + RV_ZEROADJ;		// ref volts zero adjusted
-			fPkVolts = cr1Pk * 3.3 / adc->adc0->getMaxValue() + FV_ZEROADJ;	// fwd volts peak
-			rPkVolts = cr0Pk * 3.3 / adc->adc1->getMaxValue() + RV_ZEROADJ;	// ref volts peak
-		}
-		//calculate power via rms voltage
-		//fPwr = pwrRmsCalc(vf);
-		//rPwr = pwrRMSCalc(vr);
-		//fPkPwr = pwrRmsCalc(vfp);
-		//rPkPwr = pwrRmsCalc(vrp);
-
-		//calculate power directly from volts
-		fPwr = pwrCalc(fVolts, 'F');					//  fwd volts
-		rPwr = pwrCalc(rVolts, 'R');					//  ref volts
-		fPkPwr = pwrCalc(fPkVolts, 'F');				// peak power, fwd
-		rPkPwr = pwrCalc(rPkVolts, 'R');				// pk pwr, ref
-
-		// nett power
-		nPwr = fPwr - rPwr;								// nett power to antenna
-		if (nPwr < 0)
-			nPwr = 0.0;									// no -ve power
-
-		// pep
-		pep = fPkPwr - rPkPwr;
-		if (pep < nPwr)									//  pep can be less than nPwr if peak ref is high
-			pep = nPwr;
-		if (pep < 0)
-			pep = 0.0;
-
-		// select pep or average peak
-		if (lab[peakPwr].stat)							// 0 - pep, 1 - peak average
-		{
-			if (nPwr >= pkPwr)
-				pkPwr = nPwr;
-			else if (pkPwrTimer.check())				// check peak power hold timer
-			{											// come here if pkPwr < nPwr and timer expired
-				pkPwr = nPwr;							// drop back down
-				pkPwrTimer.reset();						// reset timer
-			}
+		fVolts = cPtr->avg1 * 3.3 / adc->adc0->getMaxValue() / (1 << ADC_FRAC_BITS) + FV_ZEROADJ;	// fwd volts zero Adjusted
+		rVolts = cPtr->avg0 * 3.3 / adc->adc1->getMaxValue() / (1 << ADC_FRAC_BITS) + RV_ZEROADJ;	// ref volts zero adjusted
+		fPkVolts = cPtr->pk1 * 3.3 / adc->adc0->getMaxValue() + FV_ZEROADJ;	// fwd volts peak
+		rPkVolts = cPtr->pk0 * 3.3 / adc->adc1->getMaxValue() + RV_ZEROADJ;	// ref volts peak
+	}
+	//calculate power via rms voltage
+	//fPwr = pwrRmsCalc(vf);
+	//rPwr = pwrRMSCalc(vr);
+	//fPkPwr = pwrRmsCalc(vfp);
+	//rPkPwr = pwrRmsCalc(vrp);
+
+#if FIXED_PWR
+	// power from ADC code lookup tables by chanCalc()
+	fmW = cPtr->fmW;
+	rmW = cPtr->rmW;
+	fPkmW = cPtr->fPkmW;
+	rPkmW = cPtr->rPkmW;
+	nmW = (fmW > rmW) ? fmW - rmW : 0;				// nett power, no -ve power
+
+	fPwr = fmW * 0.001;								// Watts for display
+	rPwr = rmW * 0.001;
+	fPkPwr = fPkmW * 0.001;
+	rPkPwr = rPkmW * 0.001;
+#else
+	//calculate power directly from volts
+	fPwr = pwrCalc(fVolts, 'F');					//  fwd volts
+	rPwr = pwrCalc(rVolts, 'R');					//  ref volts
+	fPkPwr = pwrCalc(fPkVolts, 'F');				// peak power, fwd
+	rPkPwr = pwrCalc(rPkVolts, 'R');				// pk pwr, ref
+#endif
+
+	// nett power
+	nPwr = fPwr - rPwr;								// nett power to antenna
+	if (nPwr < 0)
+		nPwr = 0.0;									// no -ve power
+
+	// pep
+	pep = fPkPwr - rPkPwr;
+	if (pep < nPwr)									//  pep can be less than nPwr if peak ref is high
+		pep = nPwr;
+	if (pep < 0)
+		pep = 0.0;
+
+	// select pep or average peak
+	if (lab[peakPwr].stat)							// 0 - pep, 1 - peak average
+	{
+		if (nPwr >= pkPwr)
+			pkPwr = nPwr;
+		else if (pkPwrTimer.check())				// check peak power hold timer
+		{											// come here if pkPwr < nPwr and timer expired
+			pkPwr = nPwr;							// drop back down
+			pkPwrTimer.reset();						// reset timer
 		}
-		else
+	}
+	else
+	{
+		if (pep >= pkPwr)							// record peak pep
+			pkPwr = pep;
+		else if (pepTimer.check())
 		{
-			if (pep >= pkPwr)							// record peak pep
-				pkPwr = pep;
-			else if (pepTimer.check())
-			{
-				pkPwr = pep;
-				pepTimer.reset();
-			}
+			pkPwr = pep;
+			pepTimer.reset();
 		}
+	}
 
-		// dBm =  10x log10 (1000 x watts)
-		dbm = 10 * log10(nPwr * 1000);					// use nett power
-		if (dbm < 0)									// can't be -ve
-			dbm = 0.0;
+	// dBm =  10x log10 (1000 x watts)
+#if FIXED_PWR
+	dbm = dbmCalc(nmW) * 0.1;						// integer calc, tenths of dB
+#else
+	dbm = 10 * log10(nPwr * 1000);					// use nett power
+	if (dbm < 0)									// can't be -ve
+		dbm = 0.0;
+#endif
 
-		// swr calculation
-		if (nPwr > PWR_THRESHOLD)						// power on and vf > vr
-		{
-			//float rc = sqrt(rPwr / fPwr);				// reflection coefficient
-			//swrV = (1 + vrAvg / vfAvg) / (1 - vrAvg / vfAvg);
-			//swrV = (vfAvg + vrAvg) / (vfAvg - vrAvg);
-			//swrV = (vfPk + vrPk) / (vfPk - vrPk);
-
-			float rc = sqrt(rPkPwr / fPkPwr);			// reflection coefficient (peak power)
-			if (rc == NAN || isnan(rc))					// check for valid calculation
-				swrV = 1.0;
-			else										// seems ok?
-			{
-				swrV = (1 + rc) / (1 - rc);				// swr calc
-				if (swrV <= 1.0)
-					swrV = 1.0;							// trap errors
-				if (swrV > 999.9)
-					swrV = 999.9;						// maximum swr display 999.9
-			}
-
-			// set colours for SWR display
-			int sc = GREEN;
-			if (swrV > 1.5)
-				sc = YELLOW;
-			if (swrV > 2)
-				sc = ORANGE;
-			if (swrV > 3)
-				sc = RED;
-			val[swr].colour = sc;
-			displayValue(swr, swrV);					// draw swr while power on
-		}
+	// swr calculation
+	if (nPwr > PWR_THRESHOLD)						// power on and vf > vr
+	{
+		//float rc = sqrt(rPwr / fPwr);				// reflection coefficient
+		//swrV = (1 + vrAvg / vfAvg) / (1 - vrAvg / vfAvg);
+		//swrV = (vfAvg + vrAvg) / (vfAvg - vrAvg);
+		//swrV = (vfPk + vrPk) / (vfPk - vrPk);
 
-		// if power is on
-		if (nPwr > PWR_THRESHOLD)
+#if FIXED_PWR
+		swrV = swrCalc(fPkmW, rPkmW) * 0.01;		// integer calc, swr x 100
+#else
+		float rc = sqrt(rPkPwr / fPkPwr);			// reflection coefficient (peak power)
+		if (rc == NAN || isnan(rc))					// check for valid calculation
+			swrV = 1.0;
+		else										// seems ok?
 		{
-			// display nett power.  if power on, use RED background. runs once if power is on.
-			if (fr[nettPwr].isEnable && lab[nettPwr].stat)
-			{	// stat true. used to control change of backgroud colour
-				fr[nettPwr].bg = RED;
-				restoreFrame(nettPwr);
-				lab[nettPwr].stat = false;				// ensure doesn't change to RED next time
-			}
+			swrV = (1 + rc) / (1 - rc);				// swr calc
+			if (swrV <= 1.0)
+				swrV = 1.0;							// trap errors
+			if (swrV > 999.9)
+				swrV = 999.9;						// maximum swr display 999.9
 		}
+#endif
 
-		// display all enabled
-		displayValue(nettPwr, nPwr);					// display Watts value
-		displayValue(dBm, dbm);
-		displayValue(peakPwr, pkPwr);
-		displayValue(fwdPwr, fPwr);
-		displayValue(refPwr, rPwr);
-		displayValue(fwdVolts, fVolts);						// display with zero offset
-		displayValue(refVolts, rVolts);
-		displayMeter(nettPwrMeter, nPwr, pkPwr);		// display nPwr Meter
-		displayMeter(swrMeter, swrV, 1);				// display if enabled
-
-		// get and display frequency, needed here for swr / frequency manual sweep
-		// this takes 30 mSecs, so only update if SWR meter and freq display is enabled
-		// useful for SWR checking vs Frequency
-		if (fr[swrMeter].isEnable && fr[freq].isEnable)
-			displayValue(freq, getFreq());				// read frequency from radio
-
-		// check for screen touch
-		if (ts.tirqTouched())
-		{
-			if (isDim)
-				resetDimmer();							// reset dimmer
-			else
-				touchChk();
+		// set colours for SWR display
+		int sc = GREEN;
+		if (swrV > 1.5)
+			sc = YELLOW;
+		if (swrV > 2)
+			sc = ORANGE;
+		if (swrV > 3)
+			sc = RED;
+		val[swr].colour = sc;
+		setValue(swr, swrV);						// draw swr while power on
+	}
+
+	// if power is on
+	if (nPwr > PWR_THRESHOLD)
+	{
+		actReading();								// key down to first reading time
+		// display nett power.  if power on, use RED background. runs once if power is on.
+		// frame redrawn by displayFlush(), not here: a whole frame fill is ~12 mSecs of SPI
+		if (frs.isEnable[nettPwr] && lab[nettPwr].stat)
+		{	// stat true. used to control change of backgroud colour
+			frs.bg[nettPwr] = RED;
+			dispQue[nettPwr].isRestore = true;
+			lab[nettPwr].stat = false;				// ensure doesn't change to RED next time
 		}
-		if (nPwr >= PWR_THRESHOLD)
-			resetDimmer();
-	} while (nPwr >= PWR_THRESHOLD);					// do at least once and while power applied
+	}
+
+	// display all enabled. latest values drawn by displayFlush() at DISP_FPS
+	setValue(nettPwr, nPwr);						// display Watts value
+	setValue(dBm, dbm);
+	setValue(peakPwr, pkPwr);
+	setValue(fwdPwr, fPwr);
+	setValue(refPwr, rPwr);
+	setValue(fwdVolts, fVolts);						// display with zero offset
+	setValue(refVolts, rVolts);
+	setMeter(nettPwrMeter, nPwr, pkPwr);			// display nPwr Meter
+	setMeter(swrMeter, swrV, 1);					// display if enabled
+
+	// bluetooth telemetry, sent by bt task if changed
+	tlmSet(TLM_NETT, nPwr * 1000);					// mW
+	tlmSet(TLM_PEAK, pkPwr * 1000);
+	tlmSet(TLM_SWR, swrV * 100);
+	tlmSet(TLM_DBM, dbm * 10);
+	tlmSet(TLM_RMS, cPtr->rmsmW);
+	tlmSet(TLM_CREST, cPtr->crest);
+
+	// power / swr history, trend graph
+	histAdd(nPwr * 1000, swrV * 100);				// mW, swr x 100
+
+	// latest values for SWR sweep point
+	measPwr = nPwr;
+	measSwr = swrV;
+
+	if (nPwr >= PWR_THRESHOLD)
+	{
+		resetDimmer();
+		isPwrOn = true;
+		return;
+	}
+
+	// power off. peak restarts from nett power next pass
+	pkPwr = 0;
+	if (!isPwrOn)
+		return;
+	isPwrOn = false;
 
-	// power off - display exit power and reverse label
-	if (fr[nettPwr].isEnable && !lab[nettPwr].stat)
+	// display exit power and reverse label. final values and frame drawn by next displayFlush()
+	if (frs.isEnable[nettPwr] && !lab[nettPwr].stat)
 	{
-		fr[nettPwr].bg = BG_COLOUR;						// change back to background colour
-		restoreFrame(nettPwr);
-		displayValue(nettPwr, 0);						// ensure value displayed, zero power
+		frs.bg[nettPwr] = BG_COLOUR;					// change back to background colour
+		dispQue[nettPwr].isRestore = true;
+		setValue(nettPwr, 0);							// ensure value displayed, zero power
 	}
 	lab[nettPwr].stat = true;							// reset update flag.  nettPwr b/g is background
 }
@@ -184,6 +213,8 @@ applies constants from calibration procedure
 */
 float pwrCalc(float v, char direction)						// 
 {
+	PROFILE_ZONE(PZ_PWRCALC);
+
 	float pwr = 0.0;
 
 	// calculate power. if Flg true, fwd power. if false ref power
@@ -211,6 +242,156 @@ float pwrCalc(float v, char direction)						//
 	return pwr;										// return power (watts)
 }
 
+/*--------------------------- chanCalc() ------------------------------------------
+window average, peak, power and swr for channel c, current samplesAvg window
+power from ADC code lookup tables (pwrTables.h), averages keep ADC_FRAC_BITS fraction
+CH_MAIN uses band cal tables if band has been calibrated
+Called by: measure(), every channel each pass
+*/
+void chanCalc(int c)
+{
+	adcChan* cPtr = &chan[c];
+	int win = adcWin(samplesAvg);						// same windows every channel
+	int n, head;
+	uint32_t tot1, tot0;
+
+	noInterrupts();										// stop interrupts while copying data
+	tot1 = cPtr->winTot1[win];							// window totals
+	tot0 = cPtr->winTot0[win];
+	n = cPtr->winSize[win];
+	head = sample;
+	interrupts();
+	cPtr->peak(head, n, cPtr->pk1, cPtr->pk0);			// n <= WIN_MAX, getADC() can't overwrite
+	chanStats(cPtr, head, n);
+
+	cPtr->avg1 = (tot1 << ADC_FRAC_BITS) / n;
+	cPtr->avg0 = (tot0 << ADC_FRAC_BITS) / n;
+	cPtr->fmW = pwrLookup(cPtr->fwdTbl, cPtr->fwdShift, cPtr->avg1);
+	cPtr->rmW = pwrLookup(cPtr->refTbl, cPtr->refShift, cPtr->avg0);
+	cPtr->fPkmW = pwrLookup(cPtr->fwdTbl, cPtr->fwdShift, cPtr->pk1 << ADC_FRAC_BITS);
+	cPtr->rPkmW = pwrLookup(cPtr->refTbl, cPtr->refShift, cPtr->pk0 << ADC_FRAC_BITS);
+
+	cPtr->swr = 100;
+	if (cPtr->fmW > cPtr->rmW + (uint32_t)(PWR_THRESHOLD * 1000))	// power on
+		cPtr->swr = swrCalc(cPtr->fPkmW, cPtr->rPkmW);
+}
+
+/*--------------------------- chanStats() ------------------------------------------
+true RMS and crest factor of fwd samples in window, one blockStats() pass over both buffers
+rms code keeps ADC_FRAC_BITS fraction, power from fwd table at rms code
+crest factor = peak / RMS x 100. samples are detector DC, so about 100 for a steady carrier, higher for SSB
+PZ_BLKSTATS mean cycles / window samples = kernel cycles per sample pair, 'k' times the kernel alone
+Called by: chanCalc()
+*/
+void chanStats(adcChan* cPtr, int head, int n)
+{
+	PROFILE_ZONE(PZ_BLKSTATS);
+
+	blockStat s;
+
+	cPtr->stats(head, n, s);
+
+	// mean square < 2^24, 8 bits left for 2 x ADC_FRAC_BITS
+	cPtr->rms1 = isqrt((uint32_t)(s.sq1 / s.n) << (2 * ADC_FRAC_BITS));
+	cPtr->rmsmW = pwrLookup(cPtr->fwdTbl, cPtr->fwdShift, cPtr->rms1);
+	cPtr->crest = 0;
+	if (cPtr->rms1)
+		cPtr->crest = ((s.max1 << ADC_FRAC_BITS) * 100) / cPtr->rms1;
+}
+
+/*----------------------------------- pwrLookup() ----------------------------------------------------------------
+power in milliWatts from ADC code lookup table (pwrTables.h)
+shift: table has 2^shift ADC codes per entry. 0 for compiled tables
+code has ADC_FRAC_BITS fraction bits, linear interpolation between table entries
+*/
+uint32_t pwrLookup(const uint32_t* tbl, int shift, uint32_t code)
+{
+	PROFILE_ZONE(PZ_PWRCALC);
+
+	int bits = ADC_FRAC_BITS + shift;
+	int i = code >> bits;								// table index
+	uint32_t frac = code & ((1 << bits) - 1);			// fraction between entries
+
+	if (i >= (ADC_CODES >> shift))						// top of table, no interpolation
+		return tbl[ADC_CODES >> shift];
+
+	int32_t diff = tbl[i + 1] - tbl[i];					// can be -ve at split voltage
+	return tbl[i] + ((diff * (int32_t)frac) >> bits);
+}
+
+/*----------------------------------- dbmCalc() ----------------------------------------------------------------
+integer dBm from power in milliWatts
+dBm = 10 x log10(mW) = 10 x log10(2) x log2(mW)
+returns dBm x 10, 0 if less than 1 mW
+*/
+int dbmCalc(uint32_t mW)
+{
+	if (mW <= 1)
+		return 0;										// can't be -ve
+
+	// log2, 8 fraction bits. integer part from top bit, fraction by repeated squaring
+	int n = 31 - __builtin_clz(mW);						// integer part
+	uint32_t m = (n > 15) ? mW >> (n - 15) : mW << (15 - n);	// mantissa 1.0 - 2.0, 15 fraction bits
+	int lg2 = n << 8;
+	for (int i = 7; i >= 0; i--)
+	{
+		m = (m * m) >> 15;								// square mantissa
+		if (m >= (2u << 15))							// >= 2.0, next fraction bit set
+		{
+			m >>= 1;
+			lg2 += 1 << i;
+		}
+	}
+
+	return (lg2 * 7706 + (1 << 15)) >> 16;				// x 100 x log10(2) / 256, rounded
+}
+
+/*----------------------------------- swrCalc() ----------------------------------------------------------------
+integer swr from peak fwd and ref power (milliWatts)
+swr = (1 + rc) / (1 - rc) = (sqrt(f) + sqrt(r)) / (sqrt(f) - sqrt(r))
+returns swr x 100, limited to 1.00 - 999.90
+*/
+int swrCalc(uint32_t fmW, uint32_t rmW)
+{
+	uint32_t f = isqrt(fmW << 12);						// extra bits for precision, fits to 2^20 mW (1048W)
+	uint32_t r = isqrt(rmW << 12);
+	uint32_t s;
+
+	if (r > f)											// trap errors
+		return 100;
+	if (r == f)
+		return 99990;									// maximum swr display 999.9
+
+	s = ((f + r) * 200 / (f - r) + 1) / 2;				// rounded
+	if (s > 99990)
+		s = 99990;
+	return s;
+}
+
+/*----------------------------------- isqrt() ----------------------------------------------------------------
+integer square root, bit by bit
+*/
+uint32_t isqrt(uint32_t x)
+{
+	uint32_t r = 0;
+	uint32_t b = 1UL << 30;								// highest power of 4
+
+	while (b > x)
+		b >>= 2;
+	while (b)
+	{
+		if (x >= r + b)
+		{
+			x -= r + b;
+			r = (r >> 1) + b;
+		}
+		else
+			r >>= 1;
+		b >>= 2;
+	}
+	return r;
+}
+
 /*----------------------------------- pwrRmsCalc() ----------------------------------------------------
 alternative power calculation
 calculates Vrms from ADC rms volts and then power in watts
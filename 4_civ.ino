@@ -11,58 +11,48 @@
 
 /*--------------------------- getFreq() ----------------------------------------------------
 read CI-V frequency
-issues CI-V command to read frequency from radio and tehn decoded the
-frequency returned.
-Returns: frequency or 0 if fail
-Global: inBuff, readFreq
-Calls: civRead(), decodeBCD()
-int civReadPreamble[] = { 0xFE, 0xFE,  CIVADDR, CIVRADIO };			    // write command preamble
-int civWriteFreq[] =    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFD };	// set frequency
+decodes the last frequency received from radio.
+does not wait for radio, civSchedule() and transceive frames keep it current
+Returns: frequency (Hz) or 0 if fail
+Calls: civGet(), decodeFreq()
+*/
+uint32_t getFreq()
+{
+	civSlot* sPtr = civGet(CIV_FREQ);	// last frequency from radio
 
+	if (sPtr->n == 0)						// nothing read, return 0
+		return 0;
 
+	return decodeFreq(sPtr->buff);
+}
 
-  */
-float getFreq()
+/*--------------------------- getMode() ----------------------------------------------------
+radio operating mode, from transceive frames or read mode reply
+Returns: Icom mode code (0=LSB, 1=USB, 2=AM, 3=CW, 4=RTTY, 5=FM...) or -1 if not known
+*/
+int getMode()
 {
-	int n;									// chars read into budder
-	float f;
-	char inBuff[12];						// civ frequency inBuff buffer
+	civSlot* sPtr = civGet(CIV_MODE);
 
-	n = civWrite(civReadFreq);				// request read frequency from radio
-	if (n == 0)								// timed out
-		return 0;
-
-	n = civRead(inBuff);					// buffer, printflg
-	if (inBuff[3] == CIVRADIO && inBuff[n - 1] == 0xFD)	// check format of serial stream
-	{
-		f = (decodeFreq(inBuff) / 1000);	// decode frequency  and convert to kHz
-		return f / 1000;					// return MHZ
-	}
-	else
-		return 0;							// nothing read, return 0
+	if (sPtr->n == 0)
+		return -1;
+	return sPtr->buff[5];
 }
 
 /*--------------------------- getBand() --------------------------------------------------------------------
-compares to HF band table start and end band limits
-arg: float frequency (MHz).
+band from band edge index, updates band label on change
+arg: frequency (Hz).
 returns: hfband band number
 */
-int getBand(float freq)
+int getBand(uint32_t freq)
 {
-	int cBand = -1;							// local band number
+	int cBand;								// local band number
 	static int prevBand;
-	int isFlg = false;
+	int isFlg;
 
 	// get band   -1 = no band, 0=160mtrs, 1=80mtrs, etc.
-	for (int i = 0; i < NUM_BANDS; i++)
-	{
-		if (freq >= hfBand[i].bandStart && freq <= hfBand[i].bandEnd)
-		{
-			cBand = i;
-			isFlg = true;
-			break;
-		}
-	}
+	cBand = bandFind(freq);
+	isFlg = (cBand >= 0);
 
 	if (cBand == prevBand)						// compare to previousBand
 		return cBand;						// return if no change
@@ -81,6 +71,11 @@ int getBand(float freq)
 		val[band].isUpdate = true;			// force value update
 	}
 
+	// band change - radio settings may be different
+	civStale(CIV_REF);
+	civStale(CIV_TXPWR);
+	civStale(CIV_TUNER);
+
 	// set global bandCurr & return
 	prevBand = cBand;							// save to previousBand
 	return cBand;
@@ -90,165 +85,527 @@ int getBand(float freq)
 
 
 
+/*--------------------------- initBands() --------------------------------------------------------------------
+builds band edge index from hfBand[], any table order
+Called by: setup()
+*/
+void initBands()
+{
+	int i, j;
+
+	// band order by start freq, insertion sort
+	for (i = 0; i < NUM_BANDS; i++)
+	{
+		for (j = i; j > 0 && hfBand[bandOrder[j - 1]].bandStart > hfBand[i].bandStart; j--)
+			bandOrder[j] = bandOrder[j - 1];
+		bandOrder[j] = i;
+	}
+
+	for (i = 0; i < NUM_BANDS; i++)
+	{
+		bandEdge[i * 2] = hfBand[bandOrder[i]].bandStart;
+		bandEdge[i * 2 + 1] = hfBand[bandOrder[i]].bandEnd + 1;	// first freq past band
+	}
+}
+
+/*--------------------------- bandFind() --------------------------------------------------------------------
+binary search of band edges. bands don't overlap
+arg: frequency (Hz)
+returns: hfBand[] posn, -1 if not in a band
+*/
+int bandFind(uint32_t freq)
+{
+	int lo = 0, hi = NUM_BANDS * 2;
+
+	while (lo < hi)									// lo = edges <= freq
+	{
+		int mid = (lo + hi) / 2;
+		if (bandEdge[mid] <= freq)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return (lo & 1) ? bandOrder[lo / 2] : -1;		// odd, past a start but not its end
+}
+
 /**************************  civ functions ********************************/
 
-/*------------------------------ civRead() -------------------------------------------------
-read CIV stream from radio
-reads CI-V stream from the radio until end of frame (oxFD) received
-NOTE: delay required between character reads to allow for buffer fill
-Returns: number of characters received or 0 if fail
-Global: inBuff
-Calls:
+/*------------------------------ civService() -------------------------------------------------
+runs the CI-V transport, call often. never waits for radio
+parses received bytes, handles timeouts, schedules polls, sends next queued command when bus is idle
+Called by: loop(), measure()
 */
-int civRead(char* buff)						// read into buff, serial print if flg set
-//int civRead(char* buff)					// read into buff, serial print if flg set
+void civService()
 {
-	int n = 0;
-	char inChar = '\0';						// incoming character
-	bool isTtimeOut = false;
+	PROFILE_ZONE(PZ_CIVSERVICE);
 
-	civTimeOut.reset();						// set timeout timer
-	do
+	uint8_t rx[CIV_BUFF * 2];					// received bytes for trace
+	int nRx = 0;
+	bool isTick = false;						// trace tick written, replay runs this pass
+
+	// receive - parse all waiting characters. all bus traffic, including our echo
+	while (civSerial.available() > 0)
 	{
-		delay(CIV_READ_DELAY);				// delay for read buffer
-		if (civSerial.available() > 0)      // character waiting?
-			inChar = civSerial.read();	    // read it - empties input buffer
-		if (civTimeOut.check())
+		traceTickOnce(&isTick, TRC_TASK_CIV);
+		byte c = civSerial.read();
+		civParse(c);
+		civRxTime = millis();
+		civBusBytes++;
+		civBusTot++;
+		rx[nRx++] = c;
+		if (nRx == sizeof(rx))
 		{
-			isTtimeOut = true;				// timedout, set flg
-			break;							// break from loop
+			traceRec(TRC_CIV_RX, rx, nRx);
+			nRx = 0;
 		}
-	} while (inChar != 0xFE && !isTtimeOut);	// preamble start
-	buff[n++] = inChar;						// load buff with next character
-	if (isTtimeOut)
-		return 0;							// timeout occurred, return 0
+	}
+	if (nRx)
+		traceRec(TRC_CIV_RX, rx, nRx);
+	if (civBusTimer.check())					// new bus budget window
+		civBusBytes = 0;
+	if (civRxN && millis() - civRxTime > CIV_RX_GAP)
+		civRxN = 0;								// frame end lost, bus is free
+
+	// command in progress timed out?
+	if (civState != CIV_IDLE && civTimeOut.check())
+	{
+		traceTickOnce(&isTick, TRC_TASK_CIV);
+		civRetry();
+	}
 
-	// get rest of frame
-	civTimeOut.reset();						// set timeout timer
-	do
+	// queue poll for stale radio value
+	civSchedule();
+
+	// send next command. don't start while radio is sending a frame
+	if (civState == CIV_IDLE && civQueN > 0 && civRxN == 0)
+	{
+		civCmd* cPtr = &civQue[civQueHead];
+		traceTickOnce(&isTick, TRC_TASK_CIV);
+		if (!cPtr->start)
+			cPtr->start = millis();				// latency includes resends
+		civSerial.write((const uint8_t*)cPtr->buff, cPtr->n);	// fits in serial tx buffer, doesn't wait
+		traceRec(TRC_CIV_TX, cPtr->buff, cPtr->n);
+		civState = CIV_ECHO;
+		civTimeOut.reset();						// set timeout timer
+	}
+}
+
+/*------------------------------ civSchedule() -------------------------------------------------
+poll scheduler. queues one read when queue is empty and bus budget allows
+due: no value, older than civRates[].interval, or marked stale by civStale()
+choice: stale or over staleness budget first, then priority, then oldest
+*/
+void civSchedule()
+{
+	int best = -1;
+	int bestScore = 0;
+	unsigned long bestAge = 0;
+	unsigned long now = millis();
+
+	if (civQueN > 0 || civBusBytes * 100 > CIV_BUS_BYTES * CIV_BUS_BUDGET)
+		return;									// bus busy, or budget used this second
+
+	for (int i = 0; i < NUM_CIV_SLOTS; i++)
 	{
-		delay(CIV_READ_DELAY);
-		if (civSerial.available() > 0) 		// character waiting?
-			inChar = civSerial.read();		// read it - empties input buffer
-		if (civTimeOut.check())				// timeout if looping too long
+		civSlot* sPtr = &civSlots[i];
+		civRate* rPtr = &civRates[i];
+		unsigned long interval = rPtr->interval;
+		unsigned long age = now - sPtr->time;
+		int score;
+
+		if (interval == 0 && !sPtr->isStale)
+			continue;							// not polled
+		if (isCivTransceive && civSlotBcst[i] != CIV_NO_BCST)
+			interval = CIV_BCST_AGE;			// radio sends changes, poll rarely
+		if (!sPtr->isStale && sPtr->time && age < interval)
+			continue;							// value current
+
+		score = rPtr->priority;
+		if (sPtr->isStale || !sPtr->time || age > rPtr->budget)
+			score += 100;						// event or over budget, goes first
+		if (best < 0 || score > bestScore || (score == bestScore && age > bestAge))
 		{
-			isTtimeOut = true;				// set timeout flg
-			break;
+			best = i;
+			bestScore = score;
+			bestAge = age;
 		}
-		buff[n++] = inChar;					// load buff with next character
-	} while (inChar != 0xFD && !isTtimeOut);	// check for end of inBuff (0xFD)
+	}
 
-	if (isTtimeOut)
-		return 0;							// timeout occurred, return 0
-	else
-		return n;							// n = number of characters read, 0 = error
+	if (best >= 0 && civQueue(civSlotCmd[best], best))
+	{
+		civSlots[best].isPending = true;
+		civRates[best].polls++;
+	}
 }
 
-/* ------------------------------ civWrite() ---------------------------------------------------------------
-send CI-V command to radio
-sends inBuff data to radio, character at a time ip to end character (0xFD)
-Returns: n = chars written, 0 if error
-Global: inBuff
-Calls:
+/*------------------------------ civStats() -------------------------------------------------
+reports achieved refresh rate per value and bus use on Serial, since last report
 */
-//int civWrite(const char* buff)
-int civWrite(char* buff)
+void civStats()
 {
-	int n = 0;
-	char inChar = '\0';						// incoming, read char
-	bool isTtimeOut = false;
+	static unsigned long prevTime;
+	unsigned long now = millis();
+	float secs = (now - prevTime) / 1000.0;
+
+	Serial.print("CIV bus: ");
+	Serial.print(civBusTot * 100.0 / (CIV_BUS_BYTES * secs), 1);
+	Serial.print("%");
+	for (int i = 0; i < NUM_CIV_SLOTS; i++)
+	{
+		Serial.print("  ");
+		Serial.print(civSlotName[i]);
+		Serial.print(": ");
+		Serial.print(civRates[i].updates / secs, 1);			// refresh rate
+		Serial.print("/s polls: ");
+		Serial.print(civRates[i].polls / secs, 1);
+		Serial.print("/s");
+		civRates[i].updates = 0;
+		civRates[i].polls = 0;
+	}
+	Serial.println();
+
+	// command round trip latency
+	Serial.print("CIV cmds: ");
+	Serial.print((civCmdsOk + civCmdsFail) / secs, 1);
+	Serial.print("/s  p50: ");
+	Serial.print(civLatPercent(50));
+	Serial.print(" ms  p99: ");
+	Serial.print(civLatPercent(99));
+	Serial.print(" ms  timeouts: ");
+	Serial.print(civCmdsFail);
+	Serial.print("  resends: ");
+	Serial.println(civResends);
+
+	for (int i = 0; i < CIV_LAT_BUCKETS; i++)
+		civLatHist[i] = 0;
+	civCmdsOk = 0;
+	civCmdsFail = 0;
+	civResends = 0;
+
+	civBusTot = 0;
+	prevTime = now;
+}
 
-	// flush send buffer
-	civSerial.flush();
+/*------------------------------ civLatPercent() -------------------------------------------------
+latency percentile from histogram
+Returns: upper edge of bucket (mSecs), 0 if no commands
+*/
+int civLatPercent(int pc)
+{
+	unsigned long n = 0;
+	unsigned long target = (civCmdsOk * pc + 99) / 100;	// rounded up
 
-	civTimeOut.reset();						// set timeout timer
+	if (civCmdsOk == 0)
+		return 0;
+	for (int i = 0; i < CIV_LAT_BUCKETS; i++)
+	{
+		n += civLatHist[i];
+		if (n >= target)
+			return (i + 1) * CIV_LAT_WIDTH;
+	}
+	return CIV_LAT_BUCKETS * CIV_LAT_WIDTH;
+}
 
-	// send civ write preamble
-	civSerial.write(civWritePreamble[0]);		// send first char
-	delay(CIV_WRITE_DELAY);					// just one delay required
+/*------------------------------ civSync() -------------------------------------------------
+runs civService() until slot has a value or ms milliseconds pass
+only for startup, when waiting for the radio is acceptable
+*/
+void civSync(int slot, unsigned long ms)
+{
+	unsigned long start = millis();
 
-	for (int i = 1; i < 4; i++)				// send rest of 4 char preamble
+	do
+		civService();
+	while (civSlots[slot].time == 0 && millis() - start < ms);
+}
+
+/*------------------------------ civParse() -------------------------------------------------
+byte driven CI-V frame parser
+collects frame from 0xFE 0xFE preamble to 0xFD end
+0xFC is bus collision jam code
+*/
+void civParse(byte c)
+{
+	if (c == 0xFC)								// collision, frame lost
 	{
-		civSerial.write(civWritePreamble[i]);
-		do
-		{
-			if (civSerial.available() > 0) 	// echo character waiting?
-				inChar = civSerial.read();
-			if (civTimeOut.check())
-			{
-				isTtimeOut = true;
-				break;
-			}
-		} while (inChar != civWritePreamble[i] && !isTtimeOut);	// compare to written char
+		civRxN = 0;
+		if (civState == CIV_ECHO)
+			civRetry();							// our command was garbled, resend
+		return;
 	}
 
-	if (isTtimeOut)							// timed out, return n=0 bytes
-		return 0;
+	if (c == 0xFE)
+	{
+		if (civRxN == 2)						// extra preamble character
+			return;
+		if (civRxN > 2)							// new frame before end, start again
+			civRxN = 0;
+	}
+	else if (civRxN < 2)						// not in frame, wait for preamble
+	{
+		civRxN = 0;
+		return;
+	}
 
-	// send rest of ci-v command
-	civTimeOut.reset();						// set timeout timer
-	do
-	{										// send code + end character
-		civSerial.write(buff[n]);			// write character
+	civRx[civRxN++] = c;
+	if (c == 0xFD)								// end of frame
+	{
+		civRxFrame(civRx, civRxN);
+		civRxN = 0;
+	}
+	else if (civRxN >= CIV_BUFF)				// too long, not valid
+		civRxN = 0;
+}
 
-		do
-		{
-			// delay(CIV_DELAY);
-			if (civSerial.available() > 0) 	// character waiting?
-				inChar = civSerial.read();
-		} while (inChar != buff[n]);
+/*------------------------------ civRxFrame() -----------------------------------------------
+complete frame received
+frame from this controller is the bus echo of command in progress
+frame from radio is saved in matching result slot
+*/
+void civRxFrame(char* buff, int n)
+{
+	PROFILE_ZONE(PZ_CIVRX);
 
-		if (civTimeOut.check())
+	civCmd* cPtr = &civQue[civQueHead];
+	int i, j;
+
+	// echo of our command
+	if ((byte)buff[2] == CIVRADIO && (byte)buff[3] == CIVADDR)
+	{
+		if (civState != CIV_ECHO)
+			return;								// late echo, ignore
+		if (n != cPtr->n || memcmp(buff, cPtr->buff, n))
+			civRetry();							// echo different, collision
+		else if (cPtr->slot < 0)
+			civDone(true);						// write done
+		else
 		{
-			isTtimeOut = true;
-			break;
+			civState = CIV_REPLY;				// read, wait for reply
+			civTimeOut.reset();
 		}
-	} while (buff[n++] != 0xFD && !isTtimeOut);	// do until end of buff
+		return;
+	}
 
-	if (isTtimeOut)
-		return 0;							// return 0 if timed out
+	if ((byte)buff[3] != CIVRADIO)
+		return;									// not from radio
+
+	if (buff[2] == 0x00)						// transceive broadcast - freq or mode changed at radio
+	{
+		for (i = 0; i < NUM_CIV_SLOTS; i++)
+			if (civSlotBcst[i] == (byte)buff[4])
+				break;
+		isCivTransceive = true;
+	}
+	else if ((byte)buff[2] == CIVADDR)			// reply to this controller
+	{
+		for (i = 0; i < NUM_CIV_SLOTS; i++)		// find slot with matching command
+		{
+			char* cmd = civSlotCmd[i];
+			for (j = 0; (byte)cmd[j] != 0xFD && 4 + j < n - 1; j++)
+				if (cmd[j] != buff[4 + j])
+					break;
+			if ((byte)cmd[j] == 0xFD)			// all command bytes match
+				break;
+		}
+	}
 	else
-		return n;							// return number of bytes
+		return;									// for another controller
+	if (i == NUM_CIV_SLOTS)
+		return;									// not a reply we use (OK/NG etc)
+	if (n != civSlotLen[i])
+		return;									// bytes lost, read times out and is resent
+
+	// save frame. transceive frame has same layout as read reply
+	if (n != civSlots[i].n || memcmp(civSlots[i].buff, buff, n))
+		civSlots[i].isDirty = true;				// value changed
+	memcpy(civSlots[i].buff, buff, n);
+	civSlots[i].n = n;
+	civSlots[i].time = millis();
+	civSlots[i].isStale = false;
+	civRates[i].updates++;
+
+	if (civState == CIV_REPLY && cPtr->slot == i)
+		civDone(true);							// read done
 }
 
-/*------------------------------------ decodeBCDFreq() -----------------------------------------
- function to decode BCD frequency data.
-  Called By: civreadFreq()
+/*------------------------------ civRetry() -------------------------------------------------
+resend command in progress after timeout or collision
+gives up after CIV_RETRIES. failed read clears result slot
 */
-float decodeFreq(char* buff)
+void civRetry()
 {
-	//unsigned long m, k1, k2, h;
-	long mult = 1000000;						// multiplier =  one million
-	float freq = 0.0;							// decoded frequency
+	civCmd* cPtr = &civQue[civQueHead];
 
-	for (int i = 4; i > 0; i--)					// 4 bytes, 8-4 in buffer
+	civState = CIV_IDLE;						// civService() resends
+	civResends++;
+	if (++cPtr->retries > CIV_RETRIES)
 	{
-		freq += getBCD(buff[4 + i])*mult;		// start with MHz
-		mult /= 100;							// decrement each byte
+		if (cPtr->slot >= 0)
+		{
+			civSlots[cPtr->slot].n = 0;			// no valid reply
+			civSlots[cPtr->slot].time = millis();	// wait an interval before next poll
+			civSlots[cPtr->slot].isStale = false;
+		}
+		civResends--;							// given up, not resent
+		civDone(false);
 	}
-	return freq;								// return frequency
+}
 
+/*------------------------------ civDone() -------------------------------------------------
+command in progress complete, remove from queue
+isOk: true = echo or reply received, false = timed out. records latency
+*/
+void civDone(bool isOk)
+{
+	civCmd* cPtr = &civQue[civQueHead];
+
+	if (isOk)
+	{
+		int b = (millis() - cPtr->start) / CIV_LAT_WIDTH;
+		if (b >= CIV_LAT_BUCKETS)
+			b = CIV_LAT_BUCKETS - 1;			// overflow bucket
+		if (civLatHist[b] < 0xFFFF)
+			civLatHist[b]++;
+		civCmdsOk++;
+		if (cPtr->slot < 0)
+			civWrites++;
+	}
+	else
+		civCmdsFail++;
+
+	if (cPtr->slot >= 0)
+		civSlots[cPtr->slot].isPending = false;
+	if (cPtr->back >= 0)						// written, now poll. replies before here were old values
+	{
+		civSlots[cPtr->back].isWriting = false;
+		civSlots[cPtr->back].isStale = true;
+	}
+	if (++civQueHead >= CIV_QUE_SIZE)
+		civQueHead = 0;
+	civQueN--;
+	civState = CIV_IDLE;
 }
 
-/* --------------------------------- encodeBCDFreq() -----------------------------------
-function to encode float freq to CI-V format.
-buff[4] - buff[8]	Called by: initAutoBand(), autoBand()
+/*------------------------------ civQueue() -------------------------------------------------
+add command to queue. adds write preamble
+buff: command bytes up to end character (0xFD). slot: result slot, -1 for writes
+Returns: n = frame length, 0 if queue full
 */
-void encodeFreq(char* buff, float freq)			// buffer, value   set Frequency
+int civQueue(char* buff, int slot)
 {
-	long mult = 1000000;						// multiplier =  one million
-	long  fl = freq * mult;						// convert decimal MHz freq to Hz
+	PROFILE_ZONE(PZ_CIVTX);
+
+	civCmd* cPtr;
+	int i = 0, n;
+
+	if (civQueN >= CIV_QUE_SIZE)
+		return 0;								// queue full
+
+	cPtr = &civQue[(civQueHead + civQueN) % CIV_QUE_SIZE];
+	for (n = 0; n < 4; n++)						// 4 char preamble
+		cPtr->buff[n] = civWritePreamble[n];
+	do											// command + end character
+		cPtr->buff[n++] = buff[i];
+	while ((byte)buff[i++] != 0xFD && n < CIV_BUFF);
+
+	cPtr->n = n;
+	cPtr->slot = slot;
+	cPtr->back = -1;
+	cPtr->retries = 0;
+	cPtr->start = 0;
+	civQueN++;
+	return n;
+}
 
-	for (int i = 4; i > 0; i--)					// convert 4 bytes to BCD
+/* ------------------------------ civWrite() ---------------------------------------------------------------
+send CI-V command to radio
+queues buff, up to end character (0xFD). civService() sends it
+Returns: n = frame length, 0 if error
+*/
+int civWrite(char* buff)
+{
+	return civQueue(buff, -1);
+}
+
+/* ------------------------------ civWriteBack() ---------------------------------------------------------------
+write radio setting held in slot, then read it back
+slot is stale from when the write is done, civSettling() until read back
+Returns: n = frame length, 0 if queue full
+*/
+int civWriteBack(char* buff, int slot)
+{
+	int n = civQueue(buff, -1);
+
+	if (n)
 	{
-		int x = (fl % (mult * 100)) / mult;		// convert each byte		
-		buff[i] = putBCD(x);					// write to buffer
-		mult = mult / 100;						// decrement mult for each byute
+		civQue[(civQueHead + civQueN - 1) % CIV_QUE_SIZE].back = slot;
+		civSlots[slot].isWriting = true;
 	}
+	return n;
+}
 
+/*------------------------------ civSettling() -------------------------------------------------
+Returns: true if slot written by civWriteBack() and new value not read back yet. slot value is old
+*/
+bool civSettling(int slot)
+{
+	return civSlots[slot].isWriting || civSlots[slot].isStale;
+}
 
+/*------------------------------ civGet() -------------------------------------------------
+radio state cache. values are kept current by civSchedule() and transceive frames
+Returns: pointer to slot with last reply
+*/
+civSlot* civGet(int slot)
+{
+	return &civSlots[slot];
+}
 
+/*------------------------------ civStale() -------------------------------------------------
+mark cached value stale, civSchedule() polls radio first
+used after writing setting to radio and on band change
+*/
+void civStale(int slot)
+{
+	civSlots[slot].isStale = true;
+}
+
+/*------------------------------ civChanged() -------------------------------------------------
+Returns: true if slot value changed since last call. clears dirty flag
+*/
+bool civChanged(int slot)
+{
+	bool isDirty = civSlots[slot].isDirty;
+
+	civSlots[slot].isDirty = false;
+	return isDirty;
+}
+
+/*------------------------------------ decodeBCDFreq() -----------------------------------------
+ function to decode BCD frequency data. buff[5] 10/1 Hz to buff[8] 10/1 MHz
+ Returns: frequency (Hz)
+  Called By: getFreq()
+*/
+uint32_t decodeFreq(char* buff)
+{
+	uint32_t freq = 0;							// decoded frequency
 
+	for (int i = 8; i >= 5; i--)				// 4 bytes, MHz first
+		freq = freq * 100 + getBCD(buff[i]);
+	return freq;								// return frequency
+}
+
+/* --------------------------------- encodeBCDFreq() -----------------------------------
+function to encode freq (Hz) to CI-V format.
+buff[1] - buff[5]	Called by: autoBand(), sweepQueue()
+*/
+void encodeFreq(char* buff, uint32_t freq)		// buffer, value   set Frequency
+{
+	for (int i = 1; i <= 5; i++)				// 5 bytes, 10/1 Hz first
+	{
+		buff[i] = putBCD(freq % 100);
+		freq /= 100;
+	}
 }
 
 /*---------------------------------- civPrintBuffer() --------------------------------
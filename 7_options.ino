@@ -372,7 +372,7 @@ void drawPlusMinusOpts(int posn, int ti)
 {
 	int x, y;
 	int offSet = 15;
-	frame* fPtr = &fr[posn];
+	const frame* fPtr = &fr[posn];
 
 	//	x = fPtr->x + BW + 5;
 	x = fPtr->x + fPtr->w + 5;
@@ -490,6 +490,9 @@ void setSamples()
 	i = setParam(samplesCalOpt, "Calibrate Samples", i);
 	displayValue(samplesCalOpt, samplesCalPar.val);
 
+	i = setParam(calPwrOpt, "Cal Ref Power", i);				// reference meter reading for cal points
+	displayValue(calPwrOpt, calPwrPar.val / 10.0);
+
 	x = 135; y = 210;
 	drawTouchBoxOpts(x, y, "Exit", i);
 
@@ -504,8 +507,8 @@ void setSamples()
 				samplesDefPar.val += 99;
 			else
 				samplesDefPar.val += 100;
-			if (samplesDefPar.val >= MAXBUF)
-				samplesDefPar.val = MAXBUF;
+			if (samplesDefPar.val >= SAMPLES_MAX)
+				samplesDefPar.val = SAMPLES_MAX;
 			break;
 		case 1:										// decrement sample size, min = 1
 			samplesDefPar.val -= 100;
@@ -516,8 +519,8 @@ void setSamples()
 			if (samplesAltPar.val == 1)
 				samplesAltPar.val += 99;
 			else samplesAltPar.val += 100;
-			if (samplesAltPar.val >= MAXBUF)
-				samplesAltPar.val = MAXBUF;
+			if (samplesAltPar.val >= SAMPLES_MAX)
+				samplesAltPar.val = SAMPLES_MAX;
 			break;
 		case 3:										// decrement sample size, min = 1
 			samplesAltPar.val -= 100;
@@ -528,15 +531,21 @@ void setSamples()
 			if (samplesCalPar.val == 1)
 				samplesCalPar.val += 99;
 			else samplesCalPar.val += 100;
-			if (samplesCalPar.val >= MAXBUF)
-				samplesCalPar.val = MAXBUF;
+			if (samplesCalPar.val >= SAMPLES_MAX)
+				samplesCalPar.val = SAMPLES_MAX;
 			break;
 		case 5:										// decrement calibrate sample size, min = 1
 			samplesCalPar.val -= 100;
 			if (samplesCalPar.val <= 1)
 				samplesCalPar.val = 1;
 			break;
-		case 6:
+		case 6:										// increment cal reference power
+			calPwrPar.val = calPwrStep(calPwrPar.val, 1);
+			break;
+		case 7:										// decrement cal reference power
+			calPwrPar.val = calPwrStep(calPwrPar.val, -1);
+			break;
+		case 8:
 		default:
 			break;
 		}
@@ -545,17 +554,20 @@ void setSamples()
 		displayValue(samplesDefOpt, samplesDefPar.val);
 		displayValue(samplesAltOpt, samplesAltPar.val);
 		displayValue(samplesCalOpt, samplesCalPar.val);
+		displayValue(calPwrOpt, calPwrPar.val / 10.0);
 
 		// save to EEPROM
 		putParEEPROM(samplesDefPar);
 		putParEEPROM(samplesAltPar);
 		putParEEPROM(samplesCalPar);
+		putParEEPROM(calPwrPar);
 	} while (n < i);								// do while touched item is less than toatl items
 
 	// clean up
 	eraseFrame(samplesDefOpt);
 	eraseFrame(samplesAltOpt);
 	eraseFrame(samplesCalOpt);
+	eraseFrame(calPwrOpt);
 
 	switch (samplesStat)							// reset samplesAvg using new values
 	{
@@ -63,7 +63,7 @@ short touch restores to nettPwr (Watts) display
 void dbmButton(int tStat)
 {
 	eraseFrame(dBm);									// erases and disables  nettPwr frame
-	fr[nettPwr].bg = BG_COLOUR;
+	frs.bg[nettPwr] = BG_COLOUR;
 	restoreFrame(nettPwr);
 }
 
@@ -86,7 +86,11 @@ void peakPwrButton(int tStat)							// 0 = program call. sets display.  1 - shor
 
 	//_reboot_Teensyduino_();
 	if (tStat == 2)
+	{
+		if (eeDirty)
+			eeFlush();									// changes waiting for EE_DELAY
 		CPU_RESTART;
+	}
 }
 
 /*---------------------- swrButton ------------------------------
@@ -104,12 +108,12 @@ void swrButton(int tStat)
 	{
 		if (val[swr].decs == 1)							// change decimals
 		{
-			val[swr].font = FONT24;
+			val[swr].font = &FONT24;
 			val[swr].decs = 2;
 		}
 		else
 		{
-			val[swr].font = FONT28;						// fewer decimals, larger font
+			val[swr].font = &FONT28;					// fewer decimals, larger font
 			val[swr].decs = 1;
 		}
 	}
@@ -127,7 +131,7 @@ void autoBandButton(int tStat)
 		return;
 	else												// short touch	
 	{
-		if (fr[freq].isTouch)
+		if (frs.isTouch[freq])
 		{												// if enabled, band active
 			eraseFrame(freq);
 			restoreFrame(band);
@@ -34,6 +34,31 @@
 			code restructing
 			added seperate calculation for fwd & ref
 			constexpr for BCD conversions
+			getADC() peak uses sliding window queue, no buffer rescan
+			added ADC block mode, PDB triggered + DMA ping-pong buffers
+			fixed point power, dBm, swr. compile time ADC to power tables
+			per band calibration curves in EEPROM, expanded to tables at band change
+			CI-V non-blocking. command queue, frame parser, result slots
+			CI-V transceive frames update radio state cache, poll only when stale
+			CI-V poll scheduler, refresh interval/priority per parameter, bus stats
+			CI-V round trip latency histogram, timeouts, commands/sec in stats
+			display compositor, measure() values drawn in batches at DISP_FPS
+			displayValue() integer formatting, glyph width cache, redraw changed chars only
+			non-blocking touch gesture state machine, hit test grid
+			cooperative scheduler, tasks with period / budget / overrun stats. no nested measure() loops
+			profiling zones, DWT cycle counts, histograms. 'p' on USB serial dumps
+			raw sample binary stream on USB serial, delta, sequence, CRC, drop count
+			bluetooth binary telemetry, subscribe / rate per field, changed values only
+			averaging windows def / alt / cal run together, samples change without reset
+			SWR sweep across band, long touch SWR meter, plotted curve
+			EEPROM write-back cache, delayed coalesced writes, layout header, CRC per record
+			frequency as uint32_t Hz, BCD tables, band edge binary search
+			session trace over USB, ADC / CI-V / touch / ticks + display digest
+			measurement channel template, N couplers sampled in one getADC() pass
+			const frame layouts in flash, layout switch by pointer, font pointers
+			power / SWR history, seconds and minutes rings, trend graph long touch power meter
+			adaptive rates, idle sampling / display until carrier detected in getADC()
+			block stats kernel, one pass sum / squares / min / max, DSP dual 16 bit. true RMS, crest factor
 
 	  Versions  II:
 		003 change frame, label structure
@@ -107,10 +132,14 @@
 #include <ILI9341_t3.h>											// display (320x240)
 #include <EEPROM.h>												// EEPROM
 #include <ADC.h>												// analog - digital converter
+#include <DMAChannel.h>											// DMA for ADC block mode
 #include <Metro.h>												// metro timers
 #include "fontsColours.h"										// Teensy fonts
 #include "frames.h"												// varaiables and parameters
 #include "pwrMeter.h"											// PowerMeterII defines, constants & global variables
+#include "pwrTables.h"											// ADC code to power lookup tables
+#include "measChan.h"											// measurement channels, one per coupler
+#include "profile.h"											// profiling zones
 
 #define VERSION "PowerMeterIII_v005"							// software version
 
@@ -122,10 +151,9 @@ void setup()
 {
 	pinMode(LED_BUILTIN, OUTPUT);
 	pinMode(TOGGLE_PIN, OUTPUT);								// set toggle pin for timing
+	profInit();													// cycle counter for profiling zones
 
-	pinMode(A1, INPUT);											// physical pin 15, fwd volts
-	pinMode(A2, INPUT);											// physical pin 16, ref volts
-
+	initChans();												// coupler pins, power tables
 	initADC();													// initialise ADC, set interrupt timer
 
 	tft.begin();												// TFT begin
@@ -142,19 +170,21 @@ void setup()
 	Serial.println("------------------------------------");
 
 	// civSerial
-	civSerial.begin(19200);										// start teensy Serial1. RX1 - pin 0, TX1 - pin 1
+	civSerial.begin(CIV_BAUD);									// start teensy Serial1. RX1 - pin 0, TX1 - pin 1
 	//bluetooth module HC - 05.  Default speed - 9600
-	btSerial.begin(9600);										// start Serial3. RX3 - pin 7, TX3 - pin 8,
+	btSerial.begin(BT_BAUD);										// start Serial3. RX3 - pin 7, TX3 - pin 8,
 
 	/*-----initialise system------------------------------------ ------------------------------*/
 	// initialise variables etc from EEPROM
 	initEEPROM();
+	initBands();												// band edge index
 
 	//initialise  others
 	samplesAvg = samplesDefPar.val;								// set cyclic buffer default sample size
 	lab[freqTune].stat = freqTunePar.isFlg;						// freq tune startup status, flag set from options
 	lab[aBand].stat = aBandPar.isFlg;							// autoband status
 
+	civSync(CIV_FREQ, CIVTIMEOUT * (CIV_RETRIES + 1));			// wait for radio frequency, startup only
 	if (!(bool)getFreq())										// check if civ not working -
 		isCivEnable = false;									// disable civMode, display basic mode
 
@@ -164,76 +194,28 @@ void setup()
 
 	// initialise timers
 	aBandTimer.reset();											// autoband timer
-	heartBeatTimer.reset();										// heartbeat reset
 	dimTimer.reset();
+	histTime = millis() + 1000;									// end of first history second
 
 
 
 	// draw screen etc
 	initDisplay();
+
+#if TRACE_BOOT
+	traceStart(true);											// session trace from here, replay starts from this state
+#endif
 }
 
 /*-----------------------------------------------------------------------------------------------
   loop() - main loop
-  executes continuously
+  executes continuously. runs scheduler tasks (scheduler.ino)
 */
 void loop()
 {
-	int currBand;
-	float currFreq;
-
 	//digitalWrite(TOGGLE_PIN, !digitalRead(TOGGLE_PIN));
 
-	heartBeat();
-
-	blueTooth();
-
-	// dimmer timer - dim display if not active, touch to undim
-	if (dimTimer.check())										// check Metro timer
-		setDimmer();
-
-	// measure & display power, swr etc - main function
-	measure();
-
-	// do following if civMode enabled
-	if (isCivEnable)
-	{
-		// get and display frequency
-		currFreq = getFreq();									// get and display current frequency
-		displayValue(freq, currFreq);
-
-		// display band Mtrs
-		currBand = getBand(currFreq);							// -1(no band) or 0(160m) to 11 (4m)
-		if (currBand >= 0)
-		{
-			displayValue(band, hfBand[currBand].mtrs);			// display band metres
-			setRef(currBand);									// set spectrum ref
-		}
-
-		// get tuner status
-		tunerStatus();
-
-		// check for freq difference tune
-		freqDiffTune(currFreq);
-
-		// run FT8 auto band change
-		autoBand(currFreq);
-
-		// display %TX RF Power	else display spectrum ref			
-		if (fr[txPwr].isEnable)									// only if enabled
-			displayTxPwr();
-		else																								
-			displayValue(sRef, getRef());						//if (fr[sRef].isEnable), save on serial comms
-	}
-
-	// check if screen has been touched
-	if (ts.tirqTouched())
-	{
-		if (isDim)
-			resetDimmer();										// reset dimmer
-		else
-			touchChk();								// check for touch / button press
-	}
+	schedRun();
 }
 
 /*------------------------------------------------------------------------------------------
@@ -243,15 +225,17 @@ void loop()
 */
 void initDisplay(void)
 {
+	histView = HIST_OFF;									// trend graph closed, columns not drawn
+
 	if (!isCivEnable)										// if civMode disabled
 	{
-		copyFrame(basicFrame);								// copy basic frame layout
-		val[nettPwr].font = FONT48;							// increase font size
+		setLayout(basicFrame);								// basic frame layout
+		val[nettPwr].font = &FONT48;						// increase font size
 	}
 	else
 	{
-		copyFrame(civFrame);								// copy normal frame settings
-		val[nettPwr].font = FONT40;							// reset nettPwr font
+		setLayout(civFrame);								// normal frame layout
+		val[nettPwr].font = &FONT40;						// reset nettPwr font
 	}
 
 	// clear screen
@@ -264,17 +248,18 @@ void initDisplay(void)
 		displayLabel(i);
 		val[i].isUpdate = true;								// force redisplay
 	}
+	touchGrid();											// touch hit test grid for frame layout
 
 	// set measurement samples Reg size (averaging)
 	if (samplesAvg == samplesAltPar.val)
 	{
 		lab[options].colour = MENU_BG;						// samples button
-		fr[options].bg = MENU_COLOUR;
+		frs.bg[options] = MENU_COLOUR;
 	}
 	if (samplesAvg == samplesDefPar.val)					// display Default sample size
 	{
 		lab[options].colour = MENU_COLOUR;					// samples button
-		fr[options].bg = MENU_BG;
+		frs.bg[options] = MENU_BG;
 	}
 	sprintf(lab[options].txt, "Samples: %d", samplesAvg);
 	restoreFrame(options);
@@ -284,7 +269,7 @@ void initDisplay(void)
 	drawMeterScale(swrMeter);								// swr meter
 
 	// set current frequency for freq difference tuner
-	val[tuner].prevValue = getFreq();
+	tunerFreq = getFreq();
 	lab[tuner].stat = -1;									// force tuner status check
 
 	// frequency tune
@@ -296,6 +281,7 @@ void initDisplay(void)
 	// empty tirqtouch buffer for first operation
 	if (ts.tirqTouched())
 		ts.touched();
+	touchState = TOUCH_HELD;								// ignore touch that started option / init
 
 	delay(100);												// not too fast to avoid saturating CI-V commands
 
@@ -324,39 +310,32 @@ void setDimmer()
 }
 
 /*--------------------------- heartbeat() ------------------------------
-heartbeat()  - timer,displays pulsing dot top left corner
+heartbeat()  - heartbeat task, displays pulsing dot top left corner
+toggles each call
 */
 void heartBeat()
 {
 	static bool isHeartBeat;
 
-	if (heartBeatTimer.check())								// check Metro timer
-	{
-		if (isHeartBeat) {									// draw circle
-			tft.fillCircle(12, 18, 5, FG_COLOUR);
-			heartBeatTimer.reset();
-		}
-		else
-			tft.fillCircle(12, 18, 5, BG_COLOUR);
-
-		isHeartBeat = !isHeartBeat;							// set/reset flag, toggle indiactor on/off
-	}
+	if (isHeartBeat)										// draw circle
+		tft.fillCircle(12, 18, 5, FG_COLOUR);
+	else
+		tft.fillCircle(12, 18, 5, BG_COLOUR);
+
+	isHeartBeat = !isHeartBeat;								// set/reset flag, toggle indiactor on/off
 }
 
-/*--------------------------- copyFrame() ----------------------------------------
-copies default frame setting (frame.h) to  frame pointer
+/*--------------------------- setLayout() ----------------------------------------
+current frame layout (frames.h), geometry stays in flash
+resets run time colour, touch and enable state to layout defaults
 --------------------------------------------------------------------------------*/
-void copyFrame(frame* fPtr)
+void setLayout(const frame* layout)
 {
+	fr = layout;
 	for (int i = 0; i < NUM_FRAMES; i++)
 	{
-		fr[i].x = fPtr[i].x;
-		fr[i].y = fPtr[i].y;
-		fr[i].w = fPtr[i].w;
-		fr[i].h = fPtr[i].h;
-		fr[i].bg = fPtr[i].bg;
-		fr[i].isOutLine = fPtr[i].isOutLine;
-		fr[i].isTouch = fPtr[i].isTouch;
-		fr[i].isEnable = fPtr[i].isEnable;
+		frs.bg[i] = fr[i].bg;
+		frs.isTouch[i] = fr[i].isTouch;
+		frs.isEnable[i] = fr[i].isEnable;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,83 @@
+/*---------------------------------------------------------
+  POWERMETER III + ICOM 7300 CONTROLLER
+   Copyright 2018-2020  Roger Mawhinney, GI8GZM.
+  No publication with acknowledgement to author
+*/
+
+/*
+adaptive acquisition and display rates, ADAPTIVE true
+idle (no carrier): samples every ACT_IDLE_INTERVAL, measure every ACT_MEASURE_IDLE, display ACT_FPS_IDLE.
+getADC() detects carrier on the raw fwd sample and restores SAMPLE_INTERVAL in the same interrupt.
+act task sees isActive next scheduler pass, sets full measure / display rates, both due at once.
+falls back ACT_HOLD after last carrier sample. 'a' on USB Serial reports key down to first reading.
+*/
+
+/*------------------------------ actDetect() -------------------------------------------------
+carrier sample seen, interrupt only
+Called by: getADC(), getADCBlock()
+*/
+void actDetect()
+{
+	actCarrier = millis();
+	if (isActive)
+		return;
+	isActive = true;
+	actKeyUs = micros();
+#if !BLOCK_MODE
+	sampleTimer.update(SAMPLE_INTERVAL);					// full rate from next sample
+#endif
+}
+
+/*------------------------------ actCheck() -------------------------------------------------
+task rates follow isActive. back to idle after ACT_HOLD
+Called by: act task, every pass
+*/
+void actCheck()
+{
+#if ADAPTIVE
+	if (isActive && !isActRate)								// key down
+	{
+		actRates(true);
+		isActFirst = true;
+		actSwitches++;
+		return;
+	}
+
+	noInterrupts();											// isActive set by getADC()
+	if (isActive && millis() - actCarrier > ACT_HOLD)
+	{
+		isActive = false;
+#if !BLOCK_MODE
+		sampleTimer.update(ACT_IDLE_INTERVAL);
+#endif
+	}
+	interrupts();
+
+	if (!isActive && isActRate)
+		actRates(false);
+#endif
+}
+
+/*------------------------------ actRates() -------------------------------------------------
+measure and display task periods, full rate or idle. full rate tasks due now
+*/
+void actRates(bool isFast)
+{
+	isActRate = isFast;
+	schedPeriod(measureTask, isFast ? 2 * MS : ACT_MEASURE_IDLE * MS, isFast);
+	schedPeriod(displayTask, 1000 * MS / (isFast ? DISP_FPS : ACT_FPS_IDLE), isFast);
+}
+
+/*------------------------------ actReading() -------------------------------------------------
+reading over PWR_THRESHOLD. first after key down sets latency
+Called by: measure()
+*/
+void actReading()
+{
+	if (!isActFirst)
+		return;
+	isActFirst = false;
+	actLatency = micros() - actKeyUs;
+	if (actLatency > actWorst)
+		actWorst = actLatency;
+}
@@ -9,12 +9,40 @@
 #define	CONV_SPEED MED_SPEED
 #define	SAMPLE_SPEED MED_SPEED
 
+#define	BLOCK_AVERAGING 4								// fewer averages in block mode for higher sample rate
+
 // these setting reduce zero offset
 //#define		AVERAGING 4						 
 //#define		RESOLUTION 16
 //#define		CONV_SPEED HIGH_SPEED
 //#define		SAMPLE_SPEED VERY_HIGH_SPEED
 
+#if RESOLUTION > 15 && defined(__ARM_FEATURE_DSP)
+#error "blockStats() DSP kernel multiplies signed 16 bit halves, RESOLUTION 15 bits max"
+#endif
+
+/*---------------------------------------- initChans() ----------------------------------
+measurement channel pins and compiled power tables
+CH_MAIN band cal tables set later by setCal()
+*/
+void initChans(void)
+{
+	for (int c = 0; c < NUM_CHANS; c++)
+	{
+		adcChan* cPtr = &chan[c];
+
+		cPtr->fwdPin = chanPin[c][0];
+		cPtr->refPin = chanPin[c][1];
+		pinMode(cPtr->fwdPin, INPUT);
+		pinMode(cPtr->refPin, INPUT);
+		cPtr->fwdTbl = fwdPwrTbl.mW;
+		cPtr->refTbl = refPwrTbl.mW;
+		cPtr->fwdShift = 0;
+		cPtr->refShift = 0;
+		cPtr->swr = 100;
+	}
+}
+
 /*---------------------------------------- initADC() ----------------------------------
 initialises Analog-Digital convertor
 sets resolution, conversion speeds
@@ -33,74 +61,200 @@ void initADC(void)
 	adc->adc1->setConversionSpeed(ADC_CONVERSION_SPEED::CONV_SPEED);	// change the conversion speed
 	adc->adc1->setSamplingSpeed(ADC_SAMPLING_SPEED::SAMPLE_SPEED);		// change the sampling speed
 
+#if BLOCK_MODE
+	initADCBlock();												// hardware triggered, DMA block acquisition
+#else
 	sampleTimer.begin(getADC, SAMPLE_INTERVAL);					// getADC to run every 500 micro seconds
+#endif
+}
+
+/*---------------------------------------- initADCBlock() ----------------------------------
+block acquisition mode - BLOCK_MODE true
+PDB timer triggers both ADCs at BLOCK_RATE, DMA copies each result into ping-pong
+block buffers blk0[], blk1[]. Interrupt only when half a block buffer is full.
+*/
+void initADCBlock(void)
+{
+	adc->adc0->setAveraging(BLOCK_AVERAGING); 					// reduce averaging for higher sample rate
+	adc->adc1->setAveraging(BLOCK_AVERAGING);
+
+	// ADC 0 - reflected
+	dma0.source((volatile uint16_t&)ADC0_RA);					// ADC0 result register
+	dma0.triggerAtHardwareEvent(DMAMUX_SOURCE_ADC0);			// copy at end of each conversion
 
+	// ADC 1 - forward.  this channel signals block complete for both
+	dma1.source((volatile uint16_t&)ADC1_RA);
+	dma1.triggerAtHardwareEvent(DMAMUX_SOURCE_ADC1);
+	dma1.interruptAtHalf();										// first half full
+	dma1.interruptAtCompletion();								// second half full
+	dma1.attachInterrupt(getADCBlock);
+	initADCDMA();
 
+	adc->adc0->analogRead(chan[CH_MAIN].refPin);				// select pins for hardware trigger
+	adc->adc1->analogRead(chan[CH_MAIN].fwdPin);
+	adc->adc0->enableDMA();
+	adc->adc1->enableDMA();
+	adc->adc0->startPDB(BLOCK_RATE);							// start triggered conversions
+	adc->adc1->startPDB(BLOCK_RATE);
 }
 
 
+/*---------------------------------------- initADCDMA() ----------------------------------
+both DMA channels to start of block buffers, in step from the next conversion
+Called by: initADCBlock(), getADCBlock() if out of step
+*/
+void initADCDMA(void)
+{
+	dma0.disable();
+	dma1.disable();
+	dma0.destinationBuffer(blk0, sizeof(blk0));					// both halves, wraps at end
+	dma1.destinationBuffer(blk1, sizeof(blk1));
+	dma0.enable();
+	dma1.enable();
+}
+
 /* -------------------------------- get ADC() ----------------------------------------------
-get raw results from ADC and enter into cyclic buffer
-calculates average and peak values for ACD results
+get raw results from ADC and enter into cyclic buffers, one synced pair per channel
+calculates average and peak values for ACD results, see measChannel::add()
 
-SAMPLE_INTERVAL = 500usecs (= 2Khz).  Max samples MXBUF = 1000
+SAMPLE_INTERVAL = 500usecs (= 2Khz), ACT_IDLE_INTERVAL no carrier.  Max window WIN_MAX samples
+all windows updated every sample, peak kept per WIN_BLK block
+interrupt time ~ NUM_CHANS x (synced conversion + window update), see PZ_ADC profile zone
 ------------------------------------------------------------------------------------------*/
-void getADC()											// i = current buffer position, 0 to samplesAvg
+void getADC()
 {
+	PROFILE_ZONE(PZ_ADC);
+
+	int pos = sample;
+	bool isCarrier = false;
+
 	//digitalWriteFast(TOGGLE_PIN, HIGH);
-	unsigned int ar0, ar1;								// ar1 - forward, ar0 - reflected ADC results
 
 	// normal start point
-	result = adc->analogSyncRead(A1, A2);				// synced read ADC_0, ADC_1
-	ar1 = (uint16_t)result.result_adc1;					// forward volts
-	ar0 = (uint16_t)result.result_adc0;					// reflected volts
-
-	// cyclic buffer averaging
-	buf1Tot = buf1Tot - buf1[sample];					// remove oldest from total
-	buf1[sample] = ar1;									// record new sample
-	buf1Tot = buf1Tot + buf1[sample];					// add newest to total
-
-	buf0Tot = buf0Tot - buf0[sample];					// remove oldest from total
-	buf0[sample] = ar0;									// replace with new sample
-	buf0Tot = buf0Tot + buf0[sample];					// add newest to total
-
-	// cyclic buffer peak value
-	buf1Pk = 0;											// inialise fwd buffer only
-	for (int j = 0; j < samplesAvg; j++)				// cycle buffer to find peak fwd
-		if (buf1[j] >= buf1Pk)							// get peak forward sample
-		{
-			buf1Pk = buf1[j];							// new peak	
-			buf0Pk = buf0[j];							// save ref corresponding peak
-		}
-
-	sample++;											// increment sample
-	if (sample >= samplesAvg)							// if max buff, back to start
-		sample = 0;
+	for (int c = 0; c < NUM_CHANS; c++)
+	{
+		result = adc->analogSyncRead(chan[c].refPin, chan[c].fwdPin);	// synced read ADC_0, ADC_1
+		chan[c].add(pos, (uint16_t)result.result_adc1,	// forward volts
+			(uint16_t)result.result_adc0);				// reflected volts
+		if ((uint16_t)result.result_adc1 >= ACT_CODE)
+			isCarrier = true;
+	}
+	adcNext(pos);
+	if (isCarrier)
+		actDetect();									// full sample rate if idle
 
 	// digitalWriteFast(TOGGLE_PIN, LOW);
 }
 
-/*-------------------------- initADCSampls --------------------------------
-initialise cycllice buffers if samplesAvg has changed
+/* -------------------------------- getADCBlock() ----------------------------------------------
+DMA interrupt, block mode only.  runs once per BLOCK_SIZE sample pairs
+finds which half of ping-pong buffers is complete, DMA continues filling other half
+------------------------------------------------------------------------------------------*/
+void getADCBlock()
+{
+	PROFILE_ZONE(PZ_ADC);
+
+	int half = 0;										// completed half, 0 = first, 1 = second
+
+	int i1, i0 = -1;									// next write, fwd and ref buffers
+	int skew;
+
+	dma1.clearInterrupt();
+	i1 = (volatile uint16_t*)dma1.destinationAddress() - blk1;
+	if (i1 < BLOCK_SIZE)
+		half = 1;										// DMA now filling first half, second is done
+
+	// ref half must hold the same conversions. ADC0 transfer may still be in flight, a lost
+	// transfer leaves dma0 behind for good
+	for (int spin = 0; spin < BLOCK_SPIN; spin++)
+	{
+		i0 = (volatile uint16_t*)dma0.destinationAddress() - blk0;
+		skew = i0 - i1;
+		if (skew < 0)
+			skew += BLOCK_SIZE * 2;
+		if (skew <= 1)									// same, or a new conversion since i1 read
+			break;
+	}
+	if (skew > 1)
+	{
+		blkSkew++;
+		initADCDMA();									// both from buffer start, block dropped
+		return;
+	}
+
+	addADCBlock(&blk1[half * BLOCK_SIZE], &blk0[half * BLOCK_SIZE], BLOCK_SIZE);
+	blkCount++;											// blocks received
+}
+
+/* -------------------------------- addADCBlock() ----------------------------------------------
+adds block of n forward (b1) / reflected (b0) sample pairs to cyclic buffers
+any block source can use this - DMA buffers, recorded or test data
+------------------------------------------------------------------------------------------*/
+void addADCBlock(const volatile uint16_t* b1, const volatile uint16_t* b0, int n)
+{
+	bool isCarrier = false;
+
+	for (int i = 0; i < n; i++)
+	{
+		addADCSample(b1[i], b0[i]);
+		if (b1[i] >= ACT_CODE)
+			isCarrier = true;
+	}
+	if (isCarrier)
+		actDetect();									// full task rates if idle
+}
+
+/* -------------------------------- addADCSample() ----------------------------------------------
+enter one CH_MAIN forward (ar1) / reflected (ar0) sample pair into cyclic buffer
+updates all window totals and block peak used by measure()
+------------------------------------------------------------------------------------------*/
+void addADCSample(unsigned int ar1, unsigned int ar0)
+{
+	int pos = sample;
+
+	chan[CH_MAIN].add(pos, ar1, ar0);
+	adcNext(pos);
+}
+
+/* -------------------------------- adcNext() ----------------------------------------------
+all channels written at pos, next write position
+------------------------------------------------------------------------------------------*/
+void adcNext(int pos)
+{
+	if (++pos >= MAXBUF)								// if max buff, back to start
+		pos = 0;
+	sample = pos;
+	sampleCount++;										// for raw sample stream
+}
+
+/*-------------------------- setADCWindows() --------------------------------
+window sizes follow samplesDefPar, samplesAltPar, samplesCalPar, x WIN_MULT in block mode
+changed window total is summed from buffer history, no reset, every channel
+Called by: measure()
 */
-bool initADCSamples()
+void setADCWindows()
 {
-	static int prevSamplesAvg;
-	bool isInitd = false;
+	const int want[NUM_WIN] = { samplesDefPar.val, samplesAltPar.val, samplesCalPar.val };
 
-	if (prevSamplesAvg != samplesAvg)					// has samples number changed?  (samples options)
+	for (int k = 0; k < NUM_WIN; k++)
 	{
-		for (int i = 0; i < samplesAvg; i++)			// initialise buffers
-		{
-			buf1[i] = 0;
-			buf0[i] = 0;
-		}
-		buf1Tot = 0;
-		buf0Tot = 0;									// rest buffer totals
-		sample = 0;										// start new buffer
-		isInitd = true;
+		int n = constrain(want[k] * WIN_MULT, 1, WIN_MAX);
+
+		if (n == chan[CH_MAIN].winSize[k])
+			continue;
+
+		noInterrupts();									// no new samples while summing
+		for (int c = 0; c < NUM_CHANS; c++)
+			chan[c].setWindow(k, n, sample);
+		interrupts();
 	}
-	prevSamplesAvg = samplesAvg;						// save number of samples
+}
 
-	return isInitd;										// flase - not initialised, true - initialised
+/*-------------------------- adcWin() --------------------------------
+window for samples param n (samplesAvg)
+Returns: window, WIN_DEF if no window has n samples
+*/
+int adcWin(int n)
+{
+	return chan[CH_MAIN].win(n * WIN_MULT);
 }
@@ -13,17 +13,21 @@ uses lab.stat for on/off signals
 
 static bool isRestart;								// true  = restart timer at full countdown
 
-void autoBand(float freq)								// freq passed is probably current frequency
+void autoBand(uint32_t freq)							// freq (Hz) passed is probably current frequency
 {
 	int currBand = 0, nextBand;
 	static int aBandCountDown;							// Metro timer countdown
+	static uint32_t aBandFreq;							// frequency at last check
 
 	// check autoband is enabled and check status and exit conditions
-	if (!fr[aBand].isEnable || !lab[aBand].stat)		// enable flag and on/off status{
+	if (!frs.isEnable[aBand] || !lab[aBand].stat)		// enable flag and on/off status{
 		return;
 
 	// frequency manually changed? Turn off and update button
-	if (freq != getFreq())								// get current frequency
+	// not while own write is being read back, freq is still the old band
+	if (isRestart && !civSettling(CIV_FREQ))
+		aBandFreq = freq;								// start from current frequency
+	if (freq != aBandFreq && !civSettling(CIV_FREQ))	// changed since last check
 	{
 		lab[aBand].stat = false;						// reset flags, stop countdown
 		isRestart = false;
@@ -76,7 +80,8 @@ void autoBand(float freq)								// freq passed is probably current frequency
 	}
 
 	encodeFreq(civWriteFreq, hfBand[nextBand].ft8Freq);	// encode new freq
-	civWrite(civWriteFreq);								// change frequency - issue CAT command
+	civWriteBack(civWriteFreq, CIV_FREQ);				// change frequency, read back new frequency
+	aBandFreq = hfBand[nextBand].ft8Freq;				// expected frequency, not a manual change
 	aBandCountDown = aBandPar.val;						// reset autoband timer
 	aBandTimer.reset();									// reset timer to full countdown
 	aBandButton(false);									// update button
@@ -96,7 +101,7 @@ void aBandButton(int tStat)
 	{
 		strcpy(lab[aBand].txt, "  ABand OFF");
 		lab[aBand].colour = MENU_COLOUR;
-		fr[aBand].bg = MENU_BG;
+		frs.bg[aBand] = MENU_BG;
 		displayLabel(aBand);							// display Off label, blanks time
 		//displayValue(aBand, aBandPar.val);				// display time
 
@@ -106,7 +111,7 @@ void aBandButton(int tStat)
 	{
 		strcpy(lab[aBand].txt, "ABand: ");				// display label
 		lab[aBand].colour = MENU_BG;
-		fr[aBand].bg = MENU_COLOUR;
+		frs.bg[aBand] = MENU_COLOUR;
 		displayLabel(aBand);							// display label, time is blank
 		displayValue(aBand, aBandPar.val);				// display time
 		isRestart = true;
@@ -1,39 +1,176 @@
+/*---------------------------------------------------------
+  POWERMETER III + ICOM 7300 CONTROLLER
+   Copyright 2018-2020  Roger Mawhinney, GI8GZM.
+  No publication with acknowledgement to author
+*/
 
+/*
+bluetooth telemetry, HC-05 on btSerial
+measure() and radio task set latest values with tlmSet(). blueTooth() sends changed,
+subscribed values no faster than each field interval, within TLM_BUDGET bytes/sec.
+frames only built when btSerial tx buffer has room, never waits for the link.
+decoder: tools/btDecode.py
 
+frame: TLM_SYNC | type | len | payload (len bytes) | crc8 (0x07, init 0) of type, len, payload
+values payload: seq u8, then for each field sent: field u8, zigzag varint value
+*/
+
+/*------------------------------ blueTooth() -------------------------------------------------
+receive commands, send telemetry
+Called by: bt task
+*/
 void blueTooth()
 {
-	int state = 0;
+	while (btSerial.available() > 0)
+		tlmParse(btSerial.read());
 
-	//digitalWrite(LED_BUILTIN, LOW);
+	if (tlmBusTimer.check())
+		tlmBytes = 0;								// new budget window
+	tlmSend();
+}
 
-	while (btSerial.available() > 0) 			// Checks whether data is comming from the serial port
-	{
-		state = btSerial.read();				// Reads the data from the serial port
+/*------------------------------ tlmSet() -------------------------------------------------
+latest value for field, sent by blueTooth() if changed
+*/
+void tlmSet(int field, int32_t val)
+{
+	tlm[field].val = val;
+	tlm[field].isSet = true;
+}
 
-	//Serial.print(state);
-	//Serial.print("...");
-	//Serial.println(i++);
+/*------------------------------ tlmSend() -------------------------------------------------
+sends one values frame with fields due, if tx buffer and budget have room
+field due: subscribed, interval passed, and changed or not sent for TLM_KEEPALIVE
+*/
+void tlmSend()
+{
+	uint8_t f[TLM_PAYLOAD + 4];
+	unsigned long now = millis();
+	int room = btSerial.availableForWrite() - 4;	// payload room, header + crc
+	int n = 0;
+	bool isAll = true;								// all due fields fitted
+
+	if (room > TLM_PAYLOAD)
+		room = TLM_PAYLOAD;
+	if (room < 7 || tlmBytes + room + 4 > TLM_BUDGET)
+		return;										// link busy or budget used, try next time
 
-		if (state == '0')
+	f[3 + n++] = tlmSeq;
+	for (int i = 0; i < TLM_FIELDS; i++)
+	{
+		tlmField* tPtr = &tlm[i];
+		unsigned long age = now - tPtr->time;
+
+		if (!tPtr->isSub || !tPtr->isSet)
+			continue;
+		if (!isTlmSnap && (age < tPtr->interval || (tPtr->val == tPtr->sent && age < TLM_KEEPALIVE)))
+			continue;
+		if (n + 6 > room)
 		{
-			tft.fillCircle(160, 100, 15, BG_COLOUR);
-			//digitalWrite(LED_BUILTIN, LOW);		// Turn LED OFF
-			btSerial.println("LED: OFF");		// Send back, to the phone, the String "LED: ON"
-			Serial.println("LED: OFF");			// Send back, to the phone, the String "LED: ON"
-			state = 0;
+			isAll = false;							// rest next frame
+			break;
 		}
-		else if (state == '1')
-		{
-			tft.fillCircle(160, 100, 15, FG_COLOUR);
-			//digitalWrite(LED_BUILTIN, HIGH);
-			btSerial.println("LED: ON");
-			Serial.println("LED: ON");
 
-			state = 0;
-		}
+		f[3 + n++] = i;
+		n = tlmVarint(f, 3 + n, tPtr->val) - 3;
+		tPtr->sent = tPtr->val;
+		tPtr->time = now;
 	}
-	//float f = getFreq();
-	//btSerial.println(f, 5);
+	if (isAll)
+		isTlmSnap = false;
+	if (n == 1)
+		return;										// nothing due
+
+	f[0] = TLM_SYNC;
+	f[1] = TLM_VALUES;
+	f[2] = n;
+	f[3 + n] = tlmCrc(&f[1], n + 2);
+	btSerial.write(f, n + 4);						// fits in tx buffer, doesn't wait
+	tlmBytes += n + 4;
+	tlmSeq++;
 }
 
+/*------------------------------ tlmVarint() -------------------------------------------------
+adds zigzag varint of val at f[len], 7 bits per byte, low first, top bit = more
+Returns: new length
+*/
+int tlmVarint(uint8_t* f, int len, int32_t val)
+{
+	uint32_t z = ((uint32_t)val << 1) ^ (uint32_t)(val >> 31);	// small -ve and +ve values short
+
+	while (z >= 0x80)
+	{
+		f[len++] = z | 0x80;
+		z >>= 7;
+	}
+	f[len++] = z;
+	return len;
+}
+
+/*------------------------------ tlmParse() -------------------------------------------------
+command frame receiver, one byte per call. resyncs on TLM_SYNC after bad frame
+*/
+void tlmParse(uint8_t c)
+{
+	if (tlmRxN == 0 && c != TLM_SYNC)
+		return;										// wait for sync
+	tlmRx[tlmRxN++] = c;
 
+	if (tlmRxN >= 3 && tlmRx[2] > TLM_PAYLOAD)
+	{
+		tlmRxN = 0;									// bad length
+		return;
+	}
+	if (tlmRxN < 3 || tlmRxN < tlmRx[2] + 4)
+		return;										// incomplete
+
+	if (tlmCrc(&tlmRx[1], tlmRx[2] + 2) == tlmRx[tlmRxN - 1])
+		tlmCommand(tlmRx[1], &tlmRx[3], tlmRx[2]);
+	tlmRxN = 0;
+}
+
+/*------------------------------ tlmCommand() -------------------------------------------------
+actions command from phone / logger
+*/
+void tlmCommand(int type, const uint8_t* p, int n)
+{
+	switch (type)
+	{
+	case TLM_CMD_SUB:								// subscribe mask
+		if (n < 1)
+			break;
+		for (int i = 0; i < TLM_FIELDS; i++)
+			tlm[i].isSub = p[0] & (1 << i);
+		isTlmSnap = true;
+		break;
+
+	case TLM_CMD_RATE:								// field interval
+		if (n < 3 || p[0] >= TLM_FIELDS)
+			break;
+		tlm[p[0]].interval = p[1] | p[2] << 8;
+		break;
+
+	case TLM_CMD_SNAP:
+		isTlmSnap = true;
+		break;
+
+	default:
+		break;
+	}
+}
+
+/*------------------------------ tlmCrc() -------------------------------------------------
+CRC-8, poly 0x07, init 0
+*/
+uint8_t tlmCrc(const uint8_t* buff, int n)
+{
+	uint8_t crc = 0;
+
+	for (int i = 0; i < n; i++)
+	{
+		crc ^= buff[i];
+		for (int b = 0; b < 8; b++)
+			crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+	}
+	return crc;
+}
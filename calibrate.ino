@@ -26,6 +26,206 @@ void calMode()
 	restoreFrame(options);
 }
 
+/*---------------------------------calButton()----------------------------------------
+calMode touch on fwd/ref frames
+long touch on volts frame - add cal point for current band, power = reference meter reading, calPwrPar
+long touch on power frame - clear cal points for current band
+for reflected points, reverse coupler into dummy load
+reference power is set on the samples options screen (options button short touch)
+*/
+void calButton(int posn, int tStat)
+{
+	int band;
+	calCurve* cPtr;
+	unsigned long tot;
+	int win = adcWin(samplesAvg);						// window and its samples, x WIN_MULT in block mode
+	int n = chan[CH_MAIN].winSize[win];
+
+	if (lab[civ].stat || tStat != 2)					// calMode and long touch only
+		return;
+
+	band = getBand(getFreq());							// need band for cal curve
+	if (band < 0)
+		return;
+
+	calLoad(band);										// make sure current band curve loaded
+	if (posn == fwdVolts || posn == fwdPwr)
+	{
+		cPtr = &calCurr.fwd;
+		tot = chan[CH_MAIN].winTot1[win];				// fwd window total
+	}
+	else
+	{
+		cPtr = &calCurr.ref;
+		tot = chan[CH_MAIN].winTot0[win];
+	}
+
+	if (posn == fwdPwr || posn == refPwr)
+		cPtr->n = 0;									// clear curve
+	else												// add point. averaged ADC code, reference power
+		calAddPoint(cPtr, tot / (n ? n : 1), (uint32_t)calPwrPar.val * 100);
+
+	putCalEEPROM(band, calCurr);						// save band curves
+	calBand = -2;										// force table expand
+	calLoad(band);
+
+	// blink frame to show write, restored by displayTask() after CAL_BLINK
+	if (calBlink >= 0)
+		restoreFrame(calBlink);
+	eraseFrame(posn);
+	calBlink = posn;
+	calBlinkTimer.reset();
+}
+
+/*---------------------------------calPwrStep()----------------------------------------
+reference power one step up (dir 1) or down (dir -1), 0.1 W units
+steps 0.1 W to 5 W, 0.5 W to 20 W, 1 W to 50 W, 5 W above. limited to 0.1 W - CAL_MAX_PWR
+*/
+int calPwrStep(int p, int dir)
+{
+	int q = dir > 0 ? p : p - 1;						// step of the range moved in
+	int step = q < 50 ? 1 : q < 200 ? 5 : q < 500 ? 10 : 50;
+
+	if (dir > 0)
+		p = (p / step + 1) * step;
+	else
+		p = (p + step - 1) / step * step - step;		// down to a step multiple
+	return constrain(p, 1, CAL_MAX_PWR * 10);
+}
+
+/*---------------------------------calAddPoint()----------------------------------------
+add cal point to curve, keeps points sorted by ADC code
+same code replaces point. full curve replaces nearest point
+*/
+void calAddPoint(calCurve* cPtr, uint16_t code, uint32_t mW)
+{
+	int i, j;
+
+	if (code == 0 || mW == 0)							// no power, not a cal point
+		return;
+
+	// find nearest point
+	j = -1;
+	for (i = 0; i < cPtr->n; i++)
+		if (j < 0 || abs(cPtr->pt[i].code - code) < abs(cPtr->pt[j].code - code))
+			j = i;
+
+	if (j >= 0 && (cPtr->pt[j].code == code || cPtr->n >= CAL_POINTS))
+	{
+		for (i = j; i < cPtr->n - 1; i++)				// remove point to be replaced
+			cPtr->pt[i] = cPtr->pt[i + 1];
+		cPtr->n--;
+	}
+
+	// insert new point in code order
+	for (i = cPtr->n; i > 0 && cPtr->pt[i - 1].code > code; i--)
+		cPtr->pt[i] = cPtr->pt[i - 1];
+	cPtr->pt[i].code = code;
+	cPtr->pt[i].mW = mW;
+	cPtr->n++;
+}
+
+/*---------------------------------setCal()----------------------------------------
+select power tables for band, called on each loop
+only changes tables if band has changed
+*/
+void setCal(int band)
+{
+	if (band != calBand)
+		calLoad(band);
+}
+
+/*---------------------------------calLoad()----------------------------------------
+loads band cal curves from EEPROM and expands to cal tables
+band with no cal points, or no band (-1), uses compiled tables (pwrTables.h). CH_MAIN only
+*/
+void calLoad(int band)
+{
+	if (band == calBand)
+		return;
+	calBand = band;
+
+	calCurr.fwd.n = 0;
+	calCurr.ref.n = 0;
+	if (band >= 0)
+		getCalEEPROM(band, calCurr);
+	if (calCurr.fwd.n > CAL_POINTS)						// EEPROM not set
+		calCurr.fwd.n = 0;
+	if (calCurr.ref.n > CAL_POINTS)
+		calCurr.ref.n = 0;
+
+	// CH_MAIN tables changed while measure() uses them, ok as only value changes
+	adcChan* cPtr = &chan[CH_MAIN];
+	if (calExpand(calFwdTbl, calCurr.fwd))
+	{
+		cPtr->fwdTbl = calFwdTbl;
+		cPtr->fwdShift = CAL_TBL_SHIFT;
+	}
+	else
+	{
+		cPtr->fwdTbl = fwdPwrTbl.mW;
+		cPtr->fwdShift = 0;
+	}
+
+	if (calExpand(calRefTbl, calCurr.ref))
+	{
+		cPtr->refTbl = calRefTbl;
+		cPtr->refShift = CAL_TBL_SHIFT;
+	}
+	else
+	{
+		cPtr->refTbl = refPwrTbl.mW;
+		cPtr->refShift = 0;
+	}
+}
+
+/*---------------------------------calExpand()----------------------------------------
+expands cal curve to table of CAL_TBL_SIZE + 1 entries
+interpolates sqrt(power), ie RF volts, linear with ADC code between points
+below first point uses zero code = zero power. above last point continues last segment
+returns false if curve has no points
+*/
+bool calExpand(uint32_t* tbl, calCurve& cc)
+{
+	int j = 0;											// next cal point above code
+	float c0, c1, v0, v1;								// segment codes and sqrt(power)
+	float code, v;
+
+	if (cc.n == 0)										// no cal points
+		return false;
+
+	for (int i = 0; i <= CAL_TBL_SIZE; i++)
+	{
+		code = i << CAL_TBL_SHIFT;
+		while (j < cc.n && cc.pt[j].code <= code)
+			j++;
+
+		// select segment
+		if (j == cc.n)									// above last point
+			j = cc.n - 1;
+		c1 = cc.pt[j].code;
+		v1 = sqrt(cc.pt[j].mW);
+		if (j == 0)										// below first point or single point
+		{
+			c0 = 0;
+			v0 = 0;
+		}
+		else
+		{
+			c0 = cc.pt[j - 1].code;
+			v0 = sqrt(cc.pt[j - 1].mW);
+		}
+		if (j == cc.n - 1 && code >= c1)				// restore for next code
+			j = cc.n;
+
+		v = v0 + (v1 - v0) * (code - c0) / (c1 - c0);
+		if (v < 0)
+			v = 0;
+		tbl[i] = v * v + 0.5;
+	}
+	return true;
+}
+
 
 /*--------------------------- screenCal() -------------------
 use this to determine x.y mapping
@@ -7,32 +7,53 @@
 /*---------------------------------  eePromInit() ---------------------------------------------------------
 Initialises EEPROM to default values from frame.h
    Normal start up reads EEPROM into band data and global variables
-   EEPROM(0) is initialised flag, 0=not, 1= done
+   EEPROM(0), EEPROM(1) is layout header, EE_MAGIC and EE_VERSION. v004 EEPROM(0) = 1 is converted,
+   its records read without CRC, cal records cleared (v004 had none)
+   record with no good A / B slot keeps compiled default, rewritten by eeFlush(). bad cal record is cleared
+   samples params limited to 1 - SAMPLES_MAX, EEPROM may be from a larger buffer or the other sample mode
 ------------------------------------------------------------------------------------------*/
 void initEEPROM(void)
 {
-	bool isEEInit = 0;
-	int eeAddr;
+	int eeFlag = 0;
+	bool isOld;
+	param* samplesPars[] = { &samplesDefPar, &samplesAltPar, &samplesCalPar };
 
 	// comment this line to reset EEPROM to default values
-	isEEInit = EEPROM.read(0);
+	eeFlag = EEPROM.read(0);
 
-	if (isEEInit) {
+	isOld = (eeFlag == EE_OLD_FLAG);
+	if (isOld || (eeFlag == EE_MAGIC && EEPROM.read(1) == EE_VERSION)) {
 		// EEProm has been initialised.  Get values and set variables
 		for (int i = 0; i < NUM_BANDS; i++) {
-			eeAddr = EEADDR_BAND + EEINCR * i;
-			EEPROM.get(eeAddr, hfProm[i]);
-
+			if (!eeRead(EEADDR_BAND + EEINCR * i, &hfProm[i], sizeof(eeProm0), isOld)) {
+				hfProm[i].sRef = hfBand[i].sRef;		// bad record, compiled values
+				hfProm[i].isTtune = hfBand[i].isTtune;
+				hfProm[i].isABand = hfBand[i].isABand;
+				eeDirty |= 1UL << (EE_BAND + i);
+			}
 			hfBand[i].sRef = hfProm[i].sRef;
 			hfBand[i].isTtune = hfProm[i].isTtune;
 			hfBand[i].isABand = hfProm[i].isABand;
 		}
-		// get variables / parameters
-		EEPROM.get(freqTunePar.eeAddr, freqTunePar);
-		EEPROM.get(aBandPar.eeAddr, aBandPar);
-		EEPROM.get(samplesDefPar.eeAddr, samplesDefPar);
-		EEPROM.get(samplesAltPar.eeAddr, samplesAltPar);
-		EEPROM.get(samplesCalPar.eeAddr, samplesCalPar);
+		// get variables / parameters. params after NUM_PARS_V004 keep compiled values on v004
+		for (int i = 0; i < (isOld ? NUM_PARS_V004 : NUM_PARS); i++)
+			if (!eeRead(eePars[i]->eeAddr, eePars[i], sizeof(param), isOld))
+				eeDirty |= 1UL << (EE_PAR + i);
+		if (isOld) {
+			eeDirty = 0xFFFFFFFF;								// add CRCs and header
+
+			eeCal cal = {};										// no band calibration curves
+			for (int i = 0; i < NUM_BANDS; i++)
+				putCalEEPROM(i, cal);
+		}
+
+		// samples params fit a window, else the window is clamped and samplesAvg finds no window
+		for (int i = 0; i < 3; i++)
+			if (samplesPars[i]->val < 1 || samplesPars[i]->val > SAMPLES_MAX)
+			{
+				samplesPars[i]->val = constrain(samplesPars[i]->val, 1, SAMPLES_MAX);
+				putParEEPROM(*samplesPars[i]);
+			}
 	}
 	else {
 		// initialise EEPROM from compiled values
@@ -40,30 +61,28 @@ void initEEPROM(void)
 			hfProm[i].sRef = hfBand[i].sRef;
 			hfProm[i].isTtune = hfBand[i].isTtune;
 			hfProm[i].isABand = hfBand[i].isABand;
-			putBandEEPROM(i);
-			//eeAddr = EEADDR_BAND + EEINCR * i;
-			//EEPROM.put(eeAddr, hfProm[i]);
 		}
-		// init variables
-		EEPROM.put(freqTunePar.eeAddr, freqTunePar);
-		EEPROM.put(aBandPar.eeAddr, aBandPar);
-		EEPROM.put(samplesDefPar.eeAddr, samplesDefPar);
-		EEPROM.put(samplesAltPar.eeAddr, samplesAltPar);
-		EEPROM.put(samplesCalPar.eeAddr, samplesCalPar);
-
-		// set EEPROMinitialised flag
-		EEPROM.write(0, true);
+		eeDirty = 0xFFFFFFFF;									// all bands and params
+
+		// no band calibration curves, use compiled tables
+		eeCal cal = {};
+		for (int i = 0; i < NUM_BANDS; i++)
+			putCalEEPROM(i, cal);
 	}
+
+	// header last, only valid once records are written
+	if (eeDirty)
+		eeFlush();
 }
 
-// EEPROM put functions.  Simple but keeps all EEPROM functions in this module
+// EEPROM put functions.  Mark record dirty, eeFlush() writes EE_DELAY after last change
 /*-------------------------- putBandEEPROM() -------------------
 puts band date to EEPROM
 ---------------------------------------------------------------*/
 void putBandEEPROM(int bNum)
 {
-	int eeAddr = EEADDR_BAND + EEINCR * bNum;
-	EEPROM.put(eeAddr, hfProm[bNum]);
+	eeDirty |= 1UL << (EE_BAND + bNum);
+	eeTimer.reset();									// restart delay, changes coalesced
 }
 
 /*---------------------------putParEEPROM() -----------------
@@ -71,5 +90,151 @@ put parameter data to EEROM
 -----------------------------------------------------------*/
 void putParEEPROM(param par)
 {
-	EEPROM.put(par.eeAddr, par);;
+	for (int i = 0; i < NUM_PARS; i++)
+		if (eePars[i]->eeAddr == par.eeAddr)
+			eeDirty |= 1UL << (EE_PAR + i);
+	eeTimer.reset();
+}
+
+/*-------------------------- eeFlush() -------------------
+writes dirty records and header. only changed bytes are written
+Called by: eeprom task, initEEPROM()
+---------------------------------------------------------------*/
+void eeFlush()
+{
+	for (int i = 0; i < NUM_BANDS; i++)
+		if (eeDirty & (1UL << (EE_BAND + i)))
+			eeWrite(EEADDR_BAND + EEINCR * i, &hfProm[i], sizeof(eeProm0));
+	for (int i = 0; i < NUM_PARS; i++)
+		if (eeDirty & (1UL << (EE_PAR + i)))
+			eeWrite(eePars[i]->eeAddr, eePars[i], sizeof(param));
+
+	eeUpdate(0, EE_MAGIC);
+	eeUpdate(1, EE_VERSION);
+	eeDirty = 0;
+	eeFlushes++;
+}
+
+/*-------------------------- eeRead() -------------------
+reads newest good copy of record at eeAddr into rec. isOld: A slot, no CRC (v004)
+Returns: true if rec read
+---------------------------------------------------------------*/
+bool eeRead(int eeAddr, void* rec, int n, bool isOld)
+{
+	int slot = isOld ? eeAddr : eeSlot(eeAddr, n);
+
+	if (slot < 0)
+		return false;
+	for (int i = 0; i < n; i++)
+		((uint8_t*)rec)[i] = EEPROM.read(slot + i);
+	return true;
+}
+
+/*-------------------------- eeWrite() -------------------
+writes record to the older slot: data, CRC in last byte of EEINCR slot, then sequence byte.
+until the sequence byte is written the other slot is newest. nothing written if newest holds rec
+---------------------------------------------------------------*/
+void eeWrite(int eeAddr, const void* rec, int n)
+{
+	const uint8_t* p = (const uint8_t*)rec;
+	int slot = eeSlot(eeAddr, n);
+	int s = eeAddr;
+	uint8_t seq = 0;
+
+	if (slot >= 0)
+	{
+		int i;
+		for (i = 0; i < n && EEPROM.read(slot + i) == p[i]; i++)
+			;
+		if (i == n)
+			return;										// unchanged
+		s = (slot == eeAddr) ? eeAddr + EE_ALT : eeAddr;
+		seq = EEPROM.read(slot + EE_SEQ) + 1;
+	}
+	for (int i = 0; i < n; i++)
+		eeUpdate(s + i, p[i]);
+	eeUpdate(s + EEINCR - 1, eeCrc(p, n));
+	eeUpdate(s + EE_SEQ, seq);							// commit
+}
+
+/*-------------------------- eeSlot() -------------------
+newest copy of record at eeAddr with good CRC, A slot eeAddr or B slot eeAddr + EE_ALT
+slot sequence numbers differ by one, compared with wrap. equal (v3 image) reads A
+Returns: slot address, -1 if neither good
+---------------------------------------------------------------*/
+int eeSlot(int eeAddr, int n)
+{
+	uint8_t buff[EEINCR];
+	int slot = -1;
+	uint8_t seq = 0;
+
+	for (int s = eeAddr; s <= eeAddr + EE_ALT; s += EE_ALT)
+	{
+		for (int i = 0; i < n; i++)
+			buff[i] = EEPROM.read(s + i);
+		if (eeCrc(buff, n) != EEPROM.read(s + EEINCR - 1))
+			continue;
+		if (slot < 0 || (int8_t)(EEPROM.read(s + EE_SEQ) - seq) > 0)
+		{
+			slot = s;
+			seq = EEPROM.read(s + EE_SEQ);
+		}
+	}
+	return slot;
+}
+
+/*-------------------------- eeUpdate() -------------------
+writes byte only if changed, counts writes
+---------------------------------------------------------------*/
+void eeUpdate(int eeAddr, uint8_t b)
+{
+	if (EEPROM.read(eeAddr) == b)
+		return;
+	EEPROM.write(eeAddr, b);
+	eeBytes++;
+}
+
+/*-------------------------- eeCrc() -------------------
+CRC-8, poly 0x07, init 0
+---------------------------------------------------------------*/
+uint8_t eeCrc(const uint8_t* buff, int n)
+{
+	uint8_t crc = 0;
+
+	for (int i = 0; i < n; i++)
+	{
+		crc ^= buff[i];
+		for (int b = 0; b < 8; b++)
+			crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+	}
+	return crc;
+}
+
+/*-------------------------- getCalEEPROM() -------------------
+gets band calibration curves from EEPROM. bad CRC gives no points, compiled tables used
+Returns: true if CRC good
+---------------------------------------------------------------*/
+bool getCalEEPROM(int bNum, eeCal& cal)
+{
+	int eeAddr = EEADDR_CAL + sizeof(eeCal) * bNum;
+
+	EEPROM.get(eeAddr, cal);
+	if (eeCrc((const uint8_t*)&cal, sizeof(eeCal)) == EEPROM.read(EEADDR_CALCRC + bNum))
+		return true;
+	cal = {};
+	return false;
+}
+
+/*-------------------------- putCalEEPROM() -------------------
+puts band calibration curves and CRC to EEPROM. written now, cal points are added by hand
+only changed bytes are written
+---------------------------------------------------------------*/
+void putCalEEPROM(int bNum, eeCal& cal)
+{
+	int eeAddr = EEADDR_CAL + sizeof(eeCal) * bNum;
+	const uint8_t* p = (const uint8_t*)&cal;
+
+	for (int i = 0; i < (int)sizeof(eeCal); i++)
+		eeUpdate(eeAddr + i, p[i]);
+	eeUpdate(EEADDR_CALCRC + bNum, eeCrc(p, sizeof(eeCal)));
 }
@@ -38,29 +38,43 @@ aBandTimeOpt = 20,		// options - autoband time
 
 samplesDefOpt = 21,		// meaurement average - samples register size
 samplesAltOpt = 22,		// meaurement average - samples register size
-samplesCalOpt = 23;		// calibrate average - samples register size
+samplesCalOpt = 23,		// calibrate average - samples register size
+
+sweepGraph = 24,		// SWR sweep graph
+trendGraph = 25,		// power / SWR history graph
+
+calPwrOpt = 26;			// options - reference meter power for cal points
 
 // frame ------------------------------------------------------------------------
 #define RADIUS 5				// frame corner radius
 #define LINE_COLOUR LIGHTGREY	// frame line colour
-#define NUM_FRAMES 24			// total number of frames used
+#define NUM_FRAMES 27			// total number of frames used
 
+// layouts are const tables in flash. fr points at current layout, setLayout() swaps pointer
+// bg, isTouch, isEnable are layout defaults, changed at run time in frs
 struct frame {
-	int x;						// top left corner - x coord
-	int y;						// top left corner - y coord
-	int w;						// horizontal width
-	int h;						// vertical height
-	int bg;						// frame background colour
+	int16_t x;					// top left corner - x coord
+	int16_t y;					// top left corner - y coord
+	int16_t w;					// horizontal width
+	int16_t h;					// vertical height
+	uint16_t bg;				// frame background colour, default
 	bool isOutLine;			// outline flg / don't display
-	bool isTouch;				// frame enabled for touch
-	bool isEnable;				// enable frame & CONTENTS
+	bool isTouch;				// frame enabled for touch, default
+	bool isEnable;				// enable frame & CONTENTS, default
 };
 
-frame fr[NUM_FRAMES];                   // program variables.  Copy either civFrame or Basic Frame
+// run time frame state, reset from layout by setLayout()
+struct frameState {
+	uint16_t bg[NUM_FRAMES];	// frame background colour
+	bool isTouch[NUM_FRAMES];	// frame enabled for touch
+	bool isEnable[NUM_FRAMES];	// enable frame & CONTENTS
+};
+
+frameState frs;							// program variables
 
 
 //------------------------------------  civ (default) frame layout ------------------------------
-frame civFrame[NUM_FRAMES] = {
+const frame civFrame[NUM_FRAMES] = {
   { 5, 10,		100, 75,	BG_COLOUR,	true,	true,	true},		// 0-nettPwr (default - nettPower)
   { 110, 10,	100, 65,	BG_COLOUR,	true,	true,	true},		// 1-peakPwr
   { 215, 10,	100, 65,	BG_COLOUR,	true,	true,	true},		// 2-swr
@@ -95,13 +109,22 @@ frame civFrame[NUM_FRAMES] = {
 	// variables / parameters
   { 200, 10,	90, 40,		ALT_BG,		true,	false,	false},		// 19-freqTuneOpt (options for freqTune by hf band)
   { 200, 125,	90, 40,		ALT_BG,		true,	false,	false},		// 20-aBandTimeOpt (options for autoband 45ange by hf band)
-  { 200, 40,	90, 40,		ALT_BG,		true,	false,	false},		// 21-samplesDefault (averaging samples - default)
-  { 200, 100,	90, 40,		ALT_BG,		true,	false,	false},		// 22-samplesAltOpt	(averaging samples - alternate)
-  { 200, 160,	90, 40,		ALT_BG,		true,	false,	false},		// 23-samplesCalOpt	(averaging samples - calibrate mode)
+  { 200, 35,	90, 35,		ALT_BG,		true,	false,	false},		// 21-samplesDefault (averaging samples - default)
+  { 200, 80,	90, 35,		ALT_BG,		true,	false,	false},		// 22-samplesAltOpt	(averaging samples - alternate)
+  { 200, 125,	90, 35,		ALT_BG,		true,	false,	false},		// 23-samplesCalOpt	(averaging samples - calibrate mode)
+
+	// swr sweep
+  { 5, 95,		315, 115,	BG_COLOUR,	true,	false,	false},		// 24-sweepGraph (SWR vs freq, meter and civ area)
+
+	// power / swr history
+  { 5, 95,		315, 115,	BG_COLOUR,	true,	false,	false},		// 25-trendGraph (power, SWR vs time, meter and civ area)
+
+	// calibrate
+  { 200, 170,	90, 35,		ALT_BG,		true,	false,	false},		// 26-calPwrOpt (cal point reference meter power)
 };
 
 // ------------------------------  basic (non civ) frame layout -------------------------------
-frame basicFrame[NUM_FRAMES] = {
+const frame basicFrame[NUM_FRAMES] = {
   { 5, 10,		100, 100,	BG_COLOUR,	true,	true,	true},		// 0-nettPwr (default - nettPower)
   { 110, 10,	100, 65,	BG_COLOUR,	true,	true,	true},		// 1-peakPwr
   { 215, 10,	100, 65,	BG_COLOUR,	true,	true,	true},		// 2-swr
@@ -136,58 +159,73 @@ frame basicFrame[NUM_FRAMES] = {
 	// variables / parameters
   { 200, 10,	90, 40,		ALT_BG,		true,	false,	false},		// 19-freqTuneOpt (options for freqTune by hf band)
   { 200, 125,	90, 40,		ALT_BG,		true,	false,	false},		// 20-aBandTimeOpt (options for autoband 45ange by hf band)
-  { 200, 40,	90, 40,		ALT_BG,		true,	false,	false},		// 21-samplesDefault (averaging samples - default)
-  { 200, 100,	90, 40,		ALT_BG,		true,	false,	false},		// 22-samplesAltOpt	(averaging samples - alternate)
-  { 200, 160,	90, 40,		ALT_BG,		true,	false,	false},		// 23-samplesCalOpt	(averaging samples - calibrate mode)
+  { 200, 35,	90, 35,		ALT_BG,		true,	false,	false},		// 21-samplesDefault (averaging samples - default)
+  { 200, 80,	90, 35,		ALT_BG,		true,	false,	false},		// 22-samplesAltOpt	(averaging samples - alternate)
+  { 200, 125,	90, 35,		ALT_BG,		true,	false,	false},		// 23-samplesCalOpt	(averaging samples - calibrate mode)
+
+	// swr sweep
+  { 5, 95,		315, 115,	BG_COLOUR,	true,	false,	false},		// 24-sweepGraph (SWR vs freq, meter and civ area)
+
+	// power / swr history
+  { 5, 95,		315, 115,	BG_COLOUR,	true,	false,	false},		// 25-trendGraph (power, SWR vs time, meter and civ area)
+
+	// calibrate
+  { 200, 170,	90, 35,		ALT_BG,		true,	false,	false},		// 26-calPwrOpt (cal point reference meter power)
 };
 
+const frame* fr = civFrame;				// current layout, civFrame or basicFrame
+
 // label --------------------------------------------------------------------------------------------------------
 #define GAP 5						// gap from frame outline
 
 struct label {
 	char txt[30];					// frame label text
 	int colour;						// text colour
-	ILI9341_t3_font_t  font;		// text font size
+	const ILI9341_t3_font_t* font;	// text font size, font in flash
 	char xJustify;					// 'L'eft, 'C'entre, 'R'ight
 	char yJustify;					// 'T'op, 'M'iddle, 'B'ottom
 	int stat;						// status, used for update label display, -1 for errors
 };
 
 label lab[] = {
-  { "Watts",		FG_COLOUR,		FONT14,     'C', 'B', 0,	},		// nett Pwr frame
-  { "Pep",			FG_COLOUR,		FONT14,		'C', 'B', 0,	},		// peak Pwr	 lab.stat =1 for peakpwr, .stat=0 for PEP
-  { "vSWR",			FG_COLOUR,		FONT14,		'C', 'B', 0,	},		// VSWR
-  { "dBm",			FG_COLOUR,		FONT14,		'C', 'B', 0,	},		// dBm
+  { "Watts",		FG_COLOUR,		&FONT14,     'C', 'B', 1,	},		// nett Pwr frame, stat 1 = background, 0 = red power on
+  { "Pep",			FG_COLOUR,		&FONT14,		'C', 'B', 0,	},		// peak Pwr	 lab.stat =1 for peakpwr, .stat=0 for PEP
+  { "vSWR",			FG_COLOUR,		&FONT14,		'C', 'B', 0,	},		// VSWR
+  { "dBm",			FG_COLOUR,		&FONT14,		'C', 'B', 0,	},		// dBm
 
-  { "Fwd Pwr",		YELLOW,			FONT10,		'L', 'M', 0,	},		// forward Pwr frame
-  { "Ref Pwr",		YELLOW,			FONT10,		'R', 'M', 0,	},		// reflected Pwr
-  { "Fwd Volts",	GREENYELLOW,	FONT10,		'R', 'M', 0,	},		// Forward voltage
-  { "Ref Volts",	GREENYELLOW,	FONT10,		'L', 'M', 0,	},		// Reflected Voltage
+  { "Fwd Pwr",		YELLOW,			&FONT10,		'L', 'M', 0,	},		// forward Pwr frame
+  { "Ref Pwr",		YELLOW,			&FONT10,		'R', 'M', 0,	},		// reflected Pwr
+  { "Fwd Volts",	GREENYELLOW,	&FONT10,		'R', 'M', 0,	},		// Forward voltage
+  { "Ref Volts",	GREENYELLOW,	&FONT10,		'L', 'M', 0,	},		// Reflected Voltage
 
   // meters
-  { "       Watts",	MTXT_COLOUR,		FONT8,		'L', 'B', 0,	},	// Pwr Meter
-  { "          vSWR ",	MTXT_COLOUR,	FONT8,		'L', 'B', 0,	},	// SWR Meter
+  { "       Watts",	MTXT_COLOUR,		&FONT8,		'L', 'B', 0,	},	// Pwr Meter
+  { "          vSWR ",	MTXT_COLOUR,	&FONT8,		'L', 'B', 0,	},	// SWR Meter
 
   // buttons
-  { "Options",		MENU_COLOUR,	 FONT12,	'C', 'M', 0,	},		// options button
-  { "FreqTune On",	MENU_COLOUR,	 FONT12,	'L', 'M', 0,	},		// freqtuner button
-  { "ABand On",		MENU_COLOUR,	 FONT12,	'L', 'M', 0,	},		// autoBand button
+  { "Options",		MENU_COLOUR,	 &FONT12,	'C', 'M', 0,	},		// options button
+  { "FreqTune On",	MENU_COLOUR,	 &FONT12,	'L', 'M', 0,	},		// freqtuner button
+  { "ABand On",		MENU_COLOUR,	 &FONT12,	'L', 'M', 0,	},		// autoBand button
 
   //civ
- // { "Icom IC7300 - CIV Control", GREEN, FONT10, 'C', 'T', 1, },		// civ
-  { "",				GREEN,			FONT10,		'C', 'T', true, },		// civ
-  { "Tune Off",		FG_COLOUR,		FONT18,		'C', 'M', 0,	},		// tuner
-  { "mtrs ",		FG_COLOUR,		FONT14,		'R', 'M', 0,	},		// band
-  { "Ref ",			FG_COLOUR,		FONT14,		'R', 'M', 0,	},		// ref
-  { "%Tx ",			FG_COLOUR,		FONT14,		'R', 'M', 0,	},		// % RF Power setting
-  { "MHz ",			CIV_COLOUR,		FONT18,		'R', 'M', 0,	},		// freq
+ // { "Icom IC7300 - CIV Control", GREEN, &FONT10, 'C', 'T', 1, },		// civ
+  { "",				GREEN,			&FONT10,		'C', 'T', true, },		// civ
+  { "Tune Off",		FG_COLOUR,		&FONT18,		'C', 'M', 0,	},		// tuner
+  { "mtrs ",		FG_COLOUR,		&FONT14,		'R', 'M', 0,	},		// band
+  { "Ref ",			FG_COLOUR,		&FONT14,		'R', 'M', 0,	},		// ref
+  { "%Tx ",			FG_COLOUR,		&FONT14,		'R', 'M', 0,	},		// % RF Power setting
+  { "MHz ",			CIV_COLOUR,		&FONT18,		'R', 'M', 0,	},		// freq
 
   // variable pa	rameters
-  { " kHz",			CIV_COLOUR,		FONT14,		'R', 'M', 0,	},		// tuner freq diff
-  { " Secs",		CIV_COLOUR,		FONT14,		'R', 'M', 0,	},		// aBand time, secs
-  { "",				CIV_COLOUR,		FONT14,		'L', 'M', 0,	},		// default samples size
-  { "",				CIV_COLOUR,		FONT14,		'R', 'M', 0,	},		// alternate samples size
-  { "",				CIV_COLOUR,		FONT14,		'R', 'M', 0,	},		// calibrate samples size
+  { " kHz",			CIV_COLOUR,		&FONT14,		'R', 'M', 0,	},		// tuner freq diff
+  { " Secs",		CIV_COLOUR,		&FONT14,		'R', 'M', 0,	},		// aBand time, secs
+  { "",				CIV_COLOUR,		&FONT14,		'L', 'M', 0,	},		// default samples size
+  { "",				CIV_COLOUR,		&FONT14,		'R', 'M', 0,	},		// alternate samples size
+  { "",				CIV_COLOUR,		&FONT14,		'R', 'M', 0,	},		// calibrate samples size
+
+  { "SWR Sweep",	FG_COLOUR,		&FONT10,		'C', 'T', 0,	},		// swr sweep graph
+  { "Trend",		FG_COLOUR,		&FONT10,		'C', 'T', 0,	},		// power / swr history graph
+  { " W",			CIV_COLOUR,		&FONT14,		'R', 'M', 0,	},		// cal reference power
 };
 
 // value ---------------------------------------------------------------------------
@@ -195,48 +233,86 @@ struct value {
 	float prevValue;					// previous value
 	int decs;							// decimals
 	int colour;							// text colour
-	ILI9341_t3_font_t  font;			// text font size
+	const ILI9341_t3_font_t* font;		// text font size, font in flash
 	bool isUpdate;						// true forces update
 };
 
 value val[] = {
-  { 0.0, 0,	 FG_COLOUR,		FONT40,		true},				// 0 - nettPwr
-  { 0.0, 0,	 FG_COLOUR,		FONT32,		true},				// 1 - peakPwr
-  { 0.0, 1,	 ORANGE,		FONT28,		true},				// 2 - swr
-  { 0.0, 0,	 GREEN,			FONT48,		true},				// 3 - dbm
-
-  { 0.0, 2,	 ORANGE,		FONT18,		true},				// 4 - fwdPwr
-  { 0.0, 2,	 ORANGE,		FONT18,		true},				// 5 - refPwr
-  { 0.0, 4,	 ORANGE,		FONT20,		true},				// 6 - fwdVolts
-  { 0.0, 4,	 ORANGE,		FONT20,		true},				// 7 - refVolts
-
-  { 0.0, 0,	 ORANGE,		FONT18,		true},				// 8 - nettPwrMeter
-  { 0.0, 0,	 ORANGE,		FONT18,		true},				// 9 - swrMeter
-
-  { 0.0, 0,	 BG_COLOUR,		FONT16,		true},				// options button
-  { 0.0, 0,	 BG_COLOUR,		FONT16,		true},				// freqtuner button
-  { 0.0, 0,	 BG_COLOUR,		FONT16,		true},				// autoBand button
-
-  { 0.0, 4,	 ORANGE,		FONT18,		true},				// 13 - civ
-  { 0.0, 5,	 CIV_COLOUR,	FONT24,		true},				// tuner
-  { 0.0, 0,	 CIV_COLOUR,	FONT24,		true},				// band
-  { 0.0, 1,	 CIV_COLOUR,	FONT20,		true},				// ref
-  { 0.0, 0,	 CIV_COLOUR,	FONT24,		true},				// % Tx Power Setting
-  { 0.0, 5,	 CIV_COLOUR,	FONT24,		true},				// freq
-
-  { 0.0, 0,	 CIV_COLOUR,	FONT18,		true},				// tune freq diff
-  { 0.0, 0,	 CIV_COLOUR,	FONT18,		true},				// aBand time
-  { 0.0, 0,	 CIV_COLOUR,	FONT18,		true},				// measure samples size
-  { 0.0, 0,	 CIV_COLOUR,	FONT18,		true},				// measure samples size
-  { 0.0, 0,	 CIV_COLOUR,	FONT18,		true},				// calibrate samples size
+  { 0.0, 0,	 FG_COLOUR,		&FONT40,		true},				// 0 - nettPwr
+  { 0.0, 0,	 FG_COLOUR,		&FONT32,		true},				// 1 - peakPwr
+  { 0.0, 1,	 ORANGE,		&FONT28,		true},				// 2 - swr
+  { 0.0, 0,	 GREEN,			&FONT48,		true},				// 3 - dbm
+
+  { 0.0, 2,	 ORANGE,		&FONT18,		true},				// 4 - fwdPwr
+  { 0.0, 2,	 ORANGE,		&FONT18,		true},				// 5 - refPwr
+  { 0.0, 4,	 ORANGE,		&FONT20,		true},				// 6 - fwdVolts
+  { 0.0, 4,	 ORANGE,		&FONT20,		true},				// 7 - refVolts
+
+  { 0.0, 0,	 ORANGE,		&FONT18,		true},				// 8 - nettPwrMeter
+  { 0.0, 0,	 ORANGE,		&FONT18,		true},				// 9 - swrMeter
+
+  { 0.0, 0,	 BG_COLOUR,		&FONT16,		true},				// options button
+  { 0.0, 0,	 BG_COLOUR,		&FONT16,		true},				// freqtuner button
+  { 0.0, 0,	 BG_COLOUR,		&FONT16,		true},				// autoBand button
+
+  { 0.0, 4,	 ORANGE,		&FONT18,		true},				// 13 - civ
+  { 0.0, 5,	 CIV_COLOUR,	&FONT24,		true},				// tuner
+  { 0.0, 0,	 CIV_COLOUR,	&FONT24,		true},				// band
+  { 0.0, 1,	 CIV_COLOUR,	&FONT20,		true},				// ref
+  { 0.0, 0,	 CIV_COLOUR,	&FONT24,		true},				// % Tx Power Setting
+  { 0.0, 5,	 CIV_COLOUR,	&FONT24,		true},				// freq
+
+  { 0.0, 0,	 CIV_COLOUR,	&FONT18,		true},				// tune freq diff
+  { 0.0, 0,	 CIV_COLOUR,	&FONT18,		true},				// aBand time
+  { 0.0, 0,	 CIV_COLOUR,	&FONT18,		true},				// measure samples size
+  { 0.0, 0,	 CIV_COLOUR,	&FONT18,		true},				// measure samples size
+  { 0.0, 0,	 CIV_COLOUR,	&FONT18,		true},				// calibrate samples size
+
+  { 0.0, 0,	 ORANGE,		&FONT10,		true},				// swr sweep graph
+  { 0.0, 0,	 ORANGE,		&FONT10,		true},				// power / swr history graph
+  { 0.0, 1,	 CIV_COLOUR,	&FONT18,		true},				// cal reference power
+};
+
+// compositor, latest value per frame waiting for displayFlush() ---------------------
+struct pending {
+	float curr;							// latest value
+	float peak;							// meter peak indicator
+	bool isDirty;						// true = changed since last drawn
+	bool isMeter;						// true = displayMeter(), false = displayValue()
+	bool isRestore;						// true = restoreFrame() first, background colour changed
 };
 
+pending dispQue[NUM_FRAMES];
+
+// glyph cache, advance widths of numeric characters per value font --------------
+// widths measured once with strPixelLen(), displayValue() sums them per string
+// large fonts also keep 1 bit per pixel glyph cells, decoded once from the font data.
+// a changed character is one writeRect1BPP(), background included, no erase first
+#define GLYPH_CHARS     "0123456789.-"			// characters in a formatted value
+#define NUM_GLYPHS      12
+#define NUM_GLYPH_FONTS 10						// distinct fonts in val[]
+#define VAL_DIGITS      10						// max value string length
+#define GLYPH_BMP_CAP   16						// min cap height (pixels) for glyph cells, FONT24 up
+#define GLYPH_POOL      4608					// bytes for glyph cells, nettPwr, peakPwr, swr fonts fit
+
+struct glyphCache {
+	const unsigned char* data;			// font data, identifies font. NULL = unused
+	uint8_t adv[NUM_GLYPHS];			// advance width (pixels), order of GLYPH_CHARS
+	uint8_t* bmp;						// glyph cells, NULL = drawn from font data
+	uint16_t cell[NUM_GLYPHS];			// cell offset in bmp. adv wide, h high, rows byte aligned
+	uint8_t h;							// cell height, cap_height + 5 from 2 above text cursor
+};
+
+glyphCache glyphs[NUM_GLYPH_FONTS];
+uint8_t glyphPool[GLYPH_POOL];			// glyph cells, fonts in order of first use
+int glyphPoolUsed;
+
 // meter -----------------------------------------------------------------------
 struct meter {
 	int xGap;							// incremental x co-ord (top left conrner)
 	int yGap;							// incremental y co-ord (top left conrner)
 	int colour;							// scale colour
-	ILI9341_t3_font_t font;				// scale font (size)
+	const ILI9341_t3_font_t* font;		// scale font (size), font in flash
 	float sStart;						// start value for scale
 	float sEnd;							// end value for scale
 	int major;							// number major scale divisions
@@ -245,45 +321,50 @@ struct meter {
 	int bColour;						// meter bar bottom colour
 	int pkWidth;						// peak indicator width
 	int pkColour;						// peak indicator colour
-	int pkPrevPosn;						// peak indicator prev width
 };
 
-meter mtr[] = {
-{ 10, 5,   FG_COLOUR, Arial_8,   0, 100,	4, 20, FG_COLOUR, BG_COLOUR,   5, ORANGE, 0, },
-{ 10, 5,   FG_COLOUR, Arial_8,  1.0, 4.0,	4, 20, FG_COLOUR, BG_COLOUR,   5, ORANGE, 0, },
+const meter mtr[] = {
+{ 10, 5,   FG_COLOUR, &Arial_8,  0, 100,	4, 20, FG_COLOUR, BG_COLOUR,   5, ORANGE, },
+{ 10, 5,   FG_COLOUR, &Arial_8, 1.0, 4.0,	4, 20, FG_COLOUR, BG_COLOUR,   5, ORANGE, },
 };
+int mtrPkPosn[2];						// peak indicator prev x, per meter
 
 /*-------------------------------Frequency / Band data-----------------------------*/
+// frequencies are Hz, uint32_t. float MHz only for display
 #define NUM_BANDS 11
 struct freqband {
 	int posn;							// hf band posn
 	char txt[10];						// band description
 	int mtrs;							// band - metres
-	float prevFreq;						// previous frequency for update
-	float ft8Freq;						// FT8 freq for autoband change
-	float bandStart;					// band start freq
-	float bandEnd;						// band end freq
+	uint32_t prevFreq;					// previous frequency for update
+	uint32_t ft8Freq;					// FT8 freq for autoband change
+	uint32_t bandStart;					// band start freq
+	uint32_t bandEnd;					// band end freq, in band
 	float sRef;							// spectrum reference
 	bool isTtune;						// enable tuner flag for this band
 	bool isABand;						// enable autoband flag
 };
 
 freqband hfBand[] = {
-	//  posn	txt			mtrs  prevFreq   FT8Freq  BandStart   BandEnd		Ref	  tuneFlg  aBandFlg
-		{ 0, "160 Mtrs",	160,	0.0,	 1.840,		1.81,		2.0,		0,		false,	false,	},
-		{ 1, "80 Mtrs",		80 ,	0.0,	 3.573,		3.5,		3.8,		0,		true,	true,	},
-		{ 2, "60 Mtrs",		60 ,	0.0,	 5.357,		5.2585,		5.4065,		0,		false,	false,	},
-		{ 3, "40 Mtrs",		40 ,	0.0,	 7.074,		7.0,		7.2,		0,		true,	true,	},
-		{ 4, "30 Mtrs",		30 ,	0.0,	 10.136,	10.1,		10.15,		0,		true,	true,	},
-		{ 5, "20 Mtrs",		20 ,	0.0,	 14.074,	14.0,		14.35,		0,		true,	true,	},
-		{ 6, "17 Mtrs",		17 ,	0.0,	 18.100,	18.068,		18.168,		0,		true,	true,	},
-		{ 7, "15 Mtrs",		15 ,	0.0,	 21.074,	21.0,		21.45,		0,		true,	true,	},
-		{ 8, "12 Mtrs",		12 ,	0.0,	 24.915,	24.89,		24.99,		0,		true,	true,	},
-		{ 9, "10 Mtrs",		10 ,	0.0,	 28.074,	28.0,		29.7,		0,		true,	true,	},
-		{ 10, "6 Mtrs",		6,		0.0,	 50.313,	50.0,		52.0,		0,		false,	false,	},
-		//  { 11, "4 Mtrs",		4,		0.0,	 70.100,	70.0,		70.5,		0,		false,	false,	),
+	//  posn	txt			mtrs  prevFreq   FT8Freq	BandStart	BandEnd		Ref	  tuneFlg  aBandFlg
+		{ 0, "160 Mtrs",	160,	0,		 1840000,	1810000,	2000000,	0,		false,	false,	},
+		{ 1, "80 Mtrs",		80 ,	0,		 3573000,	3500000,	3800000,	0,		true,	true,	},
+		{ 2, "60 Mtrs",		60 ,	0,		 5357000,	5258500,	5406500,	0,		false,	false,	},
+		{ 3, "40 Mtrs",		40 ,	0,		 7074000,	7000000,	7200000,	0,		true,	true,	},
+		{ 4, "30 Mtrs",		30 ,	0,		 10136000,	10100000,	10150000,	0,		true,	true,	},
+		{ 5, "20 Mtrs",		20 ,	0,		 14074000,	14000000,	14350000,	0,		true,	true,	},
+		{ 6, "17 Mtrs",		17 ,	0,		 18100000,	18068000,	18168000,	0,		true,	true,	},
+		{ 7, "15 Mtrs",		15 ,	0,		 21074000,	21000000,	21450000,	0,		true,	true,	},
+		{ 8, "12 Mtrs",		12 ,	0,		 24915000,	24890000,	24990000,	0,		true,	true,	},
+		{ 9, "10 Mtrs",		10 ,	0,		 28074000,	28000000,	29700000,	0,		true,	true,	},
+		{ 10, "6 Mtrs",		6,		0,		 50313000,	50000000,	52000000,	0,		false,	false,	},
+		//  { 11, "4 Mtrs",		4,		0,		 70100000,	70000000,	70500000,	0,		false,	false,	),
 };
 
+// band index. band edges in freq order, built by initBands(). bandFind() binary search
+uint32_t bandEdge[NUM_BANDS * 2];		// bandStart, bandEnd + 1 of each band, ascending
+int8_t bandOrder[NUM_BANDS];			// hfBand[] posn of each edge pair
+
 /* structure for options boxes */
 struct optBox										// touch check bxes/circles co-ords
 {
@@ -297,6 +378,8 @@ optBox		tb[30];									// tb[] is touch area co-ord
 #define		EEINCR 16								// address increment for band options and parameters
 #define		EEADDR_BAND 100							// start address band info
 #define		EEADDR_PARAM 10							// start address variable parameter
+#define		EEADDR_CAL 400							// start address band calibration curves
+#define		EEADDR_PARAM2 300						// start address parameters added after v004, after band info
 
 /* strucure for Options - hfBands  (12 locations 3x4) */
 struct eeProm0
@@ -319,3 +402,27 @@ param		aBandPar = { 120,	0,	EEADDR_PARAM + 0x10 };				// autoband paramters
 param		samplesDefPar = { 5,	1,	EEADDR_PARAM + 0x20 };			// number samples for averaging - default
 param		samplesAltPar = { 1,	1,	EEADDR_PARAM + 0x30 };			// alternate samples number
 param		samplesCalPar = { 20,	1,	EEADDR_PARAM + 0x40 };			// samples for averaging
+param		calPwrPar = { 100,	0,	EEADDR_PARAM2 };					// cal point reference meter power, 0.1 W units
+
+/*----------EEPROM write-back cache------------------------------------------------*/
+// hfProm[] and params are the RAM copy. putBandEEPROM(), putParEEPROM() only mark records dirty,
+// eeFlush() writes them EE_DELAY after the last change. records have CRC-8 in last byte of EEINCR slot
+// each band / param record has an A slot at eeAddr and a B slot at eeAddr + EE_ALT, sequence byte at
+// EE_SEQ. writes go to the older slot, sequence byte last, so a reset mid write leaves the previous copy
+// band cal records are written when changed, CRC-8 in a table after the records (EEADDR_CALCRC)
+// cal records have one copy, no room for two in 2k. bad CRC gives no points, compiled tables used
+// header: EEPROM(0) EE_MAGIC, EEPROM(1) EE_VERSION. v004 used EEPROM(0) = 1, no CRCs, no cal records
+#define		EE_MAGIC 0xA5							// layout header
+#define		EE_VERSION 3							// change if record layout changes. B slots read as empty by v3
+#define		EE_OLD_FLAG 1							// v004 initialised flag, records read without CRC
+#define		EE_ALT 1600								// B slot offset, B slots after cal CRCs
+#define		EE_SEQ (EEINCR - 2)						// slot sequence byte, newer of A / B is read
+#define		EE_DELAY 2000							// mSecs after last change before write
+#define		EE_BAND 0								// dirty bits, bands 0 - NUM_BANDS-1
+#define		EE_PAR 16								// params 16 - 16+NUM_PARS-1
+#define		NUM_PARS 6
+#define		NUM_PARS_V004 5							// params in v004 EEPROM, eePars[] order
+param*		eePars[NUM_PARS] = { &freqTunePar, &aBandPar, &samplesDefPar, &samplesAltPar, &samplesCalPar, &calPwrPar };
+static_assert(sizeof(param) <= EE_SEQ && sizeof(eeProm0) <= EE_SEQ, "EEPROM record overlaps slot sequence byte");
+uint32_t	eeDirty;								// records waiting for eeFlush()
+unsigned long eeFlushes, eeBytes;					// flushes, EEPROM bytes written
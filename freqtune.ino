@@ -10,9 +10,9 @@ Called by: loop()
 Calls: activateTuner(), civReadFreq()
 Global variables: lab[], FreqTunePrevFreq, freqTune FreqDiff
 */
-void freqDiffTune(float fCurr)
+void freqDiffTune(uint32_t fCurr)
 {
-	float fDiff = 0.0;
+	uint32_t fDiff;
 	int currBand;
 
 	currBand = getBand(fCurr);
@@ -21,12 +21,12 @@ void freqDiffTune(float fCurr)
 		return;
 
 	//change in radio freq greater than set difference?  Activate tuner
-	fDiff = abs(fCurr - val[tuner].prevValue) * 1000;	// kHz
-	displayValue(freqTune, constrain(freqTunePar.val - fDiff, 0, 9999));
-	if (fDiff >= freqTunePar.val)						// freq change > limit
+	fDiff = (fCurr > tunerFreq ? fCurr - tunerFreq : tunerFreq - fCurr) / 1000;	// kHz
+	displayValue(freqTune, constrain(freqTunePar.val - (int)fDiff, 0, 9999));
+	if (fDiff >= (uint32_t)freqTunePar.val)				// freq change > limit
 	{
 		lab[tuner].stat = true;
-		displayValue(freq, fCurr);
+		displayValue(freq, fCurr / 1000000.0);			// MHz
 		displayValue(band, hfBand[currBand].mtrs);
 		displayValue(sRef, hfBand[currBand].sRef);
 		val[band].isUpdate = true;
@@ -53,48 +53,44 @@ void freqTuneButton(int tStat)
 	{
 		strcpy(lab[freqTune].txt, "F/Tune: ");
 		lab[freqTune].colour = MENU_BG;
-		fr[freqTune].bg = MENU_COLOUR;
+		frs.bg[freqTune] = MENU_COLOUR;
 		val[freqTune].isUpdate = true;					// force display
-		val[tuner].prevValue = getFreq();
+		tunerFreq = getFreq();
 	}
 	if (!lab[freqTune].stat)
 	{
 		strcpy(lab[freqTune].txt, "FreqTune OFF");
 		lab[freqTune].colour = MENU_COLOUR;
-		fr[freqTune].bg = MENU_BG;
+		frs.bg[freqTune] = MENU_BG;
 	}
 	displayLabel(freqTune);
 }
 
 /* ------------------------------- tunerActivate() ------------------------------------------------------
-triggers the auto tuner function of the radio
+triggers the auto tuner function of the radio. doesn't wait, tunerStatus() follows tuning
 Called by: freqTune(), touch()
-Calls: displayLabel(), civWrite(), civRead(), civReadFreq(), civReadTuner(), measure()
+Calls: displayLabel(), civWrite(), getFreq()
 Global: fr[], lab[], val[], setTuner2, FreqTunePrevFreq
 */
 void tunerActivate()
 {
 	// return if disabled
-	if (!fr[tuner].isEnable)
+	if (!frs.isEnable[tuner])
 		return;
 
 	// change label text, colour while active
-	lab[tuner].font = FONT28;
+	lab[tuner].font = &FONT28;
 	lab[tuner].colour = FG_COLOUR;
-	fr[tuner].bg = RED;
+	frs.bg[tuner] = RED;
 	strcpy(lab[tuner].txt, "Tune");
 	displayLabel(tuner);
 
-	// initiate tuner and loop while tuning
-	civWrite(civWriteTuner);
-	while (getTunerStat() == 2)						// 2 = radio tuning
-		measure();
+	// initiate tuner. tunerStatus() waits for status read back
+	civWriteBack(civWriteTuner, CIV_TUNER);			// read back tuner status
+	lab[tuner].stat = 2;							// 2 = radio tuning
 
-	val[tuner].prevValue = getFreq();				// save tuner frequency
-	lab[tuner].stat = -1;							// ensure tunerStatus() runs
-	tunerStatus();
-
-	if (lab[aBand].stat) 							// if autoband enabled, restart timer after tuning
+	tunerFreq = getFreq();							// save tuner frequency, no retrigger
+	if (lab[aBand].stat) 							// if autoband enabled, restart timer
 		aBandTimer.reset();							// reset time
 }
 
@@ -108,21 +104,31 @@ int tunerStatus()								// display Tuner button status.
 {
 	int s;
 
-	if (!fr[tuner].isEnable)
+	if (!frs.isEnable[tuner])
 		return -1;		// check enabled?
 
 	// get tuner status
+	if (civSettling(CIV_TUNER))			// waiting for read back after tunerActivate()
+		return lab[tuner].stat;
 	s = getTunerStat();
 	if (s == lab[tuner].stat)				// lab[tune].stat = 1    always forces status check
 		return s;							// no change in status
 
+	// tuning finished
+	if (lab[tuner].stat == 2)
+	{
+		tunerFreq = getFreq();				// done, save tuner frequency
+		if (lab[aBand].stat) 				// if autoband enabled, restart timer after tuning
+			aBandTimer.reset();
+	}
+
 	switch (s)
 	{
 		//tuner off at radio (radio startup or switched off at radio)
 	case 0:
-		lab[tuner].font = FONT18;						// set font and colour
+		lab[tuner].font = &FONT18;						// set font and colour
 		lab[tuner].colour = FG_COLOUR;
-		fr[tuner].bg = BG_COLOUR;
+		frs.bg[tuner] = BG_COLOUR;
 		strcpy(lab[tuner].txt, "Tune Off");
 		lab[freqTune].stat = false;
 		// update freq tuner button
@@ -131,22 +137,18 @@ int tunerStatus()								// display Tuner button status.
 
 		// tuner on, can activated by radio or software
 	case 1:
-		lab[tuner].font = FONT28;
+		lab[tuner].font = &FONT28;
 		lab[tuner].colour = FG_COLOUR;
-		fr[tuner].bg = BG_COLOUR;
+		frs.bg[tuner] = BG_COLOUR;
 		strcpy(lab[tuner].txt, "Tune");
 		break;
 
 		// tuning in operation
 	case 2:
-		lab[tuner].font = FONT24;
+		lab[tuner].font = &FONT24;
 		lab[tuner].colour = FG_COLOUR;
-		fr[tuner].bg = RED;
-		strcpy(lab[tuner].txt, "Tuning");
-		// loop and measure until done
-		while (getTunerStat() == 2) measure();
-
-		val[tuner].prevValue = getFreq();		// done, save tuner frequency
+		frs.bg[tuner] = RED;
+		strcpy(lab[tuner].txt, "Tuning");		// scheduler keeps measuring, tuning done on next status change
 		break;
 
 		// should never get here
@@ -162,19 +164,16 @@ int tunerStatus()								// display Tuner button status.
 }
 
 /*----------------------------- getTunerStat() -------------------------------------------------
-issues CIV command to read Radio Tuner status
-Returns: 0 = off, 1 = on, 2 = tuning
+Radio Tuner status. last status received
+Returns: 0 = off, 1 = on, 2 = tuning, -1 no reply
 */
 int getTunerStat()
 {
-	int n;
-	char inBuff[12];						// civ frequency inBuff buffer
+	civSlot* sPtr = civGet(CIV_TUNER);		// last tuner status from radio
+	int n = sPtr->n;
 
-	civWrite(civReadTuner);				// request read frequency from radio
-	n = civRead(inBuff);
-	if (inBuff[3] == CIVRADIO && inBuff[n - 1] == 0xFD)	// check format of serial stream
-		return inBuff[n-2];				// return tuner status
+	if (n)									// last reply valid
+		return sPtr->buff[n - 2];			// return tuner status
 	else
 		return -1;
 }
-
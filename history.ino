@@ -0,0 +1,266 @@
+/*---------------------------------------------------------
+  POWERMETER III + ICOM 7300 CONTROLLER
+   Copyright 2018-2020  Roger Mawhinney, GI8GZM.
+  No publication with acknowledgement to author
+*/
+
+/*
+power / SWR history and trend graph
+measure() adds each result to the second being built. each second the point goes into the
+seconds ring and is folded into the minute being built. O(1) per result, nothing is rescanned.
+trendGraph: long touch on power meter. one column per HIST_PPC points, min to max line and
+mean dot, drawn left to right then wrapping, cursor line after newest column.
+only columns completed since last draw are drawn. touch swaps 10 min / 12 hour, long touch exits.
+*/
+
+/*------------------------------ histAdd() -------------------------------------------------
+adds measure() result. nett power (mW), swr x 100
+Called by: measure()
+*/
+void histAdd(uint32_t mW, int swr100)
+{
+	histRing* sPtr = &hist[HIST_SEC];
+	bool isCarrier = mW > PWR_THRESHOLD * 1000;
+	uint8_t pc = histPwr(mW);
+	uint8_t sc = isCarrier ? histSwr(swr100) : 0;
+	uint32_t sN, sSum, mean;
+	histPt* pPtr;
+
+	// second complete, result is first of next second
+	// after a stall (option screens) one empty second per call catches up
+	if ((long)(millis() - histTime) >= 0)
+	{
+		histTime += 1000;
+		sN = sPtr->acc.sN;
+		sSum = sPtr->acc.sSum;
+		mean = histPush(HIST_SEC);
+		pPtr = &sPtr->pt[(sPtr->n - 1) % sPtr->size];
+		histAccAdd(hist[HIST_MIN].acc, mean, pPtr->pMin, pPtr->pMax, sN, sSum, pPtr->sMin, pPtr->sMax);
+		if (sPtr->n % 60 == 0)
+			histPush(HIST_MIN);
+	}
+	histAccAdd(sPtr->acc, mW, pc, pc, isCarrier, sc, sc, sc);
+}
+
+/*------------------------------ histAccAdd() -------------------------------------------------
+adds to point being built. one measure() result, or one second into a minute
+mW: linear power for mean. sN, sSum: carrier samples and their swr code total
+*/
+void histAccAdd(histAcc& a, uint32_t mW, uint8_t pLo, uint8_t pHi, uint32_t sN, uint32_t sSum, uint8_t sLo, uint8_t sHi)
+{
+	if (!a.n || pLo < a.pMin)
+		a.pMin = pLo;
+	if (!a.n || pHi > a.pMax)
+		a.pMax = pHi;
+	a.n++;
+	a.pSum += mW;
+
+	if (!sN)
+		return;										// no carrier, no swr
+	if (!a.sN || sLo < a.sMin)
+		a.sMin = sLo;
+	if (!a.sN || sHi > a.sMax)
+		a.sMax = sHi;
+	a.sN += sN;
+	a.sSum += sSum;
+}
+
+/*------------------------------ histPush() -------------------------------------------------
+point being built into ring r, oldest point overwritten. starts next point
+Returns: mean power (mW) of point
+*/
+uint32_t histPush(int r)
+{
+	histRing* hPtr = &hist[r];
+	histAcc* aPtr = &hPtr->acc;
+	histPt* pPtr = &hPtr->pt[hPtr->n % hPtr->size];
+	uint32_t mean = aPtr->n ? aPtr->pSum / aPtr->n : 0;
+
+	pPtr->pMin = aPtr->pMin;
+	pPtr->pMean = histPwr(mean);
+	pPtr->pMax = aPtr->pMax;
+	pPtr->sMin = aPtr->sMin;
+	pPtr->sMean = aPtr->sN ? (aPtr->sSum + aPtr->sN / 2) / aPtr->sN : 0;
+	pPtr->sMax = aPtr->sMax;
+	hPtr->n++;
+	memset(aPtr, 0, sizeof(histAcc));
+	return mean;
+}
+
+/*------------------------------ histPwr(), histSwr() -------------------------------------------------
+power code, 0.25 dB steps from 0 dBm, 0 = 1 mW or less
+swr code, 1 + (SWR - 1) x 50, SWR 6.08 and over = 255
+*/
+uint8_t histPwr(uint32_t mW)
+{
+	if (mW <= 1)
+		return 0;
+	return constrain((dbmCalc(mW) * 2 + 2) / 5, 1, 255);	// dBm x 10 to dBm x 4
+}
+
+uint8_t histSwr(int swr100)
+{
+	return constrain(1 + (swr100 - 100) / 2, 1, 255);
+}
+
+/*------------------------------ histStart() -------------------------------------------------
+replaces meters and civ frames with trendGraph, seconds ring
+*/
+void histStart()
+{
+	for (int i = tuner; i <= freq; i++)					// graph area
+		eraseFrame(i);
+	eraseFrame(nettPwrMeter);
+	eraseFrame(swrMeter);
+	histShow(HIST_SEC);
+}
+
+/*------------------------------ histShow() -------------------------------------------------
+trendGraph for ring r, axes now. columns drawn by histDraw()
+*/
+void histShow(int r)
+{
+	histRing* hPtr = &hist[r];
+	uint32_t last = hPtr->n / HIST_PPC;					// columns complete
+
+	histView = r;
+	strcpy(lab[trendGraph].txt, r == HIST_SEC ? "Trend  10 mins" : "Trend  12 hrs");
+	restoreFrame(trendGraph);
+	histAxes();
+	histCol = last > (uint32_t)histCols() ? last - histCols() : 0;	// oldest column still in ring
+}
+
+/*------------------------------ histDraw() -------------------------------------------------
+draws columns completed since last call, HIST_DRAW_COLS max so opening graph is spread out
+Called by: trend task
+*/
+void histDraw()
+{
+	uint32_t last;
+
+	if (histView == HIST_OFF)
+		return;
+	last = hist[histView].n / HIST_PPC;
+	for (int i = 0; i < HIST_DRAW_COLS && histCol < last; i++)
+		histColumn(histCol++);
+}
+
+/*------------------------------ histColumn() -------------------------------------------------
+column k, HIST_PPC ring points merged. erases column, grid, min to max line, mean dot
+cursor line in next column, overwritten when next column is drawn
+*/
+void histColumn(uint32_t k)
+{
+	histRing* hPtr = &hist[histView];
+	const frame* fPtr = &fr[trendGraph];
+	const uint8_t pGrid[] = { 120, 160, 200 };			// 1W, 10W, 100W
+	const uint8_t sGrid[] = { 26, 51 };					// SWR 1.5, 2
+	int cols = histCols();
+	int x = fPtr->x + 30 + k % cols;
+	int xNext = fPtr->x + 30 + (k + 1) % cols;
+	int top = histPwrY(HIST_PWR_HI), bottom = histSwrY(1);
+	uint8_t pMin = 255, pMax = 0, sMin = 255, sMax = 0;
+	int pSum = 0, sSum = 0, sN = 0;
+
+	for (int i = 0; i < HIST_PPC; i++)
+	{
+		histPt* pPtr = &hPtr->pt[(k * HIST_PPC + i) % hPtr->size];
+
+		if (pPtr->pMin < pMin)
+			pMin = pPtr->pMin;
+		if (pPtr->pMax > pMax)
+			pMax = pPtr->pMax;
+		pSum += pPtr->pMean;
+		if (!pPtr->sMax)
+			continue;									// no carrier
+		if (pPtr->sMin < sMin)
+			sMin = pPtr->sMin;
+		if (pPtr->sMax > sMax)
+			sMax = pPtr->sMax;
+		sSum += pPtr->sMean;
+		sN++;
+	}
+
+	tft.drawFastVLine(x, top, bottom - top + 1, BG_COLOUR);
+	for (int i = 0; i < 3; i++)
+		tft.drawPixel(x, histPwrY(pGrid[i]), LINE_COLOUR);
+	for (int i = 0; i < 2; i++)
+		tft.drawPixel(x, histSwrY(sGrid[i]), LINE_COLOUR);
+
+	if (pMax)
+	{
+		tft.drawFastVLine(x, histPwrY(pMax), histPwrY(pMin) - histPwrY(pMax) + 1, DARKGREEN);
+		tft.drawPixel(x, histPwrY(pSum / HIST_PPC), GREEN);
+	}
+	if (sN)
+	{
+		int s = sSum / sN;
+		int colour = GREEN;
+
+		if (s > 26)
+			colour = YELLOW;
+		if (s > 51)
+			colour = ORANGE;
+		if (s > 101)
+			colour = RED;
+		tft.drawFastVLine(x, histSwrY(sMax), histSwrY(sMin) - histSwrY(sMax) + 1, DARKCYAN);
+		tft.drawPixel(x, histSwrY(s), colour);
+	}
+	tft.drawFastVLine(xNext, top, bottom - top + 1, DARKGREY);
+}
+
+/*------------------------------ histAxes() -------------------------------------------------
+power grid 1W, 10W, 100W, 1kW top. SWR grid 1.5, 2, 3 top
+*/
+void histAxes()
+{
+	const frame* fPtr = &fr[trendGraph];
+	const char* pTxt[] = { "1W", "10W", "100W", "1kW" };
+	const uint8_t pGrid[] = { 120, 160, 200, 240 };
+	const float sGrid[] = { 1.5, 2, 3 };
+	int x = fPtr->x + 30, w = histCols();
+
+	tft.setFont(Arial_8);
+	tft.setTextColor(FG_COLOUR);
+	for (int i = 0; i < 4; i++)
+	{
+		int y = histPwrY(pGrid[i]);
+		tft.drawFastHLine(x, y, w, LINE_COLOUR);
+		tft.setCursor(fPtr->x + GAP, y - 3);
+		tft.print(pTxt[i]);
+	}
+	for (int i = 0; i < 3; i++)
+	{
+		int y = histSwrY(histSwr(sGrid[i] * 100));
+		tft.drawFastHLine(x, y, w, LINE_COLOUR);
+		tft.setCursor(fPtr->x + GAP, y - 3);
+		tft.print(sGrid[i], 1);
+	}
+}
+
+/*------------------------------ histCols(), histPwrY(), histSwrY() -------------------------------------------------
+columns for histView ring, one less than ring holds so a column is never part overwritten
+graph y for power code (upper half) and swr code (lower half). out of range at top / bottom
+*/
+int histCols()
+{
+	return hist[histView].size / HIST_PPC - 1;
+}
+
+int histPwrY(int c)
+{
+	const frame* fPtr = &fr[trendGraph];
+	int top = fPtr->y + 20, bottom = fPtr->y + 58;
+
+	c = constrain(c, HIST_PWR_LO, HIST_PWR_HI);
+	return bottom - (c - HIST_PWR_LO) * (bottom - top) / (HIST_PWR_HI - HIST_PWR_LO);
+}
+
+int histSwrY(int c)
+{
+	const frame* fPtr = &fr[trendGraph];
+	int top = fPtr->y + 66, bottom = fPtr->y + fPtr->h - 6;
+
+	c = constrain(c, 1, HIST_SWR_HI);
+	return bottom - (c - 1) * (bottom - top) / (HIST_SWR_HI - 1);
+}
@@ -0,0 +1,310 @@
+/*---------------------------------------------------------
+  POWERMETER III + ICOM 7300 CONTROLLER
+   Copyright 2018-2020  Roger Mawhinney, GI8GZM.
+  No publication with acknowledgement to author
+*/
+
+// measChan.h
+// measurement channels, one per directional coupler
+
+/*---------- measurement channels ------------------
+One getADC() pass reads every channel, a synced fwd / ref pair per channel, same sample position.
+Each channel keeps its own cyclic buffers, window totals, block peaks and power / swr results.
+CH_MAIN is the coupler shown on the meters and follows band calibration, others use the
+compiled tables. BLOCK_MODE DMA reads one fixed pin pair, so CH_MAIN only.
+Template on buffer size so channel RAM is fixed at compile time, ~13k per channel at MAXBUF.
+*/
+#ifndef NUM_CHANS
+#define NUM_CHANS       1							// couplers sampled
+#endif
+#define CH_MAIN         0							// meter display channel
+
+#if BLOCK_MODE && NUM_CHANS > 1
+#error "BLOCK_MODE samples CH_MAIN only, set NUM_CHANS 1"
+#endif
+
+// ADC1 fwd, ADC0 ref pins per channel. ADC1 can only read A2, A3, A12, A13 on Teensy 3.2
+const uint8_t chanPin[][2] = {
+	{ A2, A1 },										// main coupler, pins 16, 15
+	{ A3, A0 },										// second coupler, pins 17, 14
+};
+
+/*---------- block statistics ------------------
+sum, sum of squares, min and max of fwd and ref samples in one pass, for true RMS and crest factor.
+Cortex-M4 DSP: two 16 bit samples per word, SMLALD / SMLAD multiply accumulate both halves,
+USUB16 + SEL min / max per half. Other targets: plain loop.
+SMLALD / SMLAD halves are signed, samples must be 15 bits or less (RESOLUTION, adc.ino)
+*/
+struct blockStat {
+	uint32_t n;										// sample pairs
+	uint32_t sum1, sum0;							// fwd, ref
+	uint64_t sq1, sq0;								// sum of squares
+	uint16_t min1, max1, min0, max0;
+};
+
+#if defined(__ARM_FEATURE_DSP)
+// acc + x.lo * y.lo + x.hi * y.hi, 64 bit
+inline uint64_t dspSmlald(uint32_t x, uint32_t y, uint64_t acc)
+{
+	uint32_t lo = acc, hi = acc >> 32;
+
+	asm("smlald %0, %1, %2, %3" : "+r"(lo), "+r"(hi) : "r"(x), "r"(y));
+	return (uint64_t)hi << 32 | lo;
+}
+
+// acc + x.lo * y.lo + x.hi * y.hi, 32 bit
+inline uint32_t dspSmlad(uint32_t x, uint32_t y, uint32_t acc)
+{
+	uint32_t r;
+
+	asm("smlad %0, %1, %2, %3" : "=r"(r) : "r"(x), "r"(y), "r"(acc));
+	return r;
+}
+
+// min, max of each 16 bit half
+inline void dspMinMax(uint32_t x, uint32_t& mn, uint32_t& mx)
+{
+	uint32_t t;
+
+	asm("usub16 %[t], %[x], %[mn]\n\t"				// GE per half, x >= mn
+		"sel %[mn], %[mn], %[x]\n\t"
+		"usub16 %[t], %[x], %[mx]\n\t"				// GE per half, x >= mx
+		"sel %[mx], %[x], %[mx]"
+		: [mn] "+r"(mn), [mx] "+r"(mx), [t] "=&r"(t) : [x] "r"(x) : "cc");
+}
+#endif
+
+// adds n sample pairs b1[] fwd, b0[] ref to s, plain loop. any target, and the DSP kernel's odd last sample
+// min / max in locals, a store to s would alias the uint16_t samples and be redone every pair
+inline void blockStatsPlain(const uint16_t* b1, const uint16_t* b0, int n, blockStat& s)
+{
+	uint32_t sum1 = s.sum1, sum0 = s.sum0;
+	uint64_t sq1 = s.sq1, sq0 = s.sq0;
+	uint16_t mn1 = s.min1, mx1 = s.max1, mn0 = s.min0, mx0 = s.max0;
+
+	if (!s.n)
+	{
+		mn1 = mn0 = 0xFFFF;
+		mx1 = mx0 = 0;
+	}
+	s.n += n;
+
+	for (int i = 0; i < n; i++)
+	{
+		uint32_t v1 = b1[i], v0 = b0[i];
+
+		sum1 += v1;
+		sum0 += v0;
+		sq1 += v1 * v1;
+		sq0 += v0 * v0;
+		if (v1 < mn1)
+			mn1 = v1;
+		if (v1 > mx1)
+			mx1 = v1;
+		if (v0 < mn0)
+			mn0 = v0;
+		if (v0 > mx0)
+			mx0 = v0;
+	}
+	s.sum1 = sum1;
+	s.sum0 = sum0;
+	s.sq1 = sq1;
+	s.sq0 = sq0;
+	s.min1 = mn1;
+	s.max1 = mx1;
+	s.min0 = mn0;
+	s.max0 = mx0;
+}
+
+// adds n sample pairs b1[] fwd, b0[] ref to s. s cleared by caller, segments can be added
+inline void blockStats(const uint16_t* b1, const uint16_t* b0, int n, blockStat& s)
+{
+#if defined(__ARM_FEATURE_DSP)
+	uint32_t sum1 = s.sum1, sum0 = s.sum0;
+	uint64_t sq1 = s.sq1, sq0 = s.sq0;
+	int i = 0;
+
+	if (!s.n)
+	{
+		s.min1 = s.min0 = 0xFFFF;
+		s.max1 = s.max0 = 0;
+	}
+
+	uint32_t mn1 = s.min1 * 0x10001UL, mx1 = s.max1 * 0x10001UL;	// both halves
+	uint32_t mn0 = s.min0 * 0x10001UL, mx0 = s.max0 * 0x10001UL;
+
+	if (n && ((uintptr_t)b1 & 2))					// word align, same offset both buffers
+	{
+		uint32_t w1 = b1[0] * 0x10001UL, w0 = b0[0] * 0x10001UL;
+
+		dspMinMax(w1, mn1, mx1);
+		dspMinMax(w0, mn0, mx0);
+		sum1 += b1[0];
+		sum0 += b0[0];
+		sq1 += b1[0] * b1[0];
+		sq0 += b0[0] * b0[0];
+		i = 1;
+	}
+	for (; i + 1 < n; i += 2)
+	{
+		uint32_t w1, w0;
+
+		memcpy(&w1, &b1[i], 4);						// one word load, no uint32_t alias of the samples
+		memcpy(&w0, &b0[i], 4);
+
+		sum1 = dspSmlad(w1, 0x10001UL, sum1);
+		sum0 = dspSmlad(w0, 0x10001UL, sum0);
+		sq1 = dspSmlald(w1, w1, sq1);
+		sq0 = dspSmlald(w0, w0, sq0);
+		dspMinMax(w1, mn1, mx1);
+		dspMinMax(w0, mn0, mx0);
+	}
+	s.n += i;
+	s.sum1 = sum1;
+	s.sum0 = sum0;
+	s.sq1 = sq1;
+	s.sq0 = sq0;
+	s.min1 = (mn1 & 0xFFFF) < (mn1 >> 16) ? mn1 & 0xFFFF : mn1 >> 16;
+	s.max1 = (mx1 & 0xFFFF) > (mx1 >> 16) ? mx1 & 0xFFFF : mx1 >> 16;
+	s.min0 = (mn0 & 0xFFFF) < (mn0 >> 16) ? mn0 & 0xFFFF : mn0 >> 16;
+	s.max0 = (mx0 & 0xFFFF) > (mx0 >> 16) ? mx0 & 0xFFFF : mx0 >> 16;
+	blockStatsPlain(b1 + i, b0 + i, n - i, s);		// odd last sample
+#else
+	blockStatsPlain(b1, b0, n, s);
+#endif
+}
+
+template <int SIZE>
+struct measChannel
+{
+	uint8_t fwdPin, refPin;							// ADC1, ADC0
+	const uint32_t* fwdTbl;							// ADC code to mW tables, pwrTables.h or band cal
+	const uint32_t* refTbl;
+	int fwdShift, refShift;							// ADC codes per table entry (log2)
+
+	// written by getADC() interrupt
+	volatile uint16_t buf1[SIZE], buf0[SIZE];		// cyclic buffers fwd, ref. 12 bit samples
+	volatile uint32_t winTot1[NUM_WIN], winTot0[NUM_WIN];	// window totals fwd, ref
+	volatile int winSize[NUM_WIN];					// window samples, 0 = not used
+	volatile uint16_t blkMax1[SIZE / WIN_BLK], blkMax0[SIZE / WIN_BLK];	// max fwd per block, ref at that sample
+
+	// results, chanCalc()
+	uint32_t avg1, avg0;							// window average codes, ADC_FRAC_BITS fraction
+	uint32_t pk1, pk0;								// peak fwd code in window, ref code at that sample
+	uint32_t fmW, rmW, fPkmW, rPkmW;				// powers (milliWatts)
+	int swr;										// swr x 100, 100 if power off
+	uint32_t rms1;									// fwd true RMS code, ADC_FRAC_BITS fraction
+	uint32_t rmsmW;									// fwd power at RMS code (milliWatts)
+	int crest;										// fwd crest factor (peak / RMS) x 100, 0 if no signal
+
+	// one sample pair at pos. all window totals and block peak, interrupt only
+	void add(int pos, unsigned int ar1, unsigned int ar0)
+	{
+		int b = pos / WIN_BLK;
+
+		buf1[pos] = ar1;							// record new sample
+		buf0[pos] = ar0;
+
+		// window totals. add newest, remove oldest, window samples behind
+		for (int k = 0; k < NUM_WIN; k++)
+		{
+			int old = pos - winSize[k];
+			if (!winSize[k])
+				continue;
+			if (old < 0)
+				old += SIZE;
+			winTot1[k] += ar1 - buf1[old];			// unsigned, wraps back to total
+			winTot0[k] += ar0 - buf0[old];
+		}
+
+		// block peak. first sample of block starts new max
+		if (pos % WIN_BLK == 0 || ar1 >= blkMax1[b])
+		{
+			blkMax1[b] = ar1;
+			blkMax0[b] = ar0;						// ref corresponding to peak fwd
+		}
+	}
+
+	// window k to n samples before head, summed from buffer history. interrupts off
+	void setWindow(int k, int n, int head)
+	{
+		uint32_t tot1 = 0, tot0 = 0;
+
+		for (int i = 0; i < n; i++)
+		{
+			if (--head < 0)
+				head = SIZE - 1;
+			tot1 += buf1[head];
+			tot0 += buf0[head];
+		}
+		winTot1[k] = tot1;
+		winTot0[k] = tot0;
+		winSize[k] = n;
+	}
+
+	// block statistics of n samples before head, two segments if buffer wraps
+	// n <= WIN_MAX, getADC() can't overwrite samples being read
+	void stats(int head, int n, blockStat& s) const
+	{
+		int p = head - n;							// oldest sample
+
+		memset(&s, 0, sizeof(s));
+		if (p < 0)
+		{
+			p += SIZE;
+			blockStats((const uint16_t*)&buf1[p], (const uint16_t*)&buf0[p], SIZE - p, s);
+			n -= SIZE - p;
+			p = 0;
+		}
+		blockStats((const uint16_t*)&buf1[p], (const uint16_t*)&buf0[p], n, s);
+	}
+
+	// window with n samples, WIN_DEF if none
+	int win(int n) const
+	{
+		for (int k = 0; k < NUM_WIN; k++)
+			if (winSize[k] == n)
+				return k;
+		return WIN_DEF;
+	}
+
+	// peak fwd sample in n samples before head, and ref sample at same time
+	// whole blocks use block max, partial blocks at ends are scanned
+	void peak(int head, int n, uint32_t& m1, uint32_t& m0) const
+	{
+		int p = head - n;							// oldest sample in window
+
+		m1 = m0 = 0;
+		if (p < 0)
+			p += SIZE;
+		while (n > 0)
+		{
+			if (p % WIN_BLK == 0 && n >= WIN_BLK)	// whole block in window
+			{
+				int b = p / WIN_BLK;
+				if (blkMax1[b] >= m1)
+				{
+					m1 = blkMax1[b];
+					m0 = blkMax0[b];
+				}
+				p += WIN_BLK;
+				n -= WIN_BLK;
+			}
+			else
+			{
+				if (buf1[p] >= m1)
+				{
+					m1 = buf1[p];
+					m0 = buf0[p];
+				}
+				p++;
+				n--;
+			}
+			if (p >= SIZE)
+				p = 0;
+		}
+	}
+};
+
+typedef measChannel<MAXBUF> adcChan;
+adcChan chan[NUM_CHANS];							// measurement channels, initChans()
@@ -0,0 +1,85 @@
+/*---------------------------------------------------------
+  POWERMETER III + ICOM 7300 CONTROLLER
+   Copyright 2018-2020  Roger Mawhinney, GI8GZM.
+  No publication with acknowledgement to author
+*/
+
+// profile.h
+// hot path profiling zones, cycle counts per zone
+
+/*---------- profiling zones ------------------
+PROFILE_ZONE(z) at the top of a function times it until return, including interrupts taken.
+Cortex-M4 DWT cycle counter, micros() x cycles per uSec if no cycle counter.
+Each zone keeps count, min, max, total and a log2 histogram (bucket n = 2^(n-1) to 2^n - 1 cycles).
+profDump() prints all zones over USB Serial, 'p' command. PROFILING false removes all zone code.
+*/
+#define PROFILING       true						// true = profile zones compiled in
+#define PROF_BUCKETS    24							// log2 buckets, last is 2^22 cycles and over
+
+// zones
+#define PZ_ADC          0							// getADC(), getADCBlock() - interrupt
+#define PZ_MEASURE      1							// measure()
+#define PZ_PWRCALC      2							// pwrCalc(), pwrLookup()
+#define PZ_DISPVALUE    3							// displayValue()
+#define PZ_DISPMETER    4							// displayMeter()
+#define PZ_DISPFLUSH    5							// displayFlush()
+#define PZ_CIVSERVICE   6							// civService()
+#define PZ_CIVRX        7							// civRxFrame(), CI-V frame received
+#define PZ_CIVTX        8							// civQueue(), CI-V command queued
+#define PZ_TOUCH        9							// touchChk()
+#define PZ_BLKSTATS     10							// chanStats(), blockStats() kernel
+#define NUM_ZONES       11
+
+#if PROFILING
+const char* profName[NUM_ZONES] = { "getADC", "measure", "pwrCalc", "displayValue", "displayMeter",
+	"displayFlush", "civService", "civRead", "civWrite", "touchChk", "blockStats" };
+
+struct profStat
+{
+	uint32_t count;
+	uint32_t min;									// cycles
+	uint32_t max;
+	uint64_t total;
+	uint32_t hist[PROF_BUCKETS];
+};
+
+volatile profStat profStats[NUM_ZONES];
+
+// cycle counter
+#if defined(ARM_DWT_CYCCNT)
+#define PROF_CYCLES()   ARM_DWT_CYCCNT
+#else
+#define PROF_CYCLES()   (uint32_t)(micros() * (F_CPU / 1000000))
+#endif
+
+// add one timing to zone. getADC zone is only updated in its interrupt, others only from loop()
+inline void profAdd(int z, uint32_t cycles)
+{
+	volatile profStat* pPtr = &profStats[z];
+	int b = cycles ? 32 - __builtin_clz(cycles) : 0;	// log2 bucket
+
+	if (b >= PROF_BUCKETS)
+		b = PROF_BUCKETS - 1;
+	if (pPtr->count == 0 || cycles < pPtr->min)
+		pPtr->min = cycles;
+	if (cycles > pPtr->max)
+		pPtr->max = cycles;
+	pPtr->total += cycles;
+	pPtr->hist[b]++;
+	pPtr->count++;
+}
+
+// times scope, start at construct, add at destruct (any return)
+struct profScope
+{
+	int zone;
+	uint32_t start;
+
+	profScope(int z) : zone(z), start(PROF_CYCLES()) {}
+	~profScope() { profAdd(zone, PROF_CYCLES() - start); }
+};
+
+#define PROFILE_ZONE(z) profScope profZone_(z)
+#else
+#define PROFILE_ZONE(z)									// removed
+#endif
@@ -0,0 +1,161 @@
+/*---------------------------------------------------------
+  POWERMETER III + ICOM 7300 CONTROLLER
+   Copyright 2018-2020  Roger Mawhinney, GI8GZM.
+  No publication with acknowledgement to author
+*/
+
+/*
+profiling zones report, see profile.h
+profInit(), profDump(), profReset(), profBlock(), usbCommand()
+*/
+
+/*------------------------------ profInit() -------------------------------------------------
+starts DWT cycle counter
+Called by: setup()
+*/
+void profInit()
+{
+#if PROFILING && defined(ARM_DWT_CYCCNT)
+	ARM_DEMCR |= ARM_DEMCR_TRCENA;						// enable trace, DWT
+	ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;				// start cycle counter
+#endif
+	profReset();
+}
+
+/*------------------------------ profDump() -------------------------------------------------
+prints zone stats over USB Serial, one comma separated line per zone
+PROF,CPU,<cycles per sec>
+PROF,<zone>,<count>,<min>,<max>,<mean>,<hist 0>..<hist PROF_BUCKETS-1>		(cycles)
+PROF,END
+*/
+void profDump()
+{
+#if PROFILING
+	profStat ps;
+
+	Serial.printf("PROF,CPU,%lu\n", (unsigned long)F_CPU);
+	for (int z = 0; z < NUM_ZONES; z++)
+	{
+		noInterrupts();									// getADC zone updated by interrupt
+		memcpy(&ps, (const void*)&profStats[z], sizeof(ps));
+		interrupts();
+
+		Serial.printf("PROF,%s,%lu,%lu,%lu,%lu", profName[z], (unsigned long)ps.count,
+			(unsigned long)ps.min, (unsigned long)ps.max,
+			ps.count ? (unsigned long)(ps.total / ps.count) : 0UL);
+		for (int b = 0; b < PROF_BUCKETS; b++)
+			Serial.printf(",%lu", (unsigned long)ps.hist[b]);
+		Serial.println();
+	}
+	Serial.println("PROF,END");
+#else
+	Serial.println("PROF,OFF");
+#endif
+}
+
+/*------------------------------ profReset() -------------------------------------------------
+clears all zone stats
+*/
+void profReset()
+{
+#if PROFILING
+	noInterrupts();
+	memset((void*)profStats, 0, sizeof(profStats));
+	interrupts();
+#endif
+}
+
+/*------------------------------ profBlock() -------------------------------------------------
+blockStats() cycles per sample pair over WIN_MAX pairs of CH_MAIN buffers, DSP kernel and plain loop
+PROF,BLK,<pairs>,<blockStats cycles x 100 per pair>,<blockStatsPlain cycles x 100 per pair>
+interrupts off while timed, under 0.5 mSecs. same kernel both if no DSP instructions
+*/
+void profBlock()
+{
+#if PROFILING
+	const uint16_t* b1 = (const uint16_t*)chan[CH_MAIN].buf1;
+	const uint16_t* b0 = (const uint16_t*)chan[CH_MAIN].buf0;
+	uint32_t cycles[2];
+	blockStat s;
+
+	for (int k = 0; k < 2; k++)
+	{
+		memset(&s, 0, sizeof(s));
+		noInterrupts();
+		uint32_t start = PROF_CYCLES();
+		if (k)
+			blockStatsPlain(b1, b0, WIN_MAX, s);
+		else
+			blockStats(b1, b0, WIN_MAX, s);
+		cycles[k] = PROF_CYCLES() - start;
+		interrupts();
+	}
+	Serial.printf("PROF,BLK,%d,%lu,%lu\n", WIN_MAX, (unsigned long)(cycles[0] * 100ULL / WIN_MAX),
+		(unsigned long)(cycles[1] * 100ULL / WIN_MAX));
+#else
+	Serial.println("PROF,OFF");
+#endif
+}
+
+/*------------------------------ usbCommand() -------------------------------------------------
+single character commands from USB Serial
+p - profile dump, z - zero profile stats, k - blockStats() cycles per sample
+s - start raw sample stream, x - stop stream or trace
+r - start session trace
+e - EEPROM write counts
+c - measurement channel results, fwd mW, ref mW, swr x 100 per channel
+a - adaptive rates, carrier, switches, key down to first reading last / worst (uSecs)
+b - CI-V refresh rates, bus use, command latency since last b
+t - task runs, worst run time, overruns, late starts and load since last t
+*/
+void usbCommand()
+{
+	while (Serial.available() > 0)
+	{
+		switch (Serial.read())
+		{
+		case 'p':
+			profDump();
+			break;
+		case 'z':
+			profReset();
+			break;
+		case 'k':
+			profBlock();
+			break;
+		case 's':
+			strmStart();
+			break;
+		case 'x':
+			strmStop();
+			traceStop();
+			break;
+		case 'r':
+			traceStart(false);
+			break;
+		case 'e':
+			Serial.printf("EE,%lu,%lu\n", eeFlushes, eeBytes);	// flushes, bytes written
+			break;
+		case 'a':
+			Serial.printf("ACT,%d,%lu,%lu,%lu\n", (int)isActive, actSwitches, actLatency, actWorst);
+			break;
+#if CIV_STATS
+		case 'b':
+			civStats();
+			break;
+#endif
+#if SCHED_STATS
+		case 't':
+			schedStats();
+			break;
+#endif
+		case 'c':
+			for (int c = 0; c < NUM_CHANS; c++)
+				Serial.printf("CH,%d,%lu,%lu,%d,%lu,%d\n", c, (unsigned long)chan[c].fmW,
+					(unsigned long)chan[c].rmW, chan[c].swr, (unsigned long)chan[c].rmsmW, chan[c].crest);
+			break;
+		default:
+			break;
+		}
+	}
+}
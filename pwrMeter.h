@@ -47,18 +47,70 @@ two sets of factors as detection diodes are no linear at low powers.
 #define	civSerial Serial1					        // uses serial1 rx/tx pins 0,1
 bool	isCivEnable = true;				            // 0 = Power meter only, 1 = added CI-V
 #define	btSerial Serial3					        // bluetooth serial3 - pins 7,8
+#define BT_BAUD         9600						// HC-05 default speed
+
+/*----------Bluetooth telemetry------------------------------*/
+// frames both ways: TLM_SYNC | type | len | payload | crc8. see blueTooth.ino
+#define TLM_SYNC        0xA5
+#define TLM_VALUES      0x01						// meter -> phone: seq, (field, zigzag varint)...
+#define TLM_CMD_SUB     0x10						// phone -> meter: subscribe mask u8, bit per field
+#define TLM_CMD_RATE    0x11						// phone -> meter: field u8, interval u16 (mSecs)
+#define TLM_CMD_SNAP    0x12						// phone -> meter: resend all subscribed now
+#define TLM_PAYLOAD     32							// max payload bytes
+#define TLM_BUDGET      800							// max bytes/sec, 9600 baud = 960
+#define TLM_KEEPALIVE   5000						// resend unchanged values (mSecs)
+
+#define TLM_NETT        0							// nett power, mW
+#define TLM_PEAK        1							// peak / pep, mW
+#define TLM_SWR         2							// swr x 100
+#define TLM_DBM         3							// dBm x 10
+#define TLM_FREQ        4							// frequency, Hz
+#define TLM_TUNER       5							// tuner status 0 off, 1 on, 2 tuning
+#define TLM_RMS         6							// fwd true RMS power, mW
+#define TLM_CREST       7							// fwd crest factor x 100
+#define TLM_FIELDS      8							// max 8, subscribe mask u8
+
+struct tlmField {
+	int32_t val;									// latest value
+	int32_t sent;									// last value sent
+	unsigned long interval;							// min time between sends (mSecs)
+	unsigned long time;								// millis() last sent
+	bool isSub;										// subscribed
+	bool isSet;										// val valid
+};
+
+tlmField tlm[TLM_FIELDS] = {
+	{ 0, 0, 200,  0, true, false },					// nett power
+	{ 0, 0, 500,  0, true, false },					// peak
+	{ 0, 0, 500,  0, true, false },					// swr
+	{ 0, 0, 500,  0, false, false },				// dBm
+	{ 0, 0, 1000, 0, true, false },					// freq
+	{ 0, 0, 1000, 0, true, false },					// tuner
+	{ 0, 0, 500,  0, false, false },				// rms power
+	{ 0, 0, 500,  0, false, false },				// crest factor
+};
+
+uint8_t tlmRx[TLM_PAYLOAD + 4];						// command frame being received
+int		tlmRxN;
+uint8_t tlmSeq;										// values frame sequence
+bool	isTlmSnap;									// send all subscribed next frame
+unsigned long tlmBytes;								// bytes sent this second
 
 /*----------Icom CI-V Constants------------------------------*/
 #define CIVADDR         0xE2			        	// this controller address
 #define CIVRADIO        0x94						// Icom IC-7300 CI-V default address
+#define CIV_BAUD        19200						// CI-V bus speed
 #define CIVTIMEOUT      100						    // 100 milli-seconds
-#define CIV_WRITE_DELAY 3					        // CIV write delay = milliseconds
-#define CIV_READ_DELAY  1						    // CIV read delay to ensure rx buffer fill
+#define CIV_RETRIES     2						    // resends after timeout or collision
+#define CIV_BUFF        16						    // max CI-V frame size, preamble to 0xFD
+#define CIV_QUE_SIZE    8						    // outgoing command queue size
+#define CIV_RX_GAP      5							// mSecs without a byte, frame end lost
 
 /*----------Icom CI-V commands------------------------------*/
 char    civReadPreamble[] = { 0xFE, 0xFE,  CIVADDR, CIVRADIO };			    // read from radio command preamble
 char    civWritePreamble[] ={ 0xFE, 0xFE,  CIVRADIO, CIVADDR };			    // write command preamble
 char    civReadFreq[] =     { 0x03, 0xFD };								    // read frequency
+char    civReadMode[] =     { 0x04, 0xFD };								    // read mode
 char    civWriteFreq[] =    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFD };	// set frequency
 char    civReadTuner[] =    { 0x1C, 0x01, 0xFD };							// read tuner status
 char    civWriteTuner[] =   { 0x1C, 0x01, 0x02, 0xFD };					    // radio tuner activate
@@ -67,6 +119,80 @@ char    civWriteRef[] =     { 0x27, 0x19, 0x00,0x00,0x00,0x00,0xFD };		// spectr
 char	civReadTxPwr[] =    { 0x14, 0x0A, 0xFD };						    // read RF Power setting
 char	civWriteTxPwr[] =   { 0x14, 0x0A, 0x00, 0x00, 0xFD };			    // set RF Power
 
+/*----------CI-V transport. queued commands, byte driven frame parser-----------------*/
+// result slots, radio state cache. last reply or transceive frame for each read command
+#define CIV_FREQ        0							// civReadFreq
+#define CIV_TUNER       1							// civReadTuner
+#define CIV_REF         2							// civReadRef
+#define CIV_TXPWR       3							// civReadTxPwr
+#define CIV_MODE        4							// civReadMode
+#define NUM_CIV_SLOTS   5
+#define CIV_NO_BCST     0xFF						// slot not sent by radio transceive
+#define CIV_BCST_AGE    10000						// freq poll interval (mSecs) once transceive frames seen
+char*   civSlotCmd[NUM_CIV_SLOTS] =  { civReadFreq, civReadTuner, civReadRef, civReadTxPwr, civReadMode };
+byte    civSlotBcst[NUM_CIV_SLOTS] = { 0x00,        CIV_NO_BCST,  CIV_NO_BCST, CIV_NO_BCST, 0x01 };	// transceive command
+byte    civSlotLen[NUM_CIV_SLOTS] =  { 11,          8,            11,          9,           8 };	// frame length, other = bytes lost
+const char* civSlotName[NUM_CIV_SLOTS] = { "freq", "tuner",   "ref",       "txPwr",     "mode" };
+bool    isCivTransceive = false;					// true once radio transceive frames received
+
+// poll scheduler. one poll at a time, only when queue empty and bus budget not used
+#define CIV_BUS_BYTES   (CIV_BAUD / 10)				// bus capacity bytes/sec, 8N1
+#define CIV_BUS_BUDGET  60							// max % of bus used before polls wait
+#define CIV_STATS       true						// 'b' USB command reports refresh rates and bus use
+struct civRate {
+	unsigned long interval;							// refresh interval (mSecs), 0 = no polling
+	int priority;									// higher polled first when due together
+	unsigned long budget;							// staleness budget (mSecs), older polls go first
+	unsigned long updates;							// values received, for stats
+	unsigned long polls;							// polls sent, for stats
+};
+civRate civRates[NUM_CIV_SLOTS] = {
+  { 200,	3,	500,	0, 0 },						// freq
+  { 250,	2,	1000,	0, 0 },						// tuner
+  { 2000,	1,	5000,	0, 0 },						// ref
+  { 1000,	1,	3000,	0, 0 },						// txPwr
+  { 0,		0,	0,		0, 0 },						// mode, transceive only
+};
+unsigned long civBusBytes, civBusTot;				// bus bytes this second, since last stats
+
+// round trip latency, first send to echo (writes) or reply (reads). since last stats
+#define CIV_LAT_BUCKETS 64							// latency histogram buckets
+#define CIV_LAT_WIDTH   4							// bucket width (mSecs), last bucket is overflow
+uint16_t civLatHist[CIV_LAT_BUCKETS];				// latency histogram
+unsigned long civCmdsOk, civCmdsFail, civResends;	// completed, timed out, resent commands
+unsigned long civWrites;							// writes completed (echo ok), for sweep
+
+struct civSlot {
+	char buff[CIV_BUFF];							// last reply frame
+	int n;											// frame length, 0 = no valid reply
+	unsigned long time;								// millis() when received
+	bool isPending;									// read queued or in progress
+	bool isDirty;									// value changed since civChanged()
+	bool isStale;									// force poll, radio setting written
+	bool isWriting;									// civWriteBack() queued, isStale when done
+};
+civSlot civSlots[NUM_CIV_SLOTS];
+
+struct civCmd {
+	char buff[CIV_BUFF];							// complete frame, preamble to 0xFD
+	int n;											// frame length
+	int slot;										// result slot for reads, -1 for writes
+	int back;										// writes: slot read back when done, -1 none
+	int retries;									// resend count
+	unsigned long start;							// millis() at first send, 0 = not sent
+};
+civCmd  civQue[CIV_QUE_SIZE];						// outgoing queue, head is command in progress
+int     civQueHead, civQueN;						// queue head, number queued
+
+// command in progress state
+#define CIV_IDLE        0							// nothing sent
+#define CIV_ECHO        1							// sent, waiting for bus echo
+#define CIV_REPLY       2							// echo ok, waiting for radio reply
+int     civState = CIV_IDLE;
+char    civRx[CIV_BUFF];							// incoming frame
+int     civRxN;										// incoming frame length
+unsigned long civRxTime;							// millis() at last byte received
+
 /*----------ILI9341 TFT display (320x240)-------------------------*/
 #define     ROTATION 1								// rotation for tft and touchscreen
 #define		TFT_DC 9
@@ -98,6 +224,23 @@ int yMapT = 300, yMapB = 3800;
 #define		PLUS_SYMBOL 85							// + symbol
 #define		MINUS_SYMBOL 86							// - symbol
 #define	    T_OFFSET 15							    // touch offset distance (pixels)
+
+// touch gesture state machine, touchPoll() from loop() and measure(), doesn't wait
+#define		TOUCH_IDLE 0							// not touched
+#define		TOUCH_DOWN 1							// touched, timing for long touch
+#define		TOUCH_HELD 2							// long touch sent or cancelled, wait for release
+#define		TOUCH_NONE 0							// events. TAP, LONG same as touchActions() tStat
+#define		TOUCH_TAP  1							// short touch, on release
+#define		TOUCH_LONG 2							// long touch, when longTouchTimer expires
+#define		TOUCH_PRESS 3							// first contact
+int			touchState = TOUCH_IDLE;
+int			touchFrame = -1;						// frame under touch, -1 none
+
+// hit test grid, bit i set if fr[i] overlaps cell. built by touchGrid() in initDisplay()
+#define		TOUCH_CELL 32							// grid cell size (pixels)
+#define		TOUCH_COLS (320 / TOUCH_CELL)
+#define		TOUCH_ROWS ((240 + TOUCH_CELL - 1) / TOUCH_CELL)
+uint32_t	touchCells[TOUCH_ROWS][TOUCH_COLS];		// NUM_FRAMES <= 32
 //const int TICK_SYMBOL = 12;						// Awesome_F000 character
 //const int CROSS_SYMBOL = 13;
 
@@ -105,23 +248,194 @@ int yMapT = 300, yMapB = 3800;
 // ACD parameters are define in acd.ino
 ADC* adc = new ADC();							    // adc object
 ADC::Sync_result result;						    // ADC result structure
-const int    MAXBUF = 1000;						    // maximum averaging buffer/samples size
-int	         samplesAvg;						    // number of cyclic buffer samples
-volatile int sample;							    // ADC cyclic buffer sample
-volatile long buf0Tot, buf1Tot;					    // cyclic buffer totals
-volatile unsigned int buf0Pk, buf1Pk;			    // cyclic buffer peak values
-volatile unsigned int buf0[MAXBUF + 1] = {}, buf1[MAXBUF + 1] = {};  // cylic buffer used by interrupt routine
+// 16 bit sample store per measurement channel (measChan.h), averaging windows for default,
+// alternate and calibrate samples all kept running by getADC(). switching samplesAvg needs no reset
+const int    MAXBUF = 3072;						    // cyclic buffer size (sample pairs), multiple of WIN_BLK
+#define      WIN_BLK 16								// samples per peak block
+#define      WIN_MAX (MAXBUF - 256)					// max window, margin so adcPeak() reads aren't overwritten
+#define      WIN_DEF 0								// windows, samplesDefPar
+#define      WIN_ALT 1								// samplesAltPar
+#define      WIN_CAL 2								// samplesCalPar
+#define      NUM_WIN 3
+int	         samplesAvg;						    // number of samples in current averaging window
+volatile int sample;							    // ADC cyclic buffers, next write position, all channels
 #define     SAMPLE_INTERVAL 500						// ADC sample interval (microsecs)
 IntervalTimer sampleTimer;						    // getADC interupt timer
+volatile uint32_t sampleCount;					    // sample pairs added since start, wraps
+
+// raw sample streaming over USB Serial, 's' start, 'x' stop. read straight from chan[CH_MAIN] buffers
+// pairs more than MAXBUF / 2 behind getADC() are dropped
+#define     STRM_SYNC0 0xA5							// frame start
+#define     STRM_SYNC1 0x5A
+#define     STRM_PAIRS 64							// max sample pairs per frame
+#define     STRM_ESC   0x80							// delta escape, raw 16 bit value follows
+#define     STRM_MAX   (7 + 4 + (STRM_PAIRS - 1) * 6 + 2)	// worst case frame bytes
+#define     STRM_BUF   (2 * STRM_MAX)					// staged frames, USB takes 64 bytes at a time
+bool        isStreaming = false;
+uint8_t     strmBuf[STRM_BUF];						// frames waiting for USB
+int         strmLen, strmOff;						// bytes staged, bytes of them sent
+uint32_t    strmCount;								// sampleCount of next pair to send
+uint16_t    strmSeq;								// frame sequence number
+uint32_t    strmDrops;								// pairs lost since last frame sent (overwritten or link busy)
+uint32_t    strmDropTot;							// pairs lost since stream start
+
+// session trace over USB Serial, 'r' start, 'x' stop. inputs and display digest, see trace.ino
+#define     TRACE_BOOT false						// true = trace from end of setup(), replayable (tools/host)
+#define     TRC_SYNC0 0xA7							// record start
+#define     TRC_SYNC1 0x7A
+#define     TRC_TICK 1								// task run: micros(), sampleCount, task
+#define     TRC_ADC 2								// sample pairs from cyclic buffer
+#define     TRC_CIV_RX 3							// CI-V bus bytes received
+#define     TRC_CIV_TX 4							// CI-V frame sent
+#define     TRC_TOUCH 5								// touch event
+#define     TRC_END 6								// display digest, totals
+#define     TRC_START 7								// micros(), first pair, flags
+#define     TRC_EE 8								// EEPROM image at start, address, bytes
+#define     TRC_TASK_CIV 0xFF						// TRC_TICK task, civService() pass with bus traffic
+#define     TRC_BOOT 0x01							// TRC_START flags, started by setup()
+#define     TRC_CIV_ON 0x02							// isCivEnable
+#define     TRC_EE_CHUNK 64							// EEPROM bytes per TRC_EE record
+#define     TRC_BUF 4096							// record buffer, sent by trace task
+#define     TRC_PAIRS 60							// max sample pairs per record
+bool        isTracing = false;
+uint8_t     trcBuf[TRC_BUF];						// framed records waiting for USB
+int         trcHead, trcTail;						// buffer write, send positions
+uint32_t    trcCount;								// sampleCount of next pair to record
+uint32_t    trcRecs, trcDrops;						// records, records lost (buffer full) + pairs overwritten
+uint16_t    dispDigest;								// CRC-16 of values and meter bars drawn while tracing
+
+// block acquisition mode. PDB triggered ADC, DMA into ping-pong buffers, one interrupt per block
+#ifndef BLOCK_MODE
+#define     BLOCK_MODE false						// true = block mode, false = getADC() every SAMPLE_INTERVAL
+#endif
+#define     BLOCK_SIZE 64							// sample pairs per block (half buffer)
+#define     BLOCK_RATE 20000						// block mode sample rate (Hz)
+#define     BLOCK_SPIN 20							// dma0 reads waiting for its transfer of the same conversion
+DMAChannel  dma0, dma1;								// DMA channels for ADC_0, ADC_1
+volatile uint16_t blk0[BLOCK_SIZE * 2], blk1[BLOCK_SIZE * 2];	// ping-pong block buffers, ref & fwd
+volatile unsigned long blkCount;					// number of blocks received
+volatile unsigned long blkSkew;						// blocks dropped, dma0 / dma1 out of step, DMA restarted
+
+// samples params (samplesDefPar etc) count SAMPLE_INTERVAL samples, same window time in both modes
+// block mode windows are WIN_MULT times as many buffer samples, so fewer samples params fit
+#define     WIN_MULT (BLOCK_MODE ? BLOCK_RATE / (1000000 / SAMPLE_INTERVAL) : 1)
+#define     SAMPLES_MAX (WIN_MAX / WIN_MULT)		// max samples param
+
+// display compositor. measure() sets latest values, displayFlush() draws changed frames at DISP_FPS (display task)
+#define     DISP_COMPOSE true						// true = batch display at DISP_FPS, false = draw every measure()
+#define     DISP_FPS 25								// display frames per second
+#define     DISP_SLICE 2000							// uSecs, no frame started after this in a pass, rest next pass
+uint32_t    tunerFreq;								// freq (Hz) at last tune, freqDiffTune() measures from here
+
+/*----------SWR sweep--------------------------------------------*/
+// long touch on SWR meter. radio stepped across current band, SWR per point plotted in sweepGraph frame
+// next freq write is sent while current point averages, radio retunes as point is read
+#define     SWEEP_POINTS 100						// points per sweep
+#define     SWEEP_SETTLE 20							// mSecs after freq write, radio retune + tx settle
+#define     SWEEP_TIMEOUT 500						// mSecs to wait for freq write, then sweep stopped
+#define     SWEEP_SWR_MAX 4							// graph top, same as SWR meter
+#define     SWEEP_OFF 0								// states
+#define     SWEEP_TUNE 1							// freq write queued, wait for radio echo
+#define     SWEEP_WAIT 2							// settle + averaging window, then read point
+#define     SWEEP_DONE 3							// graph shown until touched
+int         sweepState = SWEEP_OFF;
+int         sweepN;									// current point
+int         sweepBand;								// hfBand[] swept
+bool        isSweepNext;							// next point freq write queued
+unsigned long sweepTime;						    // SWEEP_TUNE: queue time, SWEEP_WAIT: read time (millis())
+unsigned long sweepWrites;							// civWrites when freq write queued
+uint32_t    sweepFreq;								// freq (Hz) before sweep, restored at end
+uint16_t    sweepSwr[SWEEP_POINTS];					// SWR x 100 per point, 0 = no carrier
+float       measPwr, measSwr;						// latest nett power, SWR from measure()
+
+/*----------power / SWR history----------------------------------*/
+// measure() results decimated to per second and per minute rings, min / mean / max per point
+// long touch on power meter shows trendGraph, new columns drawn as points complete
+// power code: 0.25 dB steps from 0 dBm, 0 = no power. swr code: 1 + (SWR - 1) x 50, 0 = no carrier
+#define     HIST_SECS 600							// per second points, 10 mins
+#define     HIST_MINS 720							// per minute points, 12 hours
+#define     HIST_SEC 0								// rings
+#define     HIST_MIN 1
+#define     NUM_HIST 2
+#define     HIST_PPC 3								// ring points per graph column
+#define     HIST_PWR_LO 80							// graph power codes, 100mW
+#define     HIST_PWR_HI 240							// 1kW
+#define     HIST_SWR_HI 101							// graph swr code, SWR 3
+#define     HIST_DRAW_COLS 20						// max columns per trend task run
+#define     HIST_OFF -1								// histView, graph not shown
+
+struct histPt {										// one ring point, 6 bytes
+	uint8_t pMin, pMean, pMax;						// power codes
+	uint8_t sMin, sMean, sMax;						// swr codes, carrier only
+};
+
+struct histAcc {									// point being built
+	uint32_t n;										// power samples
+	uint64_t pSum;									// milliWatts, mean is linear power
+	uint8_t pMin, pMax;
+	uint32_t sN, sSum;								// carrier samples, swr codes
+	uint8_t sMin, sMax;
+};
+
+struct histRing {
+	histPt* pt;
+	int size;										// points
+	uint32_t n;										// points added since start
+	histAcc acc;
+};
+
+histPt      histSecs[HIST_SECS], histMins[HIST_MINS];
+histRing    hist[NUM_HIST] = { { histSecs, HIST_SECS }, { histMins, HIST_MINS } };
+unsigned long histTime;								// millis() at end of current second
+int         histView = HIST_OFF;					// ring shown in trendGraph
+uint32_t    histCol;								// next graph column to draw
+
+/*----------adaptive rates---------------------------------------*/
+// no carrier: getADC() at ACT_IDLE_INTERVAL, measure and display tasks slow.
+// fwd sample at PWR_THRESHOLD (ACT_CODE) in getADC() goes straight to full sample rate, act task
+// then sets full task rates. back to idle ACT_HOLD after last carrier sample
+#define     ADAPTIVE true							// true = idle rates when no carrier
+#define     ACT_IDLE_INTERVAL 2000					// idle sample interval (microsecs), 500 Hz
+#define     ACT_HOLD 3000							// mSecs full rate after last carrier sample
+#define     ACT_MEASURE_IDLE 20						// idle measure task period (mSecs)
+#define     ACT_FPS_IDLE 5							// idle display frames per second
+volatile bool isActive = true;						// carrier in last ACT_HOLD, full sample rate
+volatile unsigned long actCarrier;					// millis() of last carrier sample
+volatile unsigned long actKeyUs;					// micros() of carrier detect from idle
+bool        isActRate = true;						// task rates set for carrier
+bool        isActFirst;								// waiting for first reading after key down
+unsigned long actSwitches;							// idle to carrier switches
+unsigned long actLatency, actWorst;					// key down to first reading (uSecs), last and worst
+
+/*----------cooperative scheduler--------------------------------*/
+// loop() runs due tasks, earliest deadline first. tasks never call each other or wait
+#define     SCHED_STATS true						// true = 't' USB command reports task timing
+#define     MS 1000UL								// uSecs per mSec, task periods / budgets are uSecs
+
+struct task {
+	const char* name;
+	void (*fn)();									// task function, runs to completion
+	unsigned long period;							// uSecs between runs, 0 = every pass
+	unsigned long budget;							// worst case run time allowed (uSecs)
+	unsigned long next;								// deadline, micros() when next due
+	unsigned long runs;								// runs since last stats
+	unsigned long overruns;							// runs longer than budget
+	unsigned long late;								// runs started more than one period late
+	unsigned long worst;							// longest run (uSecs)
+};
+unsigned long schedBusy;							// uSecs in tasks since last stats, cpu load
+unsigned long schedStatsTime;						// micros() at last stats
 
 /*----------Metro timers-----------------------------------------*/
 Metro aBandTimer =      Metro(1000);				// autoband time milliseconds, auto reset
-Metro heartBeatTimer =  Metro(250);			        // heartbeat timer
 Metro longTouchTimer =  Metro(750);			        // long touch timer
 Metro pkPwrTimer =      Metro(3000);			    // peak power hold timer
 Metro pepTimer =        Metro(500);				   	// pep hold timer
-Metro civTimeOut =      Metro(100);				    // civ read/write watchdog timer
+Metro civTimeOut =      Metro(CIVTIMEOUT);		    // civ command watchdog timer
+Metro civBusTimer =     Metro(1000);				// civ bus budget, 1 sec window
+Metro tlmBusTimer =     Metro(1000);				// bluetooth telemetry budget, 1 sec window
 Metro dimTimer =        Metro(15 * 60 * 1000);		// dimmer timer (mins)
+Metro eeTimer =         Metro(EE_DELAY);			// EEPROM write delay, restarted by each change
 
 
 /*----------pin assigns--------------------------------------*/
@@ -130,24 +444,40 @@ Metro dimTimer =        Metro(15 * 60 * 1000);		// dimmer timer (mins)
 
 
 
-// constant expression to convert BCD to decimal
-constexpr int getBCD(int n)
+// BCD conversion tables, built at compile time (flash). CI-V values are packed BCD, 2 digits per byte
+struct bcdTable {
+	uint8_t dec[256];								// BCD byte to 0 - 99
+	uint8_t enc[100];								// 0 - 99 to BCD byte
+	constexpr bcdTable() : dec(), enc()
+	{
+		for (int n = 0; n < 256; n++)
+			dec[n] = n / 16 * 10 + n % 16;
+		for (int n = 0; n < 100; n++)
+			enc[n] = n / 10 * 16 + n % 10;
+	}
+};
+constexpr bcdTable bcdTbl;
+
+// convert BCD to decimal
+inline int getBCD(int n)
 {
-	return n / 16 * 10 + n % 16;
+	return bcdTbl.dec[n & 0xFF];
 }
-// constant expression to convert decimal to BCD 
-constexpr int putBCD(int n)
+// convert decimal (0 - 99) to BCD
+inline int putBCD(int n)
 {
-	return n / 10 * 16 + n % 10;
+	return bcdTbl.enc[n];
 }
 
 
 
 
 /*---------- Teensy restart code (long press on Peak Power frame)--------*/
+#ifndef CPU_RESTART											// host build supplies its own
 #define		CPU_RESTART_ADDR (uint32_t *)0xE000ED0C
 #define		CPU_RESTART_VAL 0x5FA0004
 #define		CPU_RESTART (*CPU_RESTART_ADDR = CPU_RESTART_VAL);
+#endif
 
 /*----------Teensy - enable printf functions------------------------------------*/
 /* this doesn't seem to be required
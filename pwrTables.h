@@ -0,0 +1,118 @@
+/*---------------------------------------------------------
+  POWERMETER III + ICOM 7300 CONTROLLER
+   Copyright 2018-2020  Roger Mawhinney, GI8GZM.
+  No publication with acknowledgement to author
+*/
+
+// pwrTables.h
+// ADC code to power lookup tables, built at compile time from pwrMeter.h constants
+
+/*---------- fixed point power calculation ------------------
+Teensy 3.2 has no floating point unit. log() and polynomial in pwrCalc() are slow.
+Tables give power (milliWatts) for every 12 bit ADC code, same formula as pwrCalc().
+Averaged ADC readings have ADC_FRAC_BITS fraction bits, interpolated between codes.
+Tables are constexpr so are held in flash, not RAM.
+*/
+#define FIXED_PWR       true						// true = table lookup, false = pwrCalc() float
+#define ADC_CODES       4096						// 12 bit ADC, RESOLUTION in adc.ino
+#define ADC_FRAC_BITS   4							// fraction bits for averaged ADC codes
+#define ADC_VREF        3.3							// ADC reference volts
+
+// constant expression natural log, used only to build tables
+// ln(x) = k * ln(2) + 2 * atanh((m - 1) / (m + 1)),  x = m * 2^k
+constexpr double lnConst(double x)
+{
+	int k = 0;
+	while (x > 2.0) { x /= 2.0; k++; }
+	while (x < 1.0) { x *= 2.0; k--; }
+
+	double y = (x - 1.0) / (x + 1.0);
+	double y2 = y * y;
+	double sum = 0.0;
+	for (int n = 31; n >= 1; n -= 2)				// atanh series, odd powers
+		sum = sum * y2 + 1.0 / n;
+
+	return 2.0 * y * sum + k * 0.69314718055994531;
+}
+
+// power table for one direction (fwd or ref)
+struct pwrTable
+{
+	uint32_t mW[ADC_CODES + 1];						// power (milliWatts) for each ADC code, +1 for interpolation
+
+	constexpr pwrTable(double zeroAdj, double split, double loMult, double loAdd,
+		double hiMult2, double hiMult1, double hiAdd) : mW()
+	{
+		for (int i = 0; i <= ADC_CODES; i++)
+		{
+			double v = i * ADC_VREF / (ADC_CODES - 1) + zeroAdj;	// ADC volts, zero adjusted
+			double pwr = 0.0;
+
+			if (v <= 0.0)
+				pwr = 0.0;							// log not valid
+			else if (v < split)						// low power below split (non-linear)
+				pwr = lnConst(v) * loMult + loAdd;
+			else									// high power
+				pwr = v * v * hiMult2 + v * hiMult1 + hiAdd;
+
+			if (pwr < 0.0)
+				pwr = 0.0;							// no -ve power
+			mW[i] = (uint32_t)(pwr * 1000.0 + 0.5);
+		}
+	}
+};
+
+constexpr pwrTable fwdPwrTbl(FV_ZEROADJ, FWD_V_SPLIT_PWR, FWD_LO_MULT_PWR, FWD_LO_ADD_PWR,
+	FWD_HI_MULT2_PWR, FWD_HI_MULT1_PWR, FWD_HI_ADD_PWR);		// forward power table
+constexpr pwrTable refPwrTbl(RV_ZEROADJ, REF_V_SPLIT_PWR, REF_LO_MULT_PWR, REF_LO_ADD_PWR,
+	REF_HI_MULT2_PWR, REF_HI_MULT1_PWR, REF_HI_ADD_PWR);		// reflected power table
+
+// lowest ADC code with power over mW, ADC_CODES if none
+constexpr int pwrCode(const pwrTable& t, uint32_t mW)
+{
+	int i = 0;
+	while (i < ADC_CODES && t.mW[i] <= mW)
+		i++;
+	return i;
+}
+
+constexpr int ACT_CODE = pwrCode(fwdPwrTbl, PWR_THRESHOLD * 1000);	// carrier detect, raw fwd sample
+
+/*---------- per band calibration curves ------------------
+calMode() captures points (ADC code, reference meter power) for each hfBand[] and direction, saved in EEPROM.
+At band change the current band curve is expanded into a RAM table, CAL_TBL_SHIFT codes per entry,
+so measure() still does a single lookup. Bands without cal points use the compiled tables above.
+*/
+#define CAL_POINTS      6							// max cal points per band and direction
+#define CAL_TBL_SHIFT   3							// 8 ADC codes per cal table entry
+#define CAL_TBL_SIZE    (ADC_CODES >> CAL_TBL_SHIFT)	// cal table entries, +1 for interpolation
+#define CAL_MAX_PWR     100							// max reference power (Watts) for a cal point
+#define CAL_BLINK       100							// mSecs frame blanked to show cal point written
+
+struct calPoint
+{
+	uint32_t mW;									// reference meter power, milliWatts
+	uint16_t code;									// averaged ADC code
+};
+
+struct calCurve
+{
+	uint8_t n;										// number of points, sorted by code
+	calPoint pt[CAL_POINTS];
+};
+
+struct eeCal										// EEPROM record, one per band
+{
+	calCurve fwd;
+	calCurve ref;
+};
+#define EEADDR_CALCRC (EEADDR_CAL + NUM_BANDS * (int)sizeof(eeCal))	// CRC-8 per band cal record
+static_assert(EEADDR_CALCRC + NUM_BANDS <= EEADDR_PARAM + EE_ALT, "EEPROM B slots overlap cal records");
+static_assert(EEADDR_PARAM2 + EEINCR + EE_ALT <= 2048, "EEPROM B slots past 2k");
+
+eeCal		calCurr;								// cal curves for current band
+int			calBand = -2;							// band of expanded cal tables, -1 no band, -2 not loaded
+uint32_t	calFwdTbl[CAL_TBL_SIZE + 1], calRefTbl[CAL_TBL_SIZE + 1];	// expanded cal tables (milliWatts)
+int			calBlink = -1;							// frame blanked by calButton(), -1 none
+Metro		calBlinkTimer = Metro(CAL_BLINK);		// blanked frame restored by displayTask()
+// power tables used by measure() are per channel, measChan.h
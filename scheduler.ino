@@ -0,0 +1,248 @@
+/*---------------------------------------------------------
+  POWERMETER III + ICOM 7300 CONTROLLER
+   Copyright 2018-2020  Roger Mawhinney, GI8GZM.
+  No publication with acknowledgement to author
+*/
+
+/*
+cooperative scheduler
+loop() calls schedRun(). each pass runs one due task, earliest deadline first.
+tasks run to completion and never call another task or wait for the radio, so
+latency is bounded by the longest task. budgets are checked and overruns counted.
+option screens (long touch) are modal and still block until exit.
+*/
+
+// task table. period, budget in uSecs. order only breaks deadline ties
+task tasks[] = {
+	// name			function		period					budget
+	{ "civ",		civTask,		0,						200 },		// CI-V send / receive
+	{ "act",		actTask,		0,						50 },		// idle / carrier rates
+	{ "measure",	measureTask,	2 * MS,					1500 },		// ADC results to power, swr
+	{ "touch",		touchTask,		10 * MS,				1000 },		// touch gestures, button actions
+	{ "display",	displayTask,	1000 * MS / DISP_FPS,	8000 },		// draw changed values
+	{ "radio",		radioTask,		50 * MS,				4000 },		// freq, band, tuner, ref display
+	{ "autoband",	aBandTask,		100 * MS,				3000 },		// FT8 auto band change
+	{ "bt",			btTask,			20 * MS,				500 },		// bluetooth
+	{ "usb",		usbTask,		50 * MS,				0 },		// USB serial commands
+	{ "stream",		strmTask,		5 * MS,					1000 },		// raw sample stream
+	{ "trace",		traceTask,		5 * MS,					1000 },		// session trace records
+	{ "sweep",		sweepTask,		1 * MS,					1000 },		// SWR sweep steps
+	{ "trend",		histTask,		100 * MS,				4000 },		// trend graph new columns
+	{ "heartbeat",	heartBeatTask,	250 * MS,				500 },		// pulsing dot
+	{ "dimmer",		dimmerTask,		1000 * MS,				200 },		// dim display if not active
+	{ "eeprom",		eeTask,			100 * MS,				0 },		// delayed EEPROM writes, flash stalls
+};
+
+#define NUM_TASKS (int)(sizeof(tasks) / sizeof(tasks[0]))
+
+/*------------------------------ schedRun() -------------------------------------------------
+runs the due task with the earliest deadline
+Called by: loop()
+*/
+void schedRun()
+{
+	unsigned long now = micros();
+	task* tPtr = NULL;
+	unsigned long start, t;
+
+	// due task, earliest deadline. signed difference for micros() wrap
+	for (int i = 0; i < NUM_TASKS; i++)
+	{
+		if ((long)(now - tasks[i].next) < 0)
+			continue;										// not due
+		if (tPtr == NULL || (long)(tasks[i].next - tPtr->next) < 0)
+			tPtr = &tasks[i];
+	}
+	if (tPtr == NULL)
+		return;
+
+	if (tPtr->period && now - tPtr->next > tPtr->period)
+		tPtr->late++;										// missed a whole period
+
+	if (tPtr->period)
+		traceTick(tPtr - tasks);							// replay runs task here. civ traced by civService()
+	start = micros();
+	tPtr->fn();
+	t = micros() - start;
+
+	// record timing
+	schedBusy += t;
+	tPtr->runs++;
+	if (t > tPtr->worst)
+		tPtr->worst = t;
+	if (tPtr->budget && t > tPtr->budget)
+		tPtr->overruns++;
+
+	// next deadline. if behind, restart from now rather than catch up
+	tPtr->next += tPtr->period;
+	if ((long)(start - tPtr->next) > 0)
+		tPtr->next = start + tPtr->period;
+}
+
+/*------------------------------ schedPeriod() -------------------------------------------------
+changes period of task fn. isNow: task due now, else from its next deadline
+Called by: actRates()
+*/
+void schedPeriod(void (*fn)(), unsigned long period, bool isNow)
+{
+	for (int i = 0; i < NUM_TASKS; i++)
+	{
+		if (tasks[i].fn != fn)
+			continue;
+		tasks[i].period = period;
+		if (isNow)
+			tasks[i].next = micros();
+	}
+}
+
+/*------------------------------ schedStats() -------------------------------------------------
+prints runs, worst run time, overruns and late starts per task since last stats, then clears
+Called by: usbCommand() 't'
+load: task time % since last stats, interrupts not included (see PZ_ADC profile zone)
+*/
+void schedStats()
+{
+	unsigned long now = micros();
+	unsigned long load = schedBusy / ((now - schedStatsTime) / 1000 + 1);	// tenths of %
+
+	Serial.printf("LOAD %lu.%lu%% %s\n", load / 10, load % 10, isActive ? "carrier" : "idle");
+	schedBusy = 0;
+	schedStatsTime = now;
+	Serial.println("TASK       runs  worst(us) budget  over  late");
+	for (int i = 0; i < NUM_TASKS; i++)
+	{
+		task* tPtr = &tasks[i];
+
+		Serial.printf("%-9s %6lu %8lu %7lu %5lu %5lu\n", tPtr->name, tPtr->runs, tPtr->worst,
+			tPtr->budget, tPtr->overruns, tPtr->late);
+		tPtr->runs = 0;
+		tPtr->worst = 0;
+		tPtr->overruns = 0;
+		tPtr->late = 0;
+	}
+}
+
+/*------------------------------ tasks -------------------------------------------------
+*/
+void civTask()
+{
+	civService();											// CI-V send / receive, doesn't wait
+}
+
+void actTask()
+{
+	actCheck();												// rates follow carrier, ADAPTIVE
+}
+
+void measureTask()
+{
+	measure();												// measure power, swr etc - main function
+}
+
+void touchTask()
+{
+	touchChk();												// short / long touch actions, doesn't wait
+}
+
+void displayTask()
+{
+	if (calBlink >= 0 && calBlinkTimer.check())				// cal point write blink over
+	{
+		if (!lab[civ].stat)									// still calMode
+			restoreFrame(calBlink);
+		calBlink = -1;
+	}
+	displayFlush();											// values set by measure() since last frame
+}
+
+// radio values, only if civMode enabled
+void radioTask()
+{
+	int currBand;
+	uint32_t currFreq;										// Hz
+
+	if (!isCivEnable)
+		return;
+
+	// get and display frequency
+	currFreq = getFreq();									// get and display current frequency
+	tlmSet(TLM_FREQ, currFreq);								// Hz
+	if (civChanged(CIV_FREQ) || val[freq].isUpdate)			// only if changed or forced
+		displayValue(freq, currFreq / 1000000.0);			// MHz, float for display only
+
+	// display band Mtrs
+	currBand = getBand(currFreq);							// -1(no band) or 0(160m) to 11 (4m)
+	setCal(currBand);										// band calibration tables
+	if (currBand >= 0)
+	{
+		displayValue(band, hfBand[currBand].mtrs);			// display band metres
+		setRef(currBand);									// set spectrum ref
+	}
+
+	// get tuner status
+	tlmSet(TLM_TUNER, tunerStatus());
+
+	// check for freq difference tune. not while sweep is changing freq
+	if (sweepState == SWEEP_OFF)
+		freqDiffTune(currFreq);
+
+	// display %TX RF Power	else display spectrum ref
+	if (frs.isEnable[txPwr])								// only if enabled
+		displayTxPwr();
+	else
+		displayValue(sRef, getRef());						//if (frs.isEnable[sRef]), save on serial comms
+}
+
+void aBandTask()
+{
+	if (isCivEnable)
+		autoBand(getFreq());								// run FT8 auto band change
+}
+
+void btTask()
+{
+	blueTooth();
+}
+
+void usbTask()
+{
+	usbCommand();											// profile dump etc
+}
+
+void strmTask()
+{
+	strmSend();												// only if streaming
+}
+
+void traceTask()
+{
+	traceSend();											// only if tracing or records waiting
+}
+
+void sweepTask()
+{
+	sweepRun();												// only if sweeping
+}
+
+void histTask()
+{
+	histDraw();												// only if trend graph shown
+}
+
+void heartBeatTask()
+{
+	heartBeat();
+}
+
+// dimmer timer - dim display if not active, touch to undim
+void dimmerTask()
+{
+	if (dimTimer.check())									// check Metro timer
+		setDimmer();
+}
+
+void eeTask()
+{
+	if (eeDirty && eeTimer.check())							// no changes for EE_DELAY
+		eeFlush();
+}
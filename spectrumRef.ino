@@ -13,7 +13,8 @@ long touch - saves current spectrum ref against current band
 void sRefButton(int tStat)
 {
 	int band;											// current band
-	float freq, r;										// freq, spectrum reference
+	uint32_t freq;										// freq (Hz)
+	float r;											// spectrum reference
 
 	if (tStat != 2)										// button short touch
 	{
@@ -39,49 +40,45 @@ void sRefButton(int tStat)
 }
 
 /*------------------------------ getRef() -------------------------------
-reads radio sprectrum Ref setting
+reads radio sprectrum Ref setting. last value received
 Returns float (ref)
 */
 float getRef()
 {
-
-	int n;												// chars read into buffer
 	int u = 0, d = 0;									// units & decimals
-	float ref = 0.0;											// spectrum ref
-	char inBuff[12];									// civ frequency inBuff buffer
+	float ref = 0.0;									// spectrum ref
+	civSlot* sPtr = civGet(CIV_REF);					// last ref from radio
+	int n = sPtr->n;
 
-	n = civWrite(civReadRef);							// request read frequency from radio
-	n = civRead(inBuff);								// buffer, printflg
-	if (inBuff[3] == CIVRADIO && inBuff[n - 1] == 0xFD)	// check format of serial stream
-	{
-		u = getBCD(inBuff[n - 4]);						// convert from BCD
-		d = getBCD(inBuff[n - 3]);
-	}
-	ref = u + (float)d / 100.0;						// format
-	if (inBuff[n - 2])
-		ref = -ref;									// change sign if negative
+	if (n == 0)											// no valid reply
+		return ref;
+
+	u = getBCD(sPtr->buff[n - 4]);						// convert from BCD
+	d = getBCD(sPtr->buff[n - 3]);
+	ref = u + (float)d / 100.0;							// format
+	if (sPtr->buff[n - 2])
+		ref = -ref;										// change sign if negative
 
 	return ref;
 }
 
 /*------------------------- setRef() ---------------------------
-get Ref and if band changed, set ref
+if band changed, set ref
 passed: current band (int)
-returns: reference (float)
+returns: band reference (float). no radio read, use getRef()
 */
 float setRef(int band)
 {
 	static int prevBand;
-	float sRef;											// spectrum ref
 
-	if (band != prevBand && band != -1)								// band change?
+	if (band == -1)
+		return 0.0;
+	if (band != prevBand)								// band change?
 	{
-		sRef = hfBand[band].sRef;							// get ref
-		putRef(sRef);										// send spec ref to radio
+		putRef(hfBand[band].sRef);						// send spec ref to radio
 		prevBand = band;								// save current band
 	}
-	sRef = getRef();										// read ref from radio
-	return sRef;
+	return hfBand[band].sRef;
 }
 
 /*------------------------------ putRef() ---------------------------------
@@ -106,7 +103,7 @@ void putRef(float sRef)
 	civWriteRef[3] = putBCD(u);
 	civWriteRef[4] = putBCD(d);
 
-	civWrite(civWriteRef);
+	civWriteBack(civWriteRef, CIV_REF);					// read back new setting
 }
 
 
@@ -0,0 +1,201 @@
+/*---------------------------------------------------------
+  POWERMETER III + ICOM 7300 CONTROLLER
+   Copyright 2018-2020  Roger Mawhinney, GI8GZM.
+  No publication with acknowledgement to author
+*/
+
+/*
+raw ADC sample streaming over USB Serial
+sample pairs are read from the CH_MAIN cyclic buffers buf1[] (fwd), buf0[] (ref) behind the
+getADC() write position, no extra sample buffer. decoder: tools/strmDecode.py
+
+frame, little endian:
+	A5 5A | seq u16 | n u8 | drops u16 | fwd u16 | ref u16 | (n-1) x (dFwd, dRef) | crc u16
+	dFwd, dRef: signed byte -127..127 change from previous sample,
+	or STRM_ESC (0x80) then raw u16 value
+	drops: pairs lost since previous frame (0xFFFF = 65535 or more)
+	crc: CRC-16/CCITT (0x1021, init 0xFFFF) of seq to end of last delta
+*/
+
+/*------------------------------ strmStart() -------------------------------------------------
+start streaming from newest sample
+*/
+void strmStart()
+{
+	traceStop();									// shares USB Serial
+	noInterrupts();
+	strmCount = sampleCount;
+	interrupts();
+	strmSeq = 0;
+	strmDrops = 0;
+	strmDropTot = 0;
+	strmLen = strmOff = 0;
+	isStreaming = true;
+}
+
+/*------------------------------ strmStop() -------------------------------------------------
+stop streaming, staged frames sent (waits for USB), print totals as text
+STRM,END,<frames>,<pairs lost>
+*/
+void strmStop()
+{
+	if (!isStreaming)
+		return;
+	isStreaming = false;
+	Serial.write(&strmBuf[strmOff], strmLen - strmOff);	// last frames whole, before text
+	strmLen = strmOff = 0;
+	Serial.printf("\nSTRM,END,%u,%lu\n", strmSeq, (unsigned long)(strmDropTot + strmDrops));
+}
+
+/*------------------------------ strmSend() -------------------------------------------------
+frames waiting sample pairs into strmBuf[] while a worst case frame fits, sends as much as USB takes
+USB availableForWrite() is one packet (64 bytes) or less, never a whole frame
+pairs more than half a cyclic buffer behind getADC() are dropped, getADC() may be overwriting them
+Called by: stream task
+*/
+void strmSend()
+{
+	uint8_t* f;
+	uint32_t count, avail, limit = MAXBUF / 2;
+	int head;
+	adcChan* cPtr = &chan[CH_MAIN];
+
+	if (!isStreaming)
+		return;
+	strmDrain();
+
+	// sent bytes out of buffer, room for new frames
+	if (strmOff)
+	{
+		memmove(strmBuf, &strmBuf[strmOff], strmLen - strmOff);
+		strmLen -= strmOff;
+		strmOff = 0;
+	}
+
+	noInterrupts();
+	count = sampleCount;
+	head = sample;
+	interrupts();
+
+	avail = count - strmCount;
+	if (avail > limit)								// too far behind, skip oldest
+	{
+		strmDrops += avail - limit;
+		strmCount = count - limit;
+		avail = limit;
+	}
+
+	while (avail && STRM_BUF - strmLen >= STRM_MAX)
+	{
+		int n = avail < STRM_PAIRS ? avail : STRM_PAIRS;
+		int pos = head - (int)avail;				// oldest unsent pair
+		int len = 0, prev1, prev0;
+		uint16_t drops = strmDrops > 0xFFFF ? 0xFFFF : strmDrops;
+
+		if (pos < 0)
+			pos += MAXBUF;
+
+		f = &strmBuf[strmLen];
+		f[len++] = STRM_SYNC0;
+		f[len++] = STRM_SYNC1;
+		f[len++] = strmSeq;
+		f[len++] = strmSeq >> 8;
+		f[len++] = n;
+		f[len++] = drops;
+		f[len++] = drops >> 8;
+
+		prev1 = cPtr->buf1[pos];
+		prev0 = cPtr->buf0[pos];
+		f[len++] = prev1;
+		f[len++] = prev1 >> 8;
+		f[len++] = prev0;
+		f[len++] = prev0 >> 8;
+
+		for (int i = 1; i < n; i++)
+		{
+			if (++pos >= MAXBUF)
+				pos = 0;
+			len = strmDelta(f, len, cPtr->buf1[pos], prev1);
+			len = strmDelta(f, len, cPtr->buf0[pos], prev0);
+			prev1 = cPtr->buf1[pos];
+			prev0 = cPtr->buf0[pos];
+		}
+
+		uint16_t crc = strmCrc(&f[2], len - 2);
+		f[len++] = crc;
+		f[len++] = crc >> 8;
+		strmLen += len;
+
+		strmSeq++;
+		strmCount += n;
+		avail -= n;
+		strmDropTot += strmDrops;
+		strmDrops = 0;
+	}
+	strmDrain();
+	// link busy - pairs left in cyclic buffer, dropped next time if getADC() gets too far ahead
+}
+
+/*------------------------------ strmDrain() -------------------------------------------------
+sends staged frame bytes, as much as USB takes. rest next time
+*/
+void strmDrain()
+{
+	while (strmOff < strmLen)
+	{
+		int n = strmLen - strmOff;
+		int room = Serial.availableForWrite();
+
+		if (room <= 0)
+			return;										// link busy
+		if (n > room)
+			n = room;
+		Serial.write(&strmBuf[strmOff], n);
+		strmOff += n;
+	}
+	strmLen = strmOff = 0;
+}
+
+/*------------------------------ strmDelta() -------------------------------------------------
+adds delta from prev to f[len], escaped raw value if too big
+Returns: new length
+*/
+int strmDelta(uint8_t* f, int len, int curr, int prev)
+{
+	int d = curr - prev;
+
+	if (d >= -127 && d <= 127)
+		f[len++] = (uint8_t)(int8_t)d;
+	else
+	{
+		f[len++] = STRM_ESC;
+		f[len++] = curr;
+		f[len++] = curr >> 8;
+	}
+	return len;
+}
+
+/*------------------------------ strmCrc() -------------------------------------------------
+CRC-16/CCITT, 0x1021, init 0xFFFF
+*/
+uint16_t strmCrc(const uint8_t* buff, int n)
+{
+	return crcAdd(0xFFFF, buff, n);
+}
+
+/*------------------------------ crcAdd() -------------------------------------------------
+CRC-16/CCITT, 0x1021, continues crc. nibble table
+*/
+uint16_t crcAdd(uint16_t crc, const uint8_t* buff, int n)
+{
+	static const uint16_t tbl[16] = {
+		0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+		0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF };
+
+	for (int i = 0; i < n; i++)
+	{
+		crc = (crc << 4) ^ tbl[(crc >> 12) ^ (buff[i] >> 4)];
+		crc = (crc << 4) ^ tbl[(crc >> 12) ^ (buff[i] & 0x0F)];
+	}
+	return crc;
+}
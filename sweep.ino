@@ -0,0 +1,257 @@
+/*---------------------------------------------------------
+  POWERMETER III + ICOM 7300 CONTROLLER
+   Copyright 2018-2020  Roger Mawhinney, GI8GZM.
+  No publication with acknowledgement to author
+*/
+
+/*
+SWR vs frequency sweep of current band. long touch on SWR meter, touch graph to exit
+transmit a low power carrier during the sweep, points with no carrier are not plotted.
+radio is stepped with CI-V freq writes, frequency isn't read back.
+pipelined: next point freq write is queued so its frame is on the bus while the current
+point finishes averaging. sweep time per point ~ SWEEP_SETTLE + averaging window + one frame.
+*/
+
+/*------------------------------ sweepStart() -------------------------------------------------
+starts sweep of current band, replaces meters and civ frames with sweepGraph
+*/
+void sweepStart()
+{
+	uint32_t f = getFreq();
+	int b = getBand(f);
+
+	if (!isCivEnable || b < 0 || sweepState == SWEEP_TUNE || sweepState == SWEEP_WAIT)
+		return;											// radio freq and band needed
+
+	sweepBand = b;
+	sweepFreq = f;
+	sweepN = 0;
+	memset(sweepSwr, 0, sizeof(sweepSwr));
+
+	for (int i = tuner; i <= freq; i++)					// graph area
+		eraseFrame(i);
+	eraseFrame(nettPwrMeter);
+	eraseFrame(swrMeter);
+	sprintf(lab[sweepGraph].txt, "SWR Sweep  %d Mtrs", hfBand[b].mtrs);
+	restoreFrame(sweepGraph);
+	sweepAxes();
+
+	isSweepNext = sweepQueue(0);
+	sweepTime = millis();
+	sweepState = SWEEP_TUNE;
+}
+
+/*------------------------------ sweepStop() -------------------------------------------------
+stops sweep in progress, radio back to freq before sweep
+*/
+void sweepStop()
+{
+	if (sweepState == SWEEP_TUNE || sweepState == SWEEP_WAIT)
+		sweepRestore();
+	sweepState = SWEEP_OFF;
+}
+
+/*------------------------------ sweepRun() -------------------------------------------------
+one sweep step, doesn't wait for radio
+SWEEP_TUNE: freq write for point queued, wait for echo
+SWEEP_WAIT: settle and averaging window. next point write queued one frame before point is read
+Called by: sweep task
+*/
+void sweepRun()
+{
+	unsigned long now = millis();
+
+	switch (sweepState)
+	{
+	case SWEEP_TUNE:
+		if (!isSweepNext)								// civ queue was full, try again
+		{
+			isSweepNext = sweepQueue(sweepN);
+			sweepTime = now;
+		}
+		else if (civWrites != sweepWrites)				// radio has new freq
+		{
+			isSweepNext = false;
+			sweepTime = now + SWEEP_SETTLE + sweepWinMs();
+			sweepState = SWEEP_WAIT;
+		}
+		else if (now - sweepTime > SWEEP_TIMEOUT)		// no echo, radio off or bus fault
+		{
+			sweepRestore();
+			sweepText("No radio");
+			sweepState = SWEEP_DONE;
+		}
+		break;
+
+	case SWEEP_WAIT:
+		// next write, frame ends on bus as this point is read
+		if (!isSweepNext && sweepN + 1 < SWEEP_POINTS && (long)(now + sweepFrameMs() - sweepTime) >= 0)
+			isSweepNext = sweepQueue(sweepN + 1);
+		if ((long)(now - sweepTime) < 0)
+			break;
+
+		if (measPwr > PWR_THRESHOLD)					// carrier, record swr
+			sweepSwr[sweepN] = constrain(measSwr * 100 + 0.5, 100, 65535);
+		sweepPlot(sweepN);
+
+		if (++sweepN < SWEEP_POINTS)
+		{
+			sweepTime = now;							// tune timeout from here
+			sweepState = SWEEP_TUNE;
+			break;
+		}
+		sweepRestore();
+		sweepResult();
+		sweepState = SWEEP_DONE;						// graph stays until touched
+		break;
+
+	default:
+		break;
+	}
+}
+
+/*------------------------------ sweepQueue() -------------------------------------------------
+queues freq write for point i
+Returns: true if queued, false if civ queue full
+*/
+bool sweepQueue(int i)
+{
+	freqband* bPtr = &hfBand[sweepBand];
+
+	encodeFreq(civWriteFreq, bPtr->bandStart + (bPtr->bandEnd - bPtr->bandStart) * i / (SWEEP_POINTS - 1));
+	if (!civWrite(civWriteFreq))
+		return false;
+	sweepWrites = civWrites;							// changes when write echo received
+	return true;
+}
+
+/*------------------------------ sweepRestore() -------------------------------------------------
+radio back to freq before sweep
+*/
+void sweepRestore()
+{
+	encodeFreq(civWriteFreq, sweepFreq);
+	civWriteBack(civWriteFreq, CIV_FREQ);				// read back
+}
+
+/*------------------------------ sweepWinMs() -------------------------------------------------
+Returns: averaging window (mSecs), plus one measure() pass
+samples params count SAMPLE_INTERVAL samples in both modes, same window time
+*/
+unsigned long sweepWinMs()
+{
+	return samplesAvg * (unsigned long)SAMPLE_INTERVAL / 1000 + 3;
+}
+
+/*------------------------------ sweepFrameMs() -------------------------------------------------
+Returns: bus time (mSecs) for freq write frame, preamble to 0xFD
+*/
+unsigned long sweepFrameMs()
+{
+	return (sizeof(civWritePreamble) + sizeof(civWriteFreq)) * 10 * 1000UL / CIV_BAUD;
+}
+
+/*------------------------------ sweepAxes() -------------------------------------------------
+SWR grid lines 1.5, 2, 3 and band edge freqs
+*/
+void sweepAxes()
+{
+	const frame* fPtr = &fr[sweepGraph];
+	const float grid[] = { 1.5, 2, 3 };
+	int x = fPtr->x + 25, w = fPtr->w - 35;
+
+	tft.setFont(Arial_8);
+	tft.setTextColor(FG_COLOUR);
+	for (int i = 0; i < 3; i++)
+	{
+		int y = sweepY(grid[i] * 100);
+		tft.drawFastHLine(x, y, w, LINE_COLOUR);
+		tft.setCursor(fPtr->x + GAP, y - 3);
+		tft.print(grid[i], 1);
+	}
+
+	tft.setCursor(x, fPtr->y + fPtr->h - 12);
+	tft.print(hfBand[sweepBand].bandStart / 1000000.0, 3);
+	tft.setCursor(x + w - 30, fPtr->y + fPtr->h - 12);
+	tft.print(hfBand[sweepBand].bandEnd / 1000000.0, 3);
+}
+
+/*------------------------------ sweepPlot() -------------------------------------------------
+draws point i, joined to previous point if both have carrier
+*/
+void sweepPlot(int i)
+{
+	int s = sweepSwr[i];
+	int x = sweepX(i), y = sweepY(s);
+	int colour = GREEN;
+
+	if (!s)
+		return;
+	if (s > 150)
+		colour = YELLOW;
+	if (s > 200)
+		colour = ORANGE;
+	if (s > 300)
+		colour = RED;
+
+	if (i > 0 && sweepSwr[i - 1])
+		tft.drawLine(sweepX(i - 1), sweepY(sweepSwr[i - 1]), x, y, colour);
+	else
+		tft.drawPixel(x, y, colour);
+}
+
+/*------------------------------ sweepResult() -------------------------------------------------
+lowest SWR and its freq, under graph
+*/
+void sweepResult()
+{
+	freqband* bPtr = &hfBand[sweepBand];
+	char txt[30];
+	int best = -1;
+
+	for (int i = 0; i < SWEEP_POINTS; i++)
+		if (sweepSwr[i] && (best < 0 || sweepSwr[i] < sweepSwr[best]))
+			best = i;
+
+	if (best < 0)
+	{
+		sweepText("No carrier");
+		return;
+	}
+	uint32_t f = bPtr->bandStart + (bPtr->bandEnd - bPtr->bandStart) * best / (SWEEP_POINTS - 1);
+	sprintf(txt, "Min %d.%02d @ %lu kHz", sweepSwr[best] / 100, sweepSwr[best] % 100, (unsigned long)((f + 500) / 1000));
+	sweepText(txt);
+	tft.drawFastVLine(sweepX(best), fr[sweepGraph].y + 20, fr[sweepGraph].h - 35, CIV_COLOUR);
+}
+
+/*------------------------------ sweepText() -------------------------------------------------
+text centred under graph
+*/
+void sweepText(const char* txt)
+{
+	const frame* fPtr = &fr[sweepGraph];
+
+	tft.setFont(Arial_8);
+	tft.setTextColor(CIV_COLOUR);
+	tft.setCursor(fPtr->x + (fPtr->w - tft.strPixelLen(txt)) / 2, fPtr->y + fPtr->h - 12);
+	tft.print(txt);
+}
+
+/*------------------------------ sweepX(), sweepY() -------------------------------------------------
+graph co-ords for point i, SWR x 100. SWR over SWEEP_SWR_MAX at top
+*/
+int sweepX(int i)
+{
+	const frame* fPtr = &fr[sweepGraph];
+
+	return fPtr->x + 25 + i * (fPtr->w - 36) / (SWEEP_POINTS - 1);
+}
+
+int sweepY(int s)
+{
+	const frame* fPtr = &fr[sweepGraph];
+	int top = fPtr->y + 20, bottom = fPtr->y + fPtr->h - 16;
+
+	s = constrain(s, 100, SWEEP_SWR_MAX * 100);
+	return bottom - (s - 100) * (bottom - top) / (SWEEP_SWR_MAX * 100 - 100);
+}
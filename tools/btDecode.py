@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""
+PowerMeter III bluetooth telemetry decoder, see blueTooth.ino for the frame format.
+
+  btDecode.py /dev/rfcomm0 -s 60                     print values for 60 secs
+  btDecode.py /dev/rfcomm0 --sub nett,swr,freq --rate nett=100
+  btDecode.py capture.bin                            decode a saved capture
+
+Reports frames, CRC errors, sequence gaps and link bytes/sec against the 9600 baud
+budget (960 bytes/sec).
+"""
+import argparse, os, subprocess, time
+
+SYNC, VALUES, CMD_SUB, CMD_RATE, CMD_SNAP = 0xA5, 0x01, 0x10, 0x11, 0x12
+FIELDS = ['nett', 'peak', 'swr', 'dbm', 'freq', 'tuner', 'rms', 'crest']
+SCALE = {'nett': ('W', 1000), 'peak': ('W', 1000), 'swr': ('', 100), 'dbm': ('dBm', 10),
+         'freq': ('MHz', 1000000), 'tuner': ('', 1), 'rms': ('W', 1000), 'crest': ('', 100)}
+LINK_BYTES = 960
+
+
+def crc8(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def frame(ftype, payload):
+    body = bytes([ftype, len(payload)]) + bytes(payload)
+    return bytes([SYNC]) + body + bytes([crc8(body)])
+
+
+def varint(buf, i):
+    z = shift = 0
+    while True:
+        b = buf[i]
+        z |= (b & 0x7F) << shift
+        i += 1
+        shift += 7
+        if not b & 0x80:
+            return (z >> 1) ^ -(z & 1), i
+
+
+class Decoder:
+    def __init__(self):
+        self.buf = bytearray()
+        self.frames = self.crc = self.gaps = 0
+        self.seq = None
+
+    def feed(self, data):
+        """yield (seq, {field: value}) for each good values frame"""
+        self.buf += data
+        while True:
+            i = self.buf.find(bytes([SYNC]))
+            if i < 0:
+                self.buf.clear()
+                return
+            del self.buf[:i]
+            if len(self.buf) < 3 or len(self.buf) < self.buf[2] + 4:
+                return
+            n = self.buf[2]
+            f = bytes(self.buf[:n + 4])
+            if f[1] != VALUES or n < 1 or crc8(f[1:n + 3]) != f[n + 3]:
+                self.crc += 1
+                del self.buf[:1]
+                continue
+            del self.buf[:n + 4]
+            seq, vals, j = f[3], {}, 4
+            try:
+                while j < n + 3:
+                    fld = f[j]
+                    vals[FIELDS[fld] if fld < len(FIELDS) else fld], j = varint(f, j + 1)
+            except IndexError:
+                self.crc += 1
+                continue
+            if self.seq is not None and seq != (self.seq + 1) & 0xFF:
+                self.gaps += 1
+            self.seq = seq
+            self.frames += 1
+            yield seq, vals
+
+
+def show(vals):
+    out = []
+    for k, v in vals.items():
+        unit, div = SCALE.get(k, ('', 1))
+        out.append('%s %g%s' % (k, v / div, unit))
+    return '  '.join(out)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('src', help='bluetooth serial device or capture file')
+    ap.add_argument('-s', '--secs', type=float, default=10.0)
+    ap.add_argument('--sub', help='fields to subscribe, comma separated: ' + ','.join(FIELDS))
+    ap.add_argument('--rate', action='append', default=[], help='field=mSecs interval')
+    ap.add_argument('-q', '--quiet', action='store_true', help='totals only')
+    a = ap.parse_args()
+    dec = Decoder()
+
+    if not a.src.startswith('/dev/'):
+        data = open(a.src, 'rb').read()
+        for _, vals in dec.feed(data):
+            if not a.quiet:
+                print(show(vals))
+        print('frames %d  crc errors %d  seq gaps %d  bytes %d' % (dec.frames, dec.crc, dec.gaps, len(data)))
+        return
+
+    subprocess.run(['stty', '-F', a.src, '9600', 'raw', '-echo'], check=False)
+    fd = os.open(a.src, os.O_RDWR | os.O_NOCTTY)
+    if a.sub:
+        mask = sum(1 << FIELDS.index(f) for f in a.sub.split(','))
+        os.write(fd, frame(CMD_SUB, [mask]))
+    for r in a.rate:
+        fld, ms = r.split('=')
+        ms = int(ms)
+        os.write(fd, frame(CMD_RATE, [FIELDS.index(fld), ms & 0xFF, ms >> 8]))
+    os.write(fd, frame(CMD_SNAP, []))
+
+    total, start = 0, time.time()
+    while time.time() - start < a.secs:
+        data = os.read(fd, 256)
+        total += len(data)
+        for seq, vals in dec.feed(data):
+            if not a.quiet:
+                print('%3d  %s' % (seq, show(vals)))
+    os.close(fd)
+    secs = time.time() - start
+    print('frames %d  crc errors %d  seq gaps %d  %.0f bytes/s (%.0f%% of 9600 baud)'
+          % (dec.frames, dec.crc, dec.gaps, total / secs, 100.0 * total / secs / LINK_BYTES))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,246 @@
+/*
+simulated IC-7300 on the CI-V bus, host build
+shared single wire bus: every byte the controller sends comes back as an echo, radio frames
+are serialized with it. 19200 baud 8N1, one byte 521 uSecs. radio replies after replyUs.
+answers 0x03 freq, 0x04 mode, 0x1C 0x01 tuner, 0x27 0x19 0x00 ref, 0x14 0x0A rf power,
+writes 0x00 / 0x05 freq, 0x1C 0x01 0x02 tune, ref, rf power. OK (0xFB) for writes except 0x00.
+dial() changes freq at the radio and sends a transceive frame. a freq write retunes the radio when
+its 0xFD is off the bus, freqNow() is the freq then.
+faults, from a seeded generator so a run repeats: reply jitter, collisions (0xFC jam in place of
+the end of a controller frame, command lost), bytes lost on the bus.
+*/
+#pragma once
+
+struct civSim
+{
+	HardwareSerial* port = &Serial1;
+	uint64_t byteNs = 10 * 1000000000ULL / CIV_BAUD;
+	uint64_t replyUs = 5000;					// frame end to first reply byte
+	uint64_t tuneMs = 2500;						// tuner status 2 while tuning
+	uint64_t busFree = 0;						// bus idle from (nSecs)
+
+	// radio state
+	uint32_t freq = 14074000;					// Hz, freqNow() for writes on the bus
+	uint32_t freqNext = 0;						// freq write received, radio retunes at freqAt
+	uint64_t freqAt = 0;
+	uint8_t mode = 0x01, filter = 0x01;			// USB, FIL1
+	int tuner = 1;								// 0 off, 1 on
+	uint64_t tuneEnd = 0;						// tuning until (nSecs)
+	int ref = 0;								// spectrum ref, 0.5 dB steps x 10
+	int txPwr = 128;							// 0 - 255
+	bool isOn = true;							// false = radio off, no echo or replies
+
+	// faults
+	uint32_t seed = 1;
+	uint64_t jitterUs = 0;						// reply delay replyUs to replyUs + jitterUs
+	int collidePm = 0;							// controller frames jammed, per 1000
+	int dropPm = 0;								// bytes lost, per 1000. echo and replies
+	uint32_t collisions = 0, drops = 0;
+
+	// counters
+	uint32_t busBytes = 0;						// all bytes on bus
+	uint32_t cmds = 0, reads = 0, writes = 0, freqWrites = 0;
+
+	std::vector<uint8_t> frame;					// controller frame being sent
+
+	void attach()
+	{
+		port->onTx = [this](uint8_t c) { tx(c); };
+	}
+
+	uint32_t rnd()
+	{
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		return seed;
+	}
+
+	// radio freq now, freq write applied once its frame is off the bus
+	uint32_t freqNow()
+	{
+		if (freqAt && hostNs >= freqAt)
+		{
+			freq = freqNext;
+			freqAt = 0;
+		}
+		return freq;
+	}
+
+	bool chance(int pm)
+	{
+		return pm && (int)(rnd() % 1000) < pm;
+	}
+
+	// one byte onto the bus, arrives at port when sent
+	uint64_t bus(uint8_t c, uint64_t at)
+	{
+		uint64_t start = std::max(at, busFree);
+
+		busFree = start + byteNs;
+		busBytes++;
+		if (chance(dropPm))
+			drops++;							// bus time used, byte not received
+		else
+			port->in(&c, 1, busFree);
+		return busFree;
+	}
+
+	void send(const std::vector<uint8_t>& f, uint64_t at)
+	{
+		for (uint8_t c : f)
+			at = bus(c, at);
+	}
+
+	// controller wrote c
+	void tx(uint8_t c)
+	{
+		if (!isOn)
+			return;
+		if (c == 0xFD && chance(collidePm))
+		{
+			bus(0xFC, hostNs);					// jam, frame not received by radio
+			collisions++;
+			frame.clear();
+			return;
+		}
+		uint64_t end = bus(c, hostNs);			// echo
+		frame.push_back(c);
+		if (c == 0xFD)
+		{
+			command(frame, end);
+			frame.clear();
+		}
+		else if (frame.size() > CIV_BUFF)
+			frame.clear();
+	}
+
+	static void bcd(std::vector<uint8_t>& f, uint32_t v, int bytes, bool isLsbFirst)
+	{
+		uint8_t b[5];
+
+		for (int i = 0; i < bytes; i++, v /= 100)
+			b[i] = ((v / 10) % 10) << 4 | (v % 10);
+		for (int i = 0; i < bytes; i++)
+			f.push_back(b[isLsbFirst ? i : bytes - 1 - i]);
+	}
+
+	static uint32_t unbcd(const uint8_t* p, int bytes, bool isLsbFirst)
+	{
+		uint32_t v = 0;
+
+		for (int i = 0; i < bytes; i++)
+		{
+			uint8_t b = p[isLsbFirst ? bytes - 1 - i : i];
+			v = v * 100 + (b >> 4) * 10 + (b & 0x0F);
+		}
+		return v;
+	}
+
+	int tunerNow()
+	{
+		return hostNs < tuneEnd ? 2 : tuner;
+	}
+
+	void command(const std::vector<uint8_t>& f, uint64_t end)
+	{
+		std::vector<uint8_t> r = { 0xFE, 0xFE, CIVADDR, CIVRADIO };
+		size_t n = f.size();
+		bool isOk = false;
+
+		if (n < 6 || f[0] != 0xFE || f[1] != 0xFE || f[2] != CIVRADIO || f[3] != CIVADDR)
+			return;								// not for the radio
+		cmds++;
+		const uint8_t* d = &f[4];
+		size_t nd = n - 5;						// command and data, without 0xFD
+
+		if (d[0] == 0x03 && nd == 1)
+		{
+			r.push_back(0x03);
+			bcd(r, freqNow(), 5, true);
+			reads++;
+		}
+		else if (d[0] == 0x04 && nd == 1)
+		{
+			r.insert(r.end(), { 0x04, mode, filter });
+			reads++;
+		}
+		else if ((d[0] == 0x00 || d[0] == 0x05) && nd == 6)
+		{
+			freqNow();							// earlier write done
+			freqNext = unbcd(&d[1], 5, true);
+			freqAt = end;
+			freqWrites++;
+			writes++;
+			if (d[0] == 0x00)
+				return;							// transceive form, no reply
+			isOk = true;
+		}
+		else if (d[0] == 0x1C && nd >= 2 && d[1] == 0x01)
+		{
+			if (nd == 2)
+			{
+				r.insert(r.end(), { 0x1C, 0x01, (uint8_t)tunerNow() });
+				reads++;
+			}
+			else
+			{
+				if (d[2] == 0x02)
+					tuneEnd = end + tuneMs * 1000000ULL;
+				else
+					tuner = d[2];
+				writes++;
+				isOk = true;
+			}
+		}
+		else if (d[0] == 0x27 && nd >= 3 && d[1] == 0x19 && d[2] == 0x00)
+		{
+			if (nd == 3)
+			{
+				r.insert(r.end(), { 0x27, 0x19, 0x00 });
+				bcd(r, abs(ref), 2, false);
+				r.push_back(ref < 0);
+				reads++;
+			}
+			else
+			{
+				ref = unbcd(&d[3], 2, false) * (nd > 5 && d[5] ? -1 : 1);
+				writes++;
+				isOk = true;
+			}
+		}
+		else if (d[0] == 0x14 && nd >= 2 && d[1] == 0x0A)
+		{
+			if (nd == 2)
+			{
+				r.insert(r.end(), { 0x14, 0x0A });
+				bcd(r, txPwr, 2, false);
+				reads++;
+			}
+			else
+			{
+				txPwr = unbcd(&d[2], 2, false);
+				writes++;
+				isOk = true;
+			}
+		}
+		else
+			r.push_back(0xFA);					// NG
+		if (isOk)
+			r.push_back(0xFB);
+		r.push_back(0xFD);
+		send(r, end + (replyUs + (jitterUs ? rnd() % jitterUs : 0)) * 1000);
+	}
+
+	// VFO turned at the radio, transceive frame to all
+	void dial(uint32_t f)
+	{
+		std::vector<uint8_t> r = { 0xFE, 0xFE, 0x00, CIVRADIO, 0x00 };
+
+		freq = f;
+		freqAt = 0;
+		bcd(r, f, 5, true);
+		r.push_back(0xFD);
+		send(r, hostNs);
+	}
+};
@@ -0,0 +1,157 @@
+/*
+host build test support. included after the sketch, so tests see every sketch global
+TEST() cases run in their own process (fork) from power on state, BENCH() the same but only
+with 'pmhost bench'. TOOL() runs in the pmhost process with the rest of the command line.
+*/
+#pragma once
+#include <chrono>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "civSim.h"
+
+#define HOST_TEST   0
+#define HOST_BENCH  1
+#define HOST_TOOL   2
+
+struct hostCase
+{
+	const char* name;
+	void (*fn)();
+	int kind;
+};
+
+static std::vector<hostCase>& hostCases()
+{
+	static std::vector<hostCase> cases;
+	return cases;
+}
+
+struct hostReg
+{
+	hostReg(const char* name, void (*fn)(), int kind) { hostCases().push_back({ name, fn, kind }); }
+};
+
+#define HOST_CASE(name, kind) static void name(); static hostReg name##Reg(#name, name, kind); static void name()
+#define TEST(name)  HOST_CASE(name, HOST_TEST)
+#define BENCH(name) HOST_CASE(name, HOST_BENCH)
+#define TOOL(name)  HOST_CASE(name, HOST_TOOL)
+
+static std::vector<std::string> hostArgs;		// TOOL() arguments
+
+#define CHECK(c) do { if (!(c)) hostFail(__FILE__, __LINE__, #c, ""); } while (0)
+#define CHECK_EQ(a, b) do { long long a_ = (long long)(a), b_ = (long long)(b); \
+	if (a_ != b_) hostFail(__FILE__, __LINE__, #a " == " #b, (std::to_string(a_) + " != " + std::to_string(b_)).c_str()); } while (0)
+#define CHECK_NEAR(a, b, tol) do { double a_ = (a), b_ = (b); \
+	if (fabs(a_ - b_) > (tol)) hostFail(__FILE__, __LINE__, #a " ~ " #b, (std::to_string(a_) + " vs " + std::to_string(b_)).c_str()); } while (0)
+
+static void hostFail(const char* file, int line, const char* what, const char* vals)
+{
+	fprintf(stderr, "%s:%d: CHECK(%s) failed %s\n", file, line, what, vals);
+	fflush(stdout);
+	_exit(1);
+}
+
+/*------------------------------ sketch control -------------------------------------------------
+*/
+static civSim radio;							// IC-7300 on Serial1
+static uint32_t hostLoopNs = 5000;				// one loop() pass without a task, schedRun() scan
+static std::function<int(int pin, uint64_t ns)> hostAdcFn;
+
+static int hostAdcCall(int pin, uint64_t ns)
+{
+	return hostAdcFn ? hostAdcFn(pin, ns) : 0;
+}
+
+// steady carrier on CH_MAIN, ADC codes
+static void hostCarrier(int fwd, int ref)
+{
+	hostAdcFn = [fwd, ref](int pin, uint64_t) {
+		return pin == chan[CH_MAIN].fwdPin ? fwd : (pin == chan[CH_MAIN].refPin ? ref : 0);
+	};
+}
+
+// power on. isRadio: IC-7300 answers on the CI-V bus
+static void hostBoot(bool isRadio = true)
+{
+	hostAdcSource = hostAdcCall;
+	if (isRadio)
+		radio.attach();
+	setup();
+}
+
+// run loop() for ms of virtual time
+static void hostRun(uint64_t ms)
+{
+	uint64_t end = hostNs + ms * 1000000ULL;
+
+	while (hostNs < end)
+	{
+		loop();
+		hostTick(hostLoopNs);
+	}
+}
+
+// run loop() until done() or ms of virtual time. Returns: true if done
+static bool hostRunUntil(std::function<bool()> done, uint64_t ms)
+{
+	uint64_t end = hostNs + ms * 1000000ULL;
+
+	while (hostNs < end)
+	{
+		if (done())
+			return true;
+		loop();
+		hostTick(hostLoopNs);
+	}
+	return done();
+}
+
+// touch screen at x, y (display co-ords) for ms, from now
+static void hostTouch(int x, int y, uint64_t ms)
+{
+	hostPress p;
+
+	p.startNs = hostNs;
+	p.endNs = hostNs + ms * 1000000ULL;
+	p.x = xMapL + (long)x * (xMapR - xMapL) / 320;	// inverse of MAPX, MAPY
+	p.y = yMapT + (long)y * (yMapB - yMapT) / 240;
+	ts.presses.push_back(p);
+}
+
+// centre of frame i
+static void hostTouchFrame(int i, uint64_t ms)
+{
+	hostTouch(fr[i].x + fr[i].w / 2, fr[i].y + fr[i].h / 2, ms);
+}
+
+static uint64_t hostMs()
+{
+	return hostNs / 1000000;
+}
+
+// USB serial text since from
+static std::string hostUsb(size_t from = 0)
+{
+	return std::string(Serial.tx.begin() + std::min(from, Serial.tx.size()), Serial.tx.end());
+}
+
+// scheduler entry for task fn
+static task* hostTask(void (*fn)())
+{
+	for (int i = 0; i < NUM_TASKS; i++)
+		if (tasks[i].fn == fn)
+			return &tasks[i];
+	return NULL;
+}
+
+// USB command, as typed
+static void hostCmd(const char* s)
+{
+	Serial.in(s);
+}
+
+static double hostWall()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
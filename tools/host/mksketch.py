@@ -0,0 +1,45 @@
+#!/usr/bin/env python3
+"""
+sketch as one C++ file for the host build, the way the Arduino builder does it:
+main .ino (the one with setup()) first, then the other tabs in name order, prototypes for every function
+after the last #include of the main tab.
+
+  mksketch.py <sketch dir> <out.cpp>
+"""
+import os, re, sys
+
+PROTO = re.compile(r'^([A-Za-z_][\w\s\*&:<>]*?[\s\*&])([A-Za-z_]\w*)\s*\(([^;{}]*)\)\s*(//.*)?$')
+SKIP = ('return', 'else', 'do', 'static_assert')
+
+
+def opens(lines, i):
+    """function body follows line i, comment lines between"""
+    j = i + 1
+    while j < len(lines) and lines[j].strip().startswith('//'):
+        j += 1
+    return j < len(lines) and lines[j].strip().startswith('{')
+
+
+def main(src, out):
+    inos = [f for f in os.listdir(src) if f.endswith('.ino')]
+    main = [f for f in inos if 'void setup()' in open(os.path.join(src, f), encoding='latin-1').read()]
+    tabs = main + sorted(f for f in inos if f not in main)
+    body, protos = [], []
+    for f in tabs:
+        lines = open(os.path.join(src, f), encoding='latin-1').read().split('\n')
+        for i, l in enumerate(lines):
+            m = PROTO.match(l)
+            if m and m.group(1).strip() not in SKIP and not l.startswith(SKIP) and opens(lines, i):
+                protos.append(m.group(1) + m.group(2) + '(' + m.group(3) + ');')
+        body.append('#line 1 "%s"\n' % os.path.join(os.path.abspath(src), f) + '\n'.join(lines) + '\n')
+    text = ''.join(body)
+    head = text[:text.index('void setup()')]
+    last = [m.end() for m in re.finditer(r'^#include .*$', head, re.M)][-1]
+    n = text[:last].count('\n')              # #line, then main tab lines to the last #include
+    text = (text[:last + 1] + '\n'.join(protos) + '\n#line %d "%s"\n' % (n + 1, os.path.join(os.path.abspath(src), tabs[0]))
+            + text[last + 1:])
+    open(out, 'w', encoding='latin-1').write(text)
+
+
+if __name__ == '__main__':
+    main(sys.argv[1], sys.argv[2])
@@ -0,0 +1,44 @@
+// ADC library stand-in. conversions read hostAdcSource, PDB triggers DMA at the PDB rate
+#pragma once
+#include "Arduino.h"
+
+enum class ADC_CONVERSION_SPEED { VERY_LOW_SPEED, LOW_SPEED, MED_SPEED, HIGH_SPEED, VERY_HIGH_SPEED, HIGH_SPEED_16BITS };
+enum class ADC_SAMPLING_SPEED { VERY_LOW_SPEED, LOW_SPEED, MED_SPEED, HIGH_SPEED, VERY_HIGH_SPEED };
+
+// code for pin at time ns, set by tests. default 0 (no carrier)
+extern int (*hostAdcSource)(int pin, uint64_t ns);
+extern uint32_t hostAdcReads;					// conversions done
+
+struct ADC_Module
+{
+	int num;									// 0 or 1
+	int pin = -1;								// last analogRead(), channel for PDB conversions
+	bool isDma = false;
+
+	ADC_Module(int n) : num(n) {}
+	void setAveraging(int) {}
+	void setResolution(int) {}
+	void setConversionSpeed(ADC_CONVERSION_SPEED) {}
+	void setSamplingSpeed(ADC_SAMPLING_SPEED) {}
+	int getMaxValue() { return 4095; }
+	int analogRead(uint8_t p);
+	void enableDMA() { isDma = true; }
+	void disableDMA() { isDma = false; }
+	void startPDB(uint32_t freq);
+	void stopPDB();
+	uint32_t getPDBFrequency();
+};
+
+struct ADC;
+extern ADC* hostAdc;							// the sketch's ADC, pins for PDB conversions
+
+struct ADC
+{
+	struct Sync_result { int32_t result_adc0, result_adc1; };
+
+	ADC_Module* adc0;
+	ADC_Module* adc1;
+
+	ADC() : adc0(new ADC_Module(0)), adc1(new ADC_Module(1)) { hostAdc = this; }
+	Sync_result analogSyncRead(uint8_t pin0, uint8_t pin1);
+};
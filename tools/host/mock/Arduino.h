@@ -0,0 +1,142 @@
+/*
+host build of the PowerMeter III sketch, Teensy core stand-in
+virtual clock, interrupts taken as time advances, serial ports as byte queues
+see tools/host/Readme.md
+*/
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include <functional>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define LED_BUILTIN 13
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+#define A8 22
+#define A9 23
+#define HEX 16
+#define DEC 10
+#define F_CPU 96000000
+#define FASTRUN
+#define PROGMEM
+
+#define constrain(a, l, h) ((a) < (l) ? (l) : ((a) > (h) ? (h) : (a)))
+#define sq(x) ((x) * (x))
+using std::abs;
+using std::min;
+using std::max;
+
+// virtual clock, nSecs since reset. only moves forward in hostTick()
+extern uint64_t hostNs;
+extern uint32_t hostCallNs;						// charged per millis() / micros() call
+void hostTick(uint64_t ns);						// advance clock, run timer, PDB, DMA interrupts due
+void hostSetUs(uint64_t us);					// clock to us if later, interrupts skipped
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int val);
+int digitalRead(int pin);
+void digitalWriteFast(int pin, int val);
+void analogWrite(int pin, int val);
+extern int hostPin[64];							// last digitalWrite / analogWrite per pin
+
+void noInterrupts();
+void interrupts();
+extern bool hostIrqOff;							// noInterrupts() in force
+extern bool hostInIsr;							// timer / DMA interrupt running
+extern uint32_t hostIrqs;						// interrupts run
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+char* dtostrf(double v, signed char width, unsigned char decs, char* buf);
+
+// Print, as Teensy core. write() is the only output
+struct Print
+{
+	virtual size_t write(uint8_t c) = 0;
+	virtual size_t write(const uint8_t* buf, size_t n);
+	size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+	size_t print(const char* s) { return write(s); }
+	size_t print(char c) { return write((uint8_t)c); }
+	size_t print(int n, int base = DEC) { return print((long)n, base); }
+	size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); }
+	size_t print(long n, int base = DEC);
+	size_t print(unsigned long n, int base = DEC);
+	size_t print(double v, int digits = 2);
+	size_t println() { return write("\r\n"); }
+	template<class T> size_t println(T v) { size_t n = print(v); return n + println(); }
+	template<class T> size_t println(T v, int f) { size_t n = print(v, f); return n + println(); }
+	int printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+	virtual ~Print() {}
+};
+
+// serial port. rx bytes arrive at a time, tx captured. txRoom is availableForWrite()
+struct HardwareSerial : Print
+{
+	std::deque<std::pair<uint64_t, uint8_t>> rx;	// arrival nSecs, byte
+	std::vector<uint8_t> tx;					// everything written
+	std::function<void(uint8_t)> onTx;			// CI-V bus simulator, sees each byte written
+	int txRoom = 64;							// USB packet / UART buffer space
+	uint32_t overWrites = 0;					// bytes written past availableForWrite(), would block
+	long baud = 0;
+
+	void begin(long b) { baud = b; }
+	int available();
+	int read();
+	int peek();
+	void flush() {}
+	void clear() { rx.clear(); }
+	int availableForWrite() { return txRoom; }
+	size_t write(uint8_t c) override;
+	size_t write(const uint8_t* buf, size_t n) override;
+	using Print::write;
+	operator bool() { return true; }
+
+	void in(const uint8_t* buf, size_t n, uint64_t atNs);	// queue received bytes
+	void in(const char* s) { in((const uint8_t*)s, strlen(s), hostNs); }
+};
+typedef HardwareSerial usb_serial_class;
+extern HardwareSerial Serial, Serial1, Serial2, Serial3;
+
+// periodic interrupt, begin() / update() / end()
+struct IntervalTimer
+{
+	void (*fn)() = nullptr;
+	uint64_t periodNs = 0, nextNs = 0;
+	bool isRunning = false;
+
+	bool begin(void (*f)(), unsigned int us) { return begin(f, (double)us); }
+	bool begin(void (*f)(), int us) { return begin(f, (double)us); }
+	bool begin(void (*f)(), double us);
+	void update(unsigned int us) { periodNs = us * 1000ULL; }
+	void end();
+	void priority(int) {}
+	IntervalTimer();
+	~IntervalTimer() { end(); }
+};
+extern bool hostTimersOff;						// replay, samples come from the trace
+
+// restart request (CPU_RESTART), thrown to the test
+struct hostRestart {};
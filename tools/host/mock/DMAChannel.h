@@ -0,0 +1,35 @@
+// DMAChannel stand-in. PDB conversions are copied to the destination buffer,
+// interrupt at half and / or completion, as the Kinetis eDMA with a circular buffer
+#pragma once
+#include "Arduino.h"
+
+#define DMAMUX_SOURCE_ADC0 40
+#define DMAMUX_SOURCE_ADC1 41
+extern volatile uint16_t ADC0_RA, ADC1_RA;		// result registers, source() identifies ADC
+
+struct DMAChannel
+{
+	volatile uint16_t* buf = nullptr;
+	unsigned len = 0;							// uint16_t elements
+	unsigned idx = 0;							// next element written
+	int adc = -1;								// source ADC
+	int trigger = -1;
+	bool isHalf = false, isDone = false, isEnabled = false;
+	void (*isr)() = nullptr;
+
+	DMAChannel();
+	void source(volatile const uint16_t& reg) { adc = (&reg == &ADC1_RA) ? 1 : 0; }
+	void destinationBuffer(volatile uint16_t* b, unsigned bytes) { buf = b; len = bytes / 2; idx = 0; }
+	void triggerAtHardwareEvent(uint8_t src) { trigger = src; }
+	void interruptAtHalf() { isHalf = true; }
+	void interruptAtCompletion() { isDone = true; }
+	void attachInterrupt(void (*f)()) { isr = f; }
+	void enable() { isEnabled = true; }
+	void disable() { isEnabled = false; }
+	void clearInterrupt() {}
+	volatile void* destinationAddress() { return (void*)&buf[idx]; }
+	void copy(uint16_t v);						// one triggered transfer
+};
+
+// tests: next n ADC0 transfers lost, dma0 falls behind dma1
+extern int hostDmaDrop;
@@ -0,0 +1,21 @@
+// EEPROM stand-in, 2k bytes erased to 0xFF. writes counted as flash wear
+#pragma once
+#include "Arduino.h"
+
+#define HOST_EE_SIZE 2048
+
+struct EEPROMClass
+{
+	uint8_t mem[HOST_EE_SIZE];
+	uint32_t writes = 0;						// bytes programmed
+	uint32_t powerFail = UINT32_MAX;			// writes after this many are lost, reset mid write
+
+	EEPROMClass() { memset(mem, 0xFF, sizeof(mem)); }
+	uint8_t read(int a) { return mem[a & (HOST_EE_SIZE - 1)]; }
+	void write(int a, uint8_t v) { if (writes < powerFail) mem[a & (HOST_EE_SIZE - 1)] = v; writes++; }
+	void update(int a, uint8_t v) { if (read(a) != v) write(a, v); }
+	template<class T> T& get(int a, T& t) { for (size_t i = 0; i < sizeof(T); i++) ((uint8_t*)&t)[i] = read(a + i); return t; }
+	template<class T> const T& put(int a, const T& t) { for (size_t i = 0; i < sizeof(T); i++) update(a + i, ((const uint8_t*)&t)[i]); return t; }
+	uint16_t length() { return HOST_EE_SIZE; }
+};
+extern EEPROMClass EEPROM;
@@ -0,0 +1,88 @@
+// ILI9341_t3 stand-in. 320x240 frame buffer, packed font decoder as the library,
+// SPI cost model: pixels written and transactions, charged to the virtual clock
+#pragma once
+#include "Arduino.h"
+
+typedef struct {
+	const unsigned char* index;
+	const unsigned char* unicode;
+	const unsigned char* data;
+	unsigned char version;
+	unsigned char reserved;
+	unsigned char index1_first;
+	unsigned char index1_last;
+	unsigned char index2_first;
+	unsigned char index2_last;
+	unsigned char bits_index;
+	unsigned char bits_width;
+	unsigned char bits_height;
+	unsigned char bits_xoffset;
+	unsigned char bits_yoffset;
+	unsigned char bits_delta;
+	unsigned char line_space;
+	unsigned char cap_height;
+} ILI9341_t3_font_t;
+
+#define ILI9341_TFTWIDTH  240
+#define ILI9341_TFTHEIGHT 320
+
+// synthetic font in the library's packed format, chars 32 to 126. size in points
+ILI9341_t3_font_t mockFont(int size, bool isBold);
+
+struct hostTftStats
+{
+	uint64_t pixels;							// pixels written
+	uint32_t calls;								// SPI transactions (one per primitive / glyph run)
+	uint32_t glyphs;							// characters drawn
+};
+extern hostTftStats hostTft;
+extern uint32_t hostPixelNs;					// virtual time per pixel, 16 bits at 30 MHz SPI
+extern uint32_t hostCallNs2;					// per transaction, CS / address window
+
+struct ILI9341_t3 : Print
+{
+	uint16_t fb[240][320];						// rotation 1 / 3 only, as the sketch
+	int16_t _width = 320, _height = 240;
+	int16_t cursor_x = 0, cursor_y = 0;
+	uint16_t textcolor = 0xFFFF, textbgcolor = 0xFFFF;
+	const ILI9341_t3_font_t* font = nullptr;
+	bool wrap = true;
+
+	ILI9341_t3(int, int, int = 255, int = 11, int = 13, int = 12) { memset(fb, 0, sizeof(fb)); }
+	void begin() {}
+	void setRotation(int) {}
+	int16_t width() { return _width; }
+	int16_t height() { return _height; }
+
+	void fillScreen(uint16_t c) { fillRect(0, 0, _width, _height, c); }
+	void fillScreenVGradient(uint16_t c1, uint16_t c2) { fillRectVGradient(0, 0, _width, _height, c1, c2); }
+	void setTextColor(uint16_t c) { textcolor = textbgcolor = c; }
+	void setTextColor(uint16_t c, uint16_t bg) { textcolor = c; textbgcolor = bg; }
+	void setTextWrap(bool w) { wrap = w; }
+	void setFont(const ILI9341_t3_font_t& f) { font = &f; }
+	void setCursor(int16_t x, int16_t y) { cursor_x = x; cursor_y = y; }
+	int16_t getCursorX() { return cursor_x; }
+	int16_t getCursorY() { return cursor_y; }
+	uint16_t strPixelLen(const char* str);
+
+	void drawPixel(int16_t x, int16_t y, uint16_t c);
+	void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t c) { fillRect(x, y, w, 1, c); }
+	void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t c) { fillRect(x, y, 1, h, c); }
+	void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c);
+	void fillRectVGradient(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c1, uint16_t c2);
+	void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c);
+	void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t c);
+	void drawCircle(int16_t x, int16_t y, int16_t r, uint16_t c);
+	void fillCircle(int16_t x, int16_t y, int16_t r, uint16_t c);
+	void drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t c);
+	void fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t c);
+	void writeRect(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t* pcolors);
+	void writeRect1BPP(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t* pixels, const uint16_t* palette);
+	void drawFontChar(unsigned int c);
+	size_t write(uint8_t c) override;
+	using Print::write;
+
+	uint32_t digest();							// FNV-1a of frame buffer
+	void plot(int16_t x, int16_t y, uint16_t c);	// clipped, not counted
+	void cost(uint32_t px);						// one transaction of px pixels
+};
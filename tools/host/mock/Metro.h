@@ -0,0 +1,32 @@
+// Metro library, same semantics. interval 0 is always due
+#pragma once
+#include "Arduino.h"
+
+struct Metro
+{
+	unsigned long previous_millis, interval_millis;
+	bool autoreset;
+
+	Metro(unsigned long i, bool ar = false) : interval_millis(i), autoreset(ar) { reset(); }
+	void interval(unsigned long i) { interval_millis = i; }
+	void reset() { previous_millis = millis(); }
+	bool check()
+	{
+		unsigned long now = millis();
+
+		if (interval_millis == 0)
+		{
+			previous_millis = now;
+			return true;
+		}
+		if (now - previous_millis >= interval_millis)
+		{
+			if (autoreset)
+				previous_millis = now;
+			else
+				previous_millis += interval_millis;
+			return true;
+		}
+		return false;
+	}
+};
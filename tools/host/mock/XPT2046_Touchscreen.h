@@ -0,0 +1,27 @@
+// XPT2046 stand-in, scripted touches. each press is raw x, y held from start to end
+// tirqTouched() is true from power on until touched() finds no touch, as the library
+#pragma once
+#include "Arduino.h"
+
+struct TS_Point
+{
+	int16_t x, y, z;
+	TS_Point(int16_t a = 0, int16_t b = 0, int16_t c = 0) : x(a), y(b), z(c) {}
+};
+
+struct hostPress { uint64_t startNs, endNs; int16_t x, y; };
+
+struct XPT2046_Touchscreen
+{
+	std::vector<hostPress> presses;			// script, in time order
+	uint32_t reads = 0;						// SPI reads
+	bool isrWake = true;					// as the library, set by touch IRQ, cleared by touched()
+
+	XPT2046_Touchscreen(int, int = 255) {}
+	bool begin() { return true; }
+	void setRotation(int) {}
+	bool tirqTouched();
+	bool touched();
+	TS_Point getPoint();
+	const hostPress* now();					// press active at hostNs
+};
@@ -0,0 +1,5 @@
+// font stand-in, synthetic glyphs in the packed format (mockFont)
+#pragma once
+#include "ILI9341_t3.h"
+
+static const ILI9341_t3_font_t Arial_8 = mockFont(8, false);
@@ -0,0 +1,3 @@
+// font stand-in, no faces used by the sketch
+#pragma once
+#include "ILI9341_t3.h"
@@ -0,0 +1,20 @@
+// font stand-in, synthetic glyphs in the packed format (mockFont)
+#pragma once
+#include "ILI9341_t3.h"
+
+static const ILI9341_t3_font_t LiberationSansNarrow_8_Bold = mockFont(8, true);
+static const ILI9341_t3_font_t LiberationSansNarrow_9_Bold = mockFont(9, true);
+static const ILI9341_t3_font_t LiberationSansNarrow_10_Bold = mockFont(10, true);
+static const ILI9341_t3_font_t LiberationSansNarrow_12_Bold = mockFont(12, true);
+static const ILI9341_t3_font_t LiberationSansNarrow_14_Bold = mockFont(14, true);
+static const ILI9341_t3_font_t LiberationSansNarrow_16_Bold = mockFont(16, true);
+static const ILI9341_t3_font_t LiberationSansNarrow_18_Bold = mockFont(18, true);
+static const ILI9341_t3_font_t LiberationSansNarrow_20_Bold = mockFont(20, true);
+static const ILI9341_t3_font_t LiberationSansNarrow_24_Bold = mockFont(24, true);
+static const ILI9341_t3_font_t LiberationSansNarrow_28_Bold = mockFont(28, true);
+static const ILI9341_t3_font_t LiberationSansNarrow_32_Bold = mockFont(32, true);
+static const ILI9341_t3_font_t LiberationSansNarrow_40_Bold = mockFont(40, true);
+static const ILI9341_t3_font_t LiberationSansNarrow_48_Bold = mockFont(48, true);
+static const ILI9341_t3_font_t LiberationSansNarrow_60_Bold = mockFont(60, true);
+static const ILI9341_t3_font_t LiberationSansNarrow_72_Bold = mockFont(72, true);
+static const ILI9341_t3_font_t LiberationSansNarrow_96_Bold = mockFont(96, true);
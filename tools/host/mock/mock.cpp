@@ -0,0 +1,841 @@
+/*
+host build of the PowerMeter III sketch, library stand-ins
+virtual clock: time moves only in hostTick(). millis() / micros() charge hostCallNs, drawing
+charges the SPI cost model, delay() waits. timer, PDB conversions and DMA transfers due are run
+as the clock passes them. interrupt handlers are held while noInterrupts() or another handler
+runs, then taken once (missed timer periods collapse into one, as the hardware)
+*/
+#include "Arduino.h"
+#include "ADC.h"
+#include "DMAChannel.h"
+#include "EEPROM.h"
+#include "ILI9341_t3.h"
+#include "XPT2046_Touchscreen.h"
+
+uint64_t hostNs;
+uint32_t hostCallNs = 50;
+bool hostIrqOff, hostInIsr, hostTimersOff;
+uint32_t hostIrqs;
+int hostPin[64];
+
+HardwareSerial Serial, Serial1, Serial2, Serial3;
+EEPROMClass EEPROM;
+volatile uint16_t ADC0_RA, ADC1_RA;
+int (*hostAdcSource)(int pin, uint64_t ns);
+uint32_t hostAdcReads;
+int hostDmaDrop;
+hostTftStats hostTft;
+uint32_t hostPixelNs = 533;
+uint32_t hostCallNs2 = 1000;
+
+// registered by constructors of sketch globals, constructed on first use
+static std::vector<IntervalTimer*>& timerList() { static std::vector<IntervalTimer*> v; return v; }
+static std::vector<DMAChannel*>& dmaList() { static std::vector<DMAChannel*> v; return v; }
+static std::vector<void (*)()> pending;				// interrupt handlers held
+
+// PDB, triggers both ADCs together
+static struct { uint64_t periodNs, nextNs; bool isOn; } pdb;
+
+/*------------------------------ clock, interrupts -------------------------------------------------
+*/
+static void irq(void (*fn)())
+{
+	if (hostIrqOff || hostInIsr)
+	{
+		if (std::find(pending.begin(), pending.end(), fn) == pending.end())
+			pending.push_back(fn);						// one pending per source
+		return;
+	}
+	hostInIsr = true;
+	hostIrqs++;
+	fn();
+	hostInIsr = false;
+}
+
+static void irqPending()
+{
+	while (!pending.empty() && !hostIrqOff && !hostInIsr)
+	{
+		void (*fn)() = pending.front();
+		pending.erase(pending.begin());
+		irq(fn);
+	}
+}
+
+static int adcRead(int pin)
+{
+	hostAdcReads++;
+	return hostAdcSource ? constrain(hostAdcSource(pin, hostNs), 0, 4095) : 0;
+}
+
+ADC* hostAdc;											// the sketch's ADC, pins for PDB conversions
+
+void hostTick(uint64_t ns)
+{
+	uint64_t end = hostNs + ns;
+
+	irqPending();
+	for (;;)
+	{
+		IntervalTimer* tPtr = nullptr;
+		uint64_t t = end;
+		bool isPdb = false;
+
+		if (!hostTimersOff)
+		{
+			for (IntervalTimer* p : timerList())
+				if (p->isRunning && p->nextNs <= t)
+				{
+					t = p->nextNs;
+					tPtr = p;
+				}
+			if (pdb.isOn && pdb.nextNs <= t)
+			{
+				t = pdb.nextNs;
+				tPtr = nullptr;
+				isPdb = true;
+			}
+		}
+		if (!tPtr && !isPdb)
+			break;
+		if (t > hostNs)
+			hostNs = t;
+
+		if (isPdb)
+		{
+			pdb.nextNs += pdb.periodNs;
+			ADC0_RA = adcRead(hostAdc ? hostAdc->adc0->pin : -1);	// both ADCs triggered together
+			ADC1_RA = adcRead(hostAdc ? hostAdc->adc1->pin : -1);
+			for (DMAChannel* d : dmaList())
+				if (d->isEnabled && d->adc == 0)
+					d->copy(ADC0_RA);
+			for (DMAChannel* d : dmaList())
+				if (d->isEnabled && d->adc == 1)
+					d->copy(ADC1_RA);
+		}
+		else
+		{
+			tPtr->nextNs += tPtr->periodNs;
+			if (tPtr->nextNs <= hostNs)					// missed periods, one interrupt
+				tPtr->nextNs = hostNs + tPtr->periodNs;
+			irq(tPtr->fn);
+		}
+	}
+	hostNs = end;
+	irqPending();
+}
+
+void hostSetUs(uint64_t us)
+{
+	if (us * 1000 > hostNs)
+		hostNs = us * 1000;
+}
+
+unsigned long millis()
+{
+	hostTick(hostCallNs);
+	return hostNs / 1000000;
+}
+
+unsigned long micros()
+{
+	hostTick(hostCallNs);
+	return hostNs / 1000;
+}
+
+void delay(unsigned long ms)
+{
+	hostTick(ms * 1000000ULL);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+	hostTick(us * 1000ULL);
+}
+
+void noInterrupts()
+{
+	hostIrqOff = true;
+}
+
+void interrupts()
+{
+	hostIrqOff = false;
+	irqPending();
+}
+
+/*------------------------------ pins, misc -------------------------------------------------
+*/
+void pinMode(int, int) {}
+void digitalWrite(int pin, int val) { hostPin[pin & 63] = val; }
+int digitalRead(int pin) { return hostPin[pin & 63]; }
+void digitalWriteFast(int pin, int val) { hostPin[pin & 63] = val; }
+void analogWrite(int pin, int val) { hostPin[pin & 63] = val; }
+
+long map(long x, long inMin, long inMax, long outMin, long outMax)
+{
+	return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+char* dtostrf(double v, signed char width, unsigned char decs, char* buf)
+{
+	sprintf(buf, "%*.*f", width, decs, v);
+	return buf;
+}
+
+/*------------------------------ Print -------------------------------------------------
+*/
+size_t Print::write(const uint8_t* buf, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+		write(buf[i]);
+	return n;
+}
+
+size_t Print::print(long n, int base)
+{
+	char s[40];
+
+	if (base == HEX)
+		sprintf(s, "%lX", n);
+	else
+		sprintf(s, "%ld", n);
+	return write(s);
+}
+
+size_t Print::print(unsigned long n, int base)
+{
+	char s[40];
+
+	sprintf(s, base == HEX ? "%lX" : "%lu", n);
+	return write(s);
+}
+
+size_t Print::print(double v, int digits)
+{
+	char s[64];
+
+	snprintf(s, sizeof(s), "%.*f", digits, v);
+	return write(s);
+}
+
+int Print::printf(const char* fmt, ...)
+{
+	char s[512];
+	va_list ap;
+
+	va_start(ap, fmt);
+	int n = vsnprintf(s, sizeof(s), fmt, ap);
+	va_end(ap);
+	write((const uint8_t*)s, strlen(s));
+	return n;
+}
+
+/*------------------------------ serial -------------------------------------------------
+*/
+int HardwareSerial::available()
+{
+	int n = 0;
+
+	for (auto& r : rx)
+	{
+		if (r.first > hostNs)
+			break;
+		n++;
+	}
+	return n;
+}
+
+int HardwareSerial::read()
+{
+	if (rx.empty() || rx.front().first > hostNs)
+		return -1;
+	uint8_t c = rx.front().second;
+	rx.pop_front();
+	return c;
+}
+
+int HardwareSerial::peek()
+{
+	if (rx.empty() || rx.front().first > hostNs)
+		return -1;
+	return rx.front().second;
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+	return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buf, size_t n)
+{
+	if ((int)n > txRoom)
+		overWrites += n - txRoom;
+	tx.insert(tx.end(), buf, buf + n);
+	if (onTx)
+		for (size_t i = 0; i < n; i++)
+			onTx(buf[i]);
+	return n;
+}
+
+void HardwareSerial::in(const uint8_t* buf, size_t n, uint64_t atNs)
+{
+	for (size_t i = 0; i < n; i++)
+		rx.push_back({ atNs, buf[i] });
+}
+
+/*------------------------------ IntervalTimer -------------------------------------------------
+*/
+IntervalTimer::IntervalTimer()
+{
+	timerList().push_back(this);
+}
+
+bool IntervalTimer::begin(void (*f)(), double us)
+{
+	fn = f;
+	periodNs = (uint64_t)(us * 1000);
+	nextNs = hostNs + periodNs;
+	isRunning = true;
+	return true;
+}
+
+void IntervalTimer::end()
+{
+	isRunning = false;
+}
+
+/*------------------------------ ADC, PDB, DMA -------------------------------------------------
+*/
+int ADC_Module::analogRead(uint8_t p)
+{
+	pin = p;
+	hostTick(10000);									// single conversion, averaging
+	return adcRead(p);
+}
+
+void ADC_Module::startPDB(uint32_t freq)
+{
+	pdb.periodNs = 1000000000ULL / freq;
+	pdb.nextNs = hostNs + pdb.periodNs;
+	pdb.isOn = true;
+}
+
+void ADC_Module::stopPDB()
+{
+	pdb.isOn = false;
+}
+
+uint32_t ADC_Module::getPDBFrequency()
+{
+	return pdb.isOn ? 1000000000ULL / pdb.periodNs : 0;
+}
+
+ADC::Sync_result ADC::analogSyncRead(uint8_t pin0, uint8_t pin1)
+{
+	Sync_result r;
+
+	hostTick(6000);										// synced conversion pair, averaging 16
+	r.result_adc0 = adcRead(pin0);
+	r.result_adc1 = adcRead(pin1);
+	return r;
+}
+
+DMAChannel::DMAChannel()
+{
+	dmaList().push_back(this);
+}
+
+void DMAChannel::copy(uint16_t v)
+{
+	if (!buf || !len)
+		return;
+	if (adc == 0 && hostDmaDrop > 0)					// transfer request lost
+	{
+		hostDmaDrop--;
+		return;
+	}
+	buf[idx] = v;
+	if (++idx >= len)
+	{
+		idx = 0;
+		if (isDone && isr)
+			irq(isr);
+	}
+	else if (idx == len / 2 && isHalf && isr)
+		irq(isr);
+}
+
+/*------------------------------ touch -------------------------------------------------
+*/
+const hostPress* XPT2046_Touchscreen::now()
+{
+	for (const hostPress& p : presses)
+		if (hostNs >= p.startNs && hostNs < p.endNs)
+			return &p;
+	return nullptr;
+}
+
+bool XPT2046_Touchscreen::tirqTouched()
+{
+	if (now())
+		isrWake = true;									// pen down interrupt
+	return isrWake;
+}
+
+bool XPT2046_Touchscreen::touched()
+{
+	reads++;
+	hostTick(20000);									// SPI read, z
+	if (!now())
+		isrWake = false;
+	return now() != nullptr;
+}
+
+TS_Point XPT2046_Touchscreen::getPoint()
+{
+	const hostPress* p = now();
+
+	reads++;
+	hostTick(40000);									// SPI read, x, y, z
+	return p ? TS_Point(p->x, p->y, 1000) : TS_Point();
+}
+
+/*------------------------------ display -------------------------------------------------
+*/
+void ILI9341_t3::cost(uint32_t px)
+{
+	hostTft.pixels += px;
+	hostTft.calls++;
+	hostTick(hostCallNs2 + (uint64_t)px * hostPixelNs);
+}
+
+void ILI9341_t3::plot(int16_t x, int16_t y, uint16_t c)
+{
+	if (x >= 0 && x < _width && y >= 0 && y < _height)
+		fb[y][x] = c;
+}
+
+void ILI9341_t3::drawPixel(int16_t x, int16_t y, uint16_t c)
+{
+	plot(x, y, c);
+	cost(1);
+}
+
+void ILI9341_t3::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c)
+{
+	int16_t x1 = std::min<int>(x + w, _width), y1 = std::min<int>(y + h, _height);
+
+	x = std::max<int16_t>(x, 0);
+	y = std::max<int16_t>(y, 0);
+	if (x >= x1 || y >= y1)
+		return;
+	for (int j = y; j < y1; j++)
+		for (int i = x; i < x1; i++)
+			fb[j][i] = c;
+	cost((x1 - x) * (y1 - y));
+}
+
+void ILI9341_t3::fillRectVGradient(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c1, uint16_t c2)
+{
+	int r1 = c1 >> 11, g1 = (c1 >> 5) & 63, b1 = c1 & 31;
+	int r2 = c2 >> 11, g2 = (c2 >> 5) & 63, b2 = c2 & 31;
+	int n = 0;
+
+	for (int j = 0; j < h; j++)
+	{
+		int r = r1 + (r2 - r1) * j / (h > 1 ? h - 1 : 1);
+		int g = g1 + (g2 - g1) * j / (h > 1 ? h - 1 : 1);
+		int b = b1 + (b2 - b1) * j / (h > 1 ? h - 1 : 1);
+
+		for (int i = 0; i < w; i++, n++)
+			plot(x + i, y + j, r << 11 | g << 5 | b);
+	}
+	cost(n);
+}
+
+void ILI9341_t3::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c)
+{
+	drawFastHLine(x, y, w, c);
+	drawFastHLine(x, y + h - 1, w, c);
+	drawFastVLine(x, y, h, c);
+	drawFastVLine(x + w - 1, y, h, c);
+}
+
+void ILI9341_t3::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t c)
+{
+	int dx = abs(x1 - x0), dy = -abs(y1 - y0);
+	int sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+	int err = dx + dy, n = 0;
+
+	for (;;)
+	{
+		plot(x0, y0, c);
+		n++;
+		if (x0 == x1 && y0 == y1)
+			break;
+		int e2 = 2 * err;
+		if (e2 >= dy) { err += dy; x0 += sx; }
+		if (e2 <= dx) { err += dx; y0 += sy; }
+	}
+	cost(n);
+}
+
+void ILI9341_t3::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t c)
+{
+	int n = 0;
+
+	for (int y = -r; y <= r; y++)
+		for (int x = -r; x <= r; x++)
+		{
+			int d = x * x + y * y;
+			if (d <= r * r && d > (r - 1) * (r - 1))
+			{
+				plot(x0 + x, y0 + y, c);
+				n++;
+			}
+		}
+	cost(n);
+}
+
+void ILI9341_t3::fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t c)
+{
+	int n = 0;
+
+	for (int y = -r; y <= r; y++)
+		for (int x = -r; x <= r; x++)
+			if (x * x + y * y <= r * r)
+			{
+				plot(x0 + x, y0 + y, c);
+				n++;
+			}
+	cost(n);
+}
+
+void ILI9341_t3::drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t c)
+{
+	drawFastHLine(x + r, y, w - 2 * r, c);
+	drawFastHLine(x + r, y + h - 1, w - 2 * r, c);
+	drawFastVLine(x, y + r, h - 2 * r, c);
+	drawFastVLine(x + w - 1, y + r, h - 2 * r, c);
+	for (int i = 0; i < r; i++)							// corners, diagonal steps
+	{
+		int d = r - (int)sqrt((double)(r * r - (r - i) * (r - i)));
+		plot(x + d, y + i, c);
+		plot(x + w - 1 - d, y + i, c);
+		plot(x + d, y + h - 1 - i, c);
+		plot(x + w - 1 - d, y + h - 1 - i, c);
+	}
+	cost(4 * r);
+}
+
+void ILI9341_t3::fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t c)
+{
+	int n = 0;
+
+	for (int j = 0; j < h; j++)
+	{
+		int i = j < r ? r - j : (j >= h - r ? j - (h - r) + 1 : 0);
+		int d = i ? r - (int)sqrt((double)(r * r - i * i)) : 0;
+
+		for (int k = d; k < w - d; k++, n++)
+			plot(x + k, y + j, c);
+	}
+	cost(n);
+}
+
+void ILI9341_t3::writeRect(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t* pcolors)
+{
+	for (int j = 0; j < h; j++)
+		for (int i = 0; i < w; i++)
+			plot(x + i, y + j, *pcolors++);
+	cost(w * h);
+}
+
+void ILI9341_t3::writeRect1BPP(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t* pixels, const uint16_t* palette)
+{
+	for (int j = 0; j < h; j++)
+	{
+		const uint8_t* row = pixels + j * ((w + 7) / 8);	// rows start on a byte
+
+		for (int i = 0; i < w; i++)
+			plot(x + i, y + j, palette[(row[i >> 3] >> (7 - (i & 7))) & 1]);
+	}
+	cost(w * h);
+}
+
+uint32_t ILI9341_t3::digest()
+{
+	uint32_t h = 2166136261u;
+
+	for (int j = 0; j < _height; j++)
+		for (int i = 0; i < _width; i++)
+		{
+			h = (h ^ (fb[j][i] & 0xFF)) * 16777619u;
+			h = (h ^ (fb[j][i] >> 8)) * 16777619u;
+		}
+	return h;
+}
+
+/*------------------------------ fonts -------------------------------------------------
+packed format as ILI9341_t3: index of bit offsets, glyphs byte aligned, MSB first
+glyph: encoding 3 bits (0), width, height, xoffset (signed), yoffset (signed), delta,
+then per line: 0 + width bits, or 1 + repeat 3 bits (n - 2) + width bits for n equal lines
+*/
+static uint32_t fetchbit(const uint8_t* p, uint32_t index)
+{
+	return (p[index >> 3] >> (7 - (index & 7))) & 1;
+}
+
+static uint32_t fetchbits_unsigned(const uint8_t* p, uint32_t index, uint32_t required)
+{
+	uint32_t val = 0;
+
+	for (uint32_t i = 0; i < required; i++)
+		val = (val << 1) | fetchbit(p, index + i);
+	return val;
+}
+
+static int32_t fetchbits_signed(const uint8_t* p, uint32_t index, uint32_t required)
+{
+	uint32_t val = fetchbits_unsigned(p, index, required);
+
+	if (val & (1 << (required - 1)))
+		return (int32_t)val - (1 << required);
+	return val;
+}
+
+static const uint8_t* glyphData(const ILI9341_t3_font_t* f, unsigned int c)
+{
+	uint32_t bitoffset;
+
+	if (c >= f->index1_first && c <= f->index1_last)
+		bitoffset = (c - f->index1_first) * f->bits_index;
+	else if (c >= f->index2_first && c <= f->index2_last)
+		bitoffset = (c - f->index2_first + f->index1_last - f->index1_first + 1) * f->bits_index;
+	else
+		return nullptr;
+	const uint8_t* data = f->data + fetchbits_unsigned(f->index, bitoffset, f->bits_index);
+	return fetchbits_unsigned(data, 0, 3) == 0 ? data : nullptr;
+}
+
+uint16_t ILI9341_t3::strPixelLen(const char* str)
+{
+	uint16_t len = 0;
+
+	for (; font && *str; str++)
+	{
+		const uint8_t* data = glyphData(font, (uint8_t)*str);
+		if (!data)
+			continue;
+		uint32_t bitoffset = 3 + font->bits_width + font->bits_height + font->bits_xoffset + font->bits_yoffset;
+		len += fetchbits_unsigned(data, bitoffset, font->bits_delta);
+	}
+	return len;
+}
+
+void ILI9341_t3::drawFontChar(unsigned int c)
+{
+	const uint8_t* data = glyphData(font, c);
+	uint32_t bitoffset = 3;
+
+	if (!data)
+		return;
+	uint32_t width = fetchbits_unsigned(data, bitoffset, font->bits_width);
+	bitoffset += font->bits_width;
+	uint32_t height = fetchbits_unsigned(data, bitoffset, font->bits_height);
+	bitoffset += font->bits_height;
+	int32_t xoffset = fetchbits_signed(data, bitoffset, font->bits_xoffset);
+	bitoffset += font->bits_xoffset;
+	int32_t yoffset = fetchbits_signed(data, bitoffset, font->bits_yoffset);
+	bitoffset += font->bits_yoffset;
+	uint32_t delta = fetchbits_unsigned(data, bitoffset, font->bits_delta);
+	bitoffset += font->bits_delta;
+
+	if (cursor_x < 0)
+		cursor_x = 0;
+	int32_t origin_x = cursor_x + xoffset;
+	if (origin_x < 0)
+	{
+		cursor_x -= xoffset;
+		origin_x = 0;
+	}
+	if (origin_x + (int)width > _width)
+	{
+		if (!wrap)
+			return;
+		origin_x = 0;
+		cursor_x = xoffset >= 0 ? 0 : -xoffset;
+		cursor_y += font->line_space;
+	}
+	if (cursor_y >= _height)
+		return;
+	hostTft.glyphs++;
+
+	// opaque text: whole cell in background, one transaction with the glyph
+	bool isOpaque = textcolor != textbgcolor;
+	uint32_t px = 0;
+	if (isOpaque)
+	{
+		for (int j = 0; j < font->line_space; j++)
+			for (uint32_t i = 0; i < delta; i++)
+				plot(cursor_x + i, cursor_y + j, textbgcolor);
+		px = delta * font->line_space;
+	}
+
+	int32_t origin_y = cursor_y + font->cap_height - height - yoffset;
+	int32_t linecount = height, y = origin_y, runs = 0;
+	while (linecount > 0)
+	{
+		uint32_t n = 1;
+
+		if (fetchbit(data, bitoffset++))				// repeated line
+		{
+			n = fetchbits_unsigned(data, bitoffset, 3) + 2;
+			bitoffset += 3;
+		}
+		for (uint32_t r = 0; r < n; r++)
+		{
+			bool isRun = false;
+
+			for (uint32_t x = 0; x < width; x++)
+			{
+				bool isSet = fetchbit(data, bitoffset + x);
+				if (isSet)
+				{
+					plot(origin_x + x, y + r, textcolor);
+					if (!isOpaque)
+						px++;
+				}
+				if (isSet && !isRun && r == 0)
+					runs++;							// one fill per run, all n lines
+				isRun = isSet;
+			}
+		}
+		bitoffset += width;
+		y += n;
+		linecount -= n;
+	}
+	cursor_x += delta;
+	if (isOpaque)
+		cost(px);
+	else
+	{
+		cost(px);									// transparent: one fill per run of set pixels
+		if (runs > 1)
+		{
+			hostTft.calls += runs - 1;
+			hostTick((uint64_t)(runs - 1) * hostCallNs2);
+		}
+	}
+}
+
+size_t ILI9341_t3::write(uint8_t c)
+{
+	if (!font)
+		return 1;
+	if (c == '\n')
+	{
+		cursor_y += font->line_space;
+		cursor_x = 0;
+	}
+	else
+		drawFontChar(c);
+	return 1;
+}
+
+// bit writer for mockFont()
+struct bitOut
+{
+	std::vector<uint8_t> b;
+	uint32_t n = 0;
+
+	void put(uint32_t v, int bits)
+	{
+		for (int i = bits - 1; i >= 0; i--, n++)
+		{
+			if ((n >> 3) >= b.size())
+				b.push_back(0);
+			if ((v >> i) & 1)
+				b[n >> 3] |= 0x80 >> (n & 7);
+		}
+	}
+	void align() { n = (n + 7) & ~7u; }
+};
+
+ILI9341_t3_font_t mockFont(int size, bool isBold)
+{
+	ILI9341_t3_font_t f;
+	bitOut data, index;
+	int cap = (size * 72 + 50) / 100;
+	int stroke = size / 10 + (isBold ? 1 : 0) + 1;
+
+	memset(&f, 0, sizeof(f));
+	f.version = 1;
+	f.index1_first = 32;
+	f.index1_last = 126;
+	f.index2_first = 1;									// empty second range
+	f.index2_last = 0;
+	f.bits_index = 24;
+	f.bits_width = 7;
+	f.bits_height = 7;
+	f.bits_xoffset = 3;
+	f.bits_yoffset = 6;									// signed, cap / 3 of 48 pt fits
+	f.bits_delta = 7;
+	f.line_space = (size * 115 + 50) / 100 + 1;
+	f.cap_height = cap;
+
+	for (int c = 32; c <= 126; c++)
+	{
+		int w = (size * 55 + 50) / 100 + (isBold ? 1 : 0), h = cap, gap = size / 8 + 1;
+
+		if (c == ' ')
+			w = h = 0;
+		else if (c == '.' || c == ':' || c == ',')
+			w = h = stroke + 1;
+		else if (c == '-')
+			h = stroke;
+		else if (c >= 'a' && c <= 'z')
+			h = cap * 3 / 4;
+		else if (c == 'M' || c == 'W' || c == '%')
+			w = w * 4 / 3;
+		int yoff = (c == '-') ? cap / 3 : 0;
+		int delta = c == ' ' ? size / 4 + 1 : w + gap;
+
+		index.put(data.b.size(), f.bits_index);
+		data.put(0, 3);
+		data.put(w, f.bits_width);
+		data.put(h, f.bits_height);
+		data.put(c == 'j' ? -1 & 7 : 0, f.bits_xoffset);
+		data.put(yoff, f.bits_yoffset);
+		data.put(delta, f.bits_delta);
+
+		// outline of stroke width, char dependent diagonal. top / bottom strokes repeat
+		std::vector<std::vector<uint8_t>> rows(h, std::vector<uint8_t>(w));
+		for (int y = 0; y < h; y++)
+			for (int x = 0; x < w; x++)
+				rows[y][x] = x < stroke || x >= w - stroke || y < stroke || y >= h - stroke
+					|| (y * w / (h ? h : 1) + c) % w == x;
+		for (int y = 0; y < h;)
+		{
+			int n = 1;
+			while (y + n < h && n < 9 && rows[y + n] == rows[y])
+				n++;
+			if (n >= 2)
+				data.put(1, 1), data.put(n - 2, 3);
+			else
+				data.put(0, 1);
+			for (int x = 0; x < w; x++)
+				data.put(rows[y][x], 1);
+			y += n;
+		}
+		data.align();
+	}
+	uint8_t* d = new uint8_t[data.b.size() + 4]();
+	uint8_t* i = new uint8_t[index.b.size() + 4]();
+	memcpy(d, data.b.data(), data.b.size());
+	memcpy(i, index.b.data(), index.b.size());
+	f.data = d;
+	f.index = i;
+	return f;
+}
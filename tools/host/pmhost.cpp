@@ -0,0 +1,87 @@
+/*
+host build of the PowerMeter III sketch, tests, benchmarks and trace replay
+  pmhost                    all tests
+  pmhost bench              all benchmarks
+  pmhost <name>...          named tests / benchmarks
+  pmhost <tool> <args>      record, replay (testTrace.cpp)
+  pmhost list
+see tools/host/Readme.md
+*/
+#include "build/sketch.cpp"
+#include "host.h"
+
+#include "testAct.cpp"
+#include "testAdc.cpp"
+#include "testBand.cpp"
+#include "testCiv.cpp"
+#include "testDisplay.cpp"
+#include "testEeprom.cpp"
+#include "testHist.cpp"
+#include "testPower.cpp"
+#include "testSched.cpp"
+#include "testStream.cpp"
+#include "testSweep.cpp"
+#include "testTouch.cpp"
+#include "testTrace.cpp"
+
+static bool hostRunCase(const hostCase& c)
+{
+	pid_t pid;
+	int status = 0;
+
+	fflush(stdout);
+	if ((pid = fork()) == 0)
+	{
+		alarm(600);										// runaway virtual clock
+		c.fn();
+		fflush(stdout);
+		_exit(0);
+	}
+	waitpid(pid, &status, 0);
+	bool isPass = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+	printf("%s %s\n", isPass ? "PASS" : "FAIL", c.name);
+	if (WIFSIGNALED(status))
+		printf("     signal %d\n", WTERMSIG(status));
+	return isPass;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<const hostCase*> run;
+	int kind = HOST_TEST, fails = 0;
+
+	if (argc > 1 && !strcmp(argv[1], "list"))
+	{
+		for (const hostCase& c : hostCases())
+			printf("%-6s %s\n", c.kind == HOST_TEST ? "test" : (c.kind == HOST_BENCH ? "bench" : "tool"), c.name);
+		return 0;
+	}
+	for (const hostCase& c : hostCases())				// tool, rest of line is its arguments
+		if (argc > 1 && c.kind == HOST_TOOL && !strcmp(argv[1], c.name))
+		{
+			hostArgs.assign(argv + 2, argv + argc);
+			c.fn();
+			return 0;
+		}
+
+	if (argc > 1 && !strcmp(argv[1], "bench"))
+		kind = HOST_BENCH;
+	for (const hostCase& c : hostCases())
+	{
+		bool isNamed = argc == 1 || kind == HOST_BENCH;
+
+		for (int i = 1; i < argc && !isNamed; i++)
+			isNamed = !strcmp(argv[i], c.name);
+		if (c.kind != HOST_TOOL && isNamed && (argc > 1 && kind == HOST_TEST ? true : c.kind == kind))
+			run.push_back(&c);
+	}
+	if (run.empty())
+	{
+		fprintf(stderr, "no tests matched\n");
+		return 2;
+	}
+	for (const hostCase* c : run)
+		fails += !hostRunCase(*c);
+	printf("%d passed, %d failed\n", (int)run.size() - fails, fails);
+	return fails ? 1 : 0;
+}
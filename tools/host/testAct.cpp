@@ -0,0 +1,156 @@
+// adaptive rates: activity.ino, carrier detect in getADC() / getADCBlock()
+
+struct actKey
+{
+	double readMs;									// key down to first measure() reading over PWR_THRESHOLD
+	double shownMs;									// key down to nettPwr drawn
+	unsigned long latencyUs;						// actLatency, detect to first reading
+};
+
+// key down on CH_MAIN now, times to first reading and to the value on screen
+static actKey actKeyDown()
+{
+	actKey k = { -1, -1, 0 };
+	unsigned long switches = actSwitches;
+	uint64_t t0 = hostNs;
+
+	hostCarrier(3000, 300);
+	if (hostRunUntil([switches] { return actSwitches > switches && !isActFirst; }, 1000))
+		k.readMs = (actKeyUs + actLatency - t0 / 1000) / 1000.0;		// micros() of the reading
+	if (hostRunUntil([] { return val[nettPwr].prevValue > PWR_THRESHOLD; }, 1000))
+		k.shownMs = (hostNs - t0) / 1e6;
+	k.latencyUs = actLatency;
+	return k;
+}
+
+// pairs sampled and measure() runs in the next ms
+static void actRatesNow(uint64_t ms, uint32_t& pairs, unsigned long& measures)
+{
+	task* meas = hostTask(measureTask);
+	uint32_t count = sampleCount;
+	unsigned long runs = meas->runs;
+
+	hostRun(ms);
+	pairs = sampleCount - count;
+	measures = meas->runs - runs;
+}
+
+// idle rates with no carrier, full rates from key down, idle again ACT_HOLD after key up.
+// nettPwr background change drawn by the display task, measure() and display inside their budgets at key down / up
+TEST(actRates)
+{
+	uint32_t pairs;
+	unsigned long measures;
+
+	hostBoot();
+	hostRun(ACT_HOLD + 1000);
+	CHECK(!isActive);
+	CHECK(!isActRate);
+	hostTask(measureTask)->worst = 0;
+	hostTask(displayTask)->worst = 0;
+	actRatesNow(1000, pairs, measures);
+	CHECK_NEAR(measures, 1000 / ACT_MEASURE_IDLE, 2);
+#if !BLOCK_MODE
+	CHECK_NEAR(pairs, 1000000 / ACT_IDLE_INTERVAL, 2);
+#endif
+
+	actKeyDown();
+	CHECK(frs.bg[nettPwr] == RED);
+	CHECK(isActive);
+	CHECK(isActRate);
+	actRatesNow(1000, pairs, measures);
+	CHECK_NEAR(measures, 500, 5);
+#if !BLOCK_MODE
+	CHECK_NEAR(pairs, 1000000 / SAMPLE_INTERVAL, 2);
+#endif
+
+	hostCarrier(0, 0);												// key up
+	hostRun(ACT_HOLD - 200);
+	CHECK(isActive);
+	hostRun(400);
+	CHECK(!isActive);
+	CHECK(!isActRate);
+	CHECK(frs.bg[nettPwr] == BG_COLOUR);
+	CHECK(hostTask(measureTask)->worst <= hostTask(measureTask)->budget);
+	printf("display task worst %lu uSecs, budget %lu\n", hostTask(displayTask)->worst,
+		(unsigned long)hostTask(displayTask)->budget);
+	CHECK(hostTask(displayTask)->worst <= hostTask(displayTask)->budget);
+}
+
+// keyed session, key down after idle each time: first reading within an idle sample interval
+// and a measure() pass, value on screen by the next display frame. 'a' reports the same
+TEST(actKeying)
+{
+	double worstRead = 0, worstShown = 0;
+
+	hostBoot();
+	for (int i = 0; i < 6; i++)
+	{
+		hostCarrier(0, 0);
+		hostRun(ACT_HOLD + 1000 + 137 * i);							// idle, key down at a new phase
+		CHECK(!isActRate);
+		actKey k = actKeyDown();
+		printf("key down %d: first reading %.2f mSecs (actLatency %lu uSecs), shown %.2f mSecs\n",
+			i, k.readMs, k.latencyUs, k.shownMs);
+		CHECK(k.readMs >= 0);
+		CHECK(k.shownMs >= k.readMs);
+		CHECK(k.latencyUs <= k.readMs * 1000 + 1);
+		worstRead = std::max(worstRead, k.readMs);
+		worstShown = std::max(worstShown, k.shownMs);
+		hostRun(1000);
+	}
+	CHECK(worstRead < (BLOCK_MODE ? 1000.0 * BLOCK_SIZE / BLOCK_RATE : ACT_IDLE_INTERVAL / 1000.0) + 3);
+	CHECK(worstShown < worstRead + 1000.0 / DISP_FPS + 5);
+
+	size_t from = Serial.tx.size();
+	hostCmd("a");
+	hostRun(100);
+	CHECK(hostUsb(from).find("ACT,1,6,") != std::string::npos);
+}
+
+// CPU load, idle and keyed, adaptive rates and full rates always (act task off). getADC() and measure()
+// from their profile zones (modelled conversion, call costs, as isrChans), tasks from schedBusy
+BENCH(actLoad)
+{
+	printf("10 secs each, modelled time. interrupts getADC() zone, measure() zone, other tasks less measure()\n"
+		"(SPI, ADC waits, loop pass). an interrupt taken inside a task also counts in its time\n");
+	for (int mode = 0; mode < 3; mode++)
+	{
+		fflush(stdout);
+		pid_t pid = fork();											// one boot per process
+
+		if (pid == 0)
+		{
+			const char* name[] = { "idle, adaptive", "idle, full rate", "carrier" };
+
+			hostBoot();
+			if (mode == 1)
+			{
+				hostTask(actTask)->fn = [] {};
+				actRates(true);
+#if !BLOCK_MODE
+				sampleTimer.update(SAMPLE_INTERVAL);
+#endif
+			}
+			if (mode == 2)
+				hostCarrier(3000, 300);
+			hostRun(ACT_HOLD + 1000);
+
+			uint32_t irqs = hostIrqs, pairs = sampleCount;
+			unsigned long busy = schedBusy, runs = hostTask(measureTask)->runs;
+			uint64_t px = hostTft.pixels, isr = profStats[PZ_ADC].total, meas = profStats[PZ_MEASURE].total;
+			hostRun(10000);
+			double isrPc = (profStats[PZ_ADC].total - isr) * 10.0 / F_CPU;	// % of 10 secs
+			double measPc = (profStats[PZ_MEASURE].total - meas) * 10.0 / F_CPU;
+			double taskPc = (schedBusy - busy) / 1e5 - measPc;
+			printf("  %-16s CPU %5.2f%%  interrupts %5.2f%%  measure() %5.2f%%  tasks %5.2f%%\n"
+				"  %-16s %5u interrupts/s  %5u pairs/s  measure() %4lu/s  %6llu pixels/s\n",
+				name[mode], isrPc + measPc + taskPc, isrPc, measPc, taskPc, "", (hostIrqs - irqs) / 10,
+				(sampleCount - pairs) / 10, (hostTask(measureTask)->runs - runs) / 10,
+				(unsigned long long)(hostTft.pixels - px) / 10);
+			fflush(stdout);
+			_exit(0);
+		}
+		waitpid(pid, NULL, 0);
+	}
+}
@@ -0,0 +1,597 @@
+// ADC sample path: adc.ino, measChan.h
+#include <x86intrin.h>
+
+// synthetic SSB voice envelope, ADC codes. two tones beating, syllables 80 - 300 mSecs with
+// gaps, noise. ref about 1/8 of fwd. deterministic, same sequence every run
+struct ssbEnvelope
+{
+	uint32_t seed = 12345;
+	double t = 0, dt;
+	double sylEnd = 0;
+	bool isOn = false;
+	double level = 0;
+
+	ssbEnvelope(int rateHz) : dt(1.0 / rateHz) {}
+
+	uint32_t rnd() { return seed = seed * 1664525 + 1013904223; }
+	double uni() { return (rnd() >> 8) / 16777216.0; }
+
+	void next(uint16_t& fwd, uint16_t& ref)
+	{
+		if (t >= sylEnd)
+		{
+			isOn = !isOn || uni() < 0.2;
+			sylEnd = t + (isOn ? 0.08 + 0.22 * uni() : 0.03 + 0.15 * uni());
+			level = 0.4 + 0.6 * uni();
+		}
+		double env = 0;
+
+		if (isOn)
+			env = fabs(sin(2 * M_PI * 700 * t) + 0.7 * sin(2 * M_PI * 1900 * t + 1.0)) / 1.7 * level;
+		int f = 3600 * env + 8 * uni();
+		fwd = constrain(f, 0, 4095);
+		ref = constrain(f / 8 + (int)(4 * uni()), 0, 4095);
+		t += dt;
+	}
+};
+
+// baseline getADC(): rescan the window for the peak every sample. newest of equal peaks
+static void rescanPeak(const uint16_t* b1, const uint16_t* b0, int head, int n, uint32_t& m1, uint32_t& m0)
+{
+	int p = head - n;
+
+	m1 = m0 = 0;
+	if (p < 0)
+		p += MAXBUF;
+	for (int i = 0; i < n; i++)
+	{
+		if (b1[p] >= m1)
+		{
+			m1 = b1[p];
+			m0 = b0[p];
+		}
+		if (++p >= MAXBUF)
+			p = 0;
+	}
+}
+
+// user-001 getADC(): monotonic queue of buffer positions, front is window peak. one window only
+struct dequePeak
+{
+	int que[MAXBUF + 1];
+	int head = 0, tail = 0;
+
+	void add(const uint16_t* b1, int pos, int n)
+	{
+		int old = pos - n;
+
+		if (old < 0)
+			old += MAXBUF;
+		if (head != tail && que[head] == old)		// oldest leaving window
+			if (++head > MAXBUF)
+				head = 0;
+		while (head != tail)
+		{
+			int back = tail - 1;
+			if (back < 0)
+				back = MAXBUF;
+			if (b1[que[back]] > b1[pos])
+				break;
+			tail = back;
+		}
+		que[tail] = pos;
+		if (++tail > MAXBUF)
+			tail = 0;
+	}
+};
+
+struct peakBench
+{
+	double ns;										// per sample
+	double cycles;									// host TSC per sample
+	uint32_t checks, misses;						// peaks compared with rescan, different
+};
+
+// method 0 rescan, 1 user-001 queue, 2 block max, 3 block max without peak reads (interrupt part)
+// rate samples / sec, one peak read per measure() pass (every 2 mSecs)
+static peakBench peakRun(int method, int n, int rateHz, int samples)
+{
+	static adcChan c;
+	static uint16_t b1[MAXBUF], b0[MAXBUF];			// same samples, for rescan and deque
+	static dequePeak dq;
+	ssbEnvelope sig(rateHz);
+	int per = rateHz / 500;							// samples per measure() pass
+	int pos = 0;
+	peakBench r = {};
+	std::vector<uint32_t> got;
+
+	memset((void*)&c, 0, sizeof(c));
+	memset(b1, 0, sizeof(b1));
+	memset(b0, 0, sizeof(b0));
+	dq.head = dq.tail = 0;
+	c.setWindow(0, n, 0);
+	got.reserve(2 * samples / per + 2);
+
+	std::vector<uint16_t> in1(samples), in0(samples);
+	for (int i = 0; i < samples; i++)
+		sig.next(in1[i], in0[i]);
+
+	double wall = hostWall();
+	uint64_t tsc = __rdtsc();
+	for (int i = 0; i < samples; i++)
+	{
+		uint32_t m1, m0;
+
+		if (method == 0)							// baseline, rescan every sample
+		{
+			b1[pos] = in1[i];
+			b0[pos] = in0[i];
+			rescanPeak(b1, b0, pos + 1, n, m1, m0);
+		}
+		else if (method == 1)						// user-001 queue
+		{
+			b1[pos] = in1[i];
+			b0[pos] = in0[i];
+			dq.add(b1, pos, n);
+			m1 = b1[dq.que[dq.head]];
+			m0 = b0[dq.que[dq.head]];
+		}
+		else
+			c.add(pos, in1[i], in0[i]);				// window totals and block max
+		if (++pos >= MAXBUF)
+			pos = 0;
+		if (i % per == per - 1 && method != 3)
+		{
+			if (method == 2)
+				c.peak(pos, n, m1, m0);
+			got.push_back(m1);
+			got.push_back(m0);
+		}
+	}
+	r.cycles = double(__rdtsc() - tsc) / samples;
+	r.ns = (hostWall() - wall) * 1e9 / samples;
+	if (method == 3)
+		return r;
+
+	// same peaks as a rescan of the window
+	memset(b1, 0, sizeof(b1));
+	memset(b0, 0, sizeof(b0));
+	pos = 0;
+	for (int i = 0, j = 0; i < samples; i++)
+	{
+		b1[pos] = in1[i];
+		b0[pos] = in0[i];
+		if (++pos >= MAXBUF)
+			pos = 0;
+		if (i % per == per - 1)
+		{
+			uint32_t m1, m0;
+
+			rescanPeak(b1, b0, pos, n, m1, m0);
+			r.checks++;
+			r.misses += got[j] != m1 || got[j + 1] != m0;
+			j += 2;
+		}
+	}
+	return r;
+}
+
+// block peaks give the rescan's peak, and its ref sample, for any window
+TEST(peakMatchesRescan)
+{
+	for (int n : { 1, 15, 16, 17, 100, 1000, WIN_MAX })
+	{
+		peakBench r = peakRun(2, n, 2000, 20000);
+		CHECK(r.checks > 0);
+		CHECK_EQ(r.misses, 0);
+	}
+	peakBench r = peakRun(1, 1000, 2000, 20000);	// user-001 queue, for the bench
+	CHECK_EQ(r.misses, 0);
+}
+
+BENCH(peakSsb)
+{
+	const char* name[] = { "rescan (baseline)", "queue (user-001)", "block max (now)", "  interrupt part" };
+
+	printf("SSB envelope 2 kHz, peak read every 2 mSecs. per sample, host\n");
+	printf("queue is one window, block max serves all NUM_WIN windows\n");
+	for (int n : { 100, 1000, WIN_MAX })
+		for (int m = 0; m < 4; m++)
+		{
+			peakBench r = peakRun(m, n, 2000, 400000);
+			printf("  window %4d  %-18s %7.1f ns %8.1f TSC cycles", n, name[m], r.ns, r.cycles);
+			if (m < 3)
+				printf("  peaks %s (%u)", r.misses ? "DIFFER" : "same", r.checks);
+			printf("\n");
+		}
+}
+
+// sample rate and window time. samples params give the same window time in both modes
+TEST(windowTime)
+{
+	uint32_t count;
+
+	hostBoot();
+	samplesDefPar.val = 100;								// 50 mSecs
+	hostRun(100);
+	CHECK_EQ(chan[CH_MAIN].winSize[WIN_DEF], 100 * WIN_MULT);
+
+	hostCarrier(3000, 300);
+	hostRun(10);
+	count = sampleCount;
+	hostRun(1000);
+	CHECK_NEAR(sampleCount - count, 1000000 / SAMPLE_INTERVAL * WIN_MULT, 20 * WIN_MULT);
+
+	hostAdcFn = nullptr;									// step down, window empties in 50 mSecs
+	hostRun(30);											// measure() may be a display frame behind
+	CHECK(chan[CH_MAIN].avg1 > (1000u << ADC_FRAC_BITS));
+	hostRun(70);
+	CHECK_EQ(chan[CH_MAIN].avg1, 0);
+}
+
+#if BLOCK_MODE
+// fwd, ref pairs in the cyclic buffer from the same conversion: ref = fwd / 2 at every instant
+static bool blockPairsSame(int n)
+{
+	int p = sample;
+
+	for (int i = 0; i < n; i++)
+	{
+		if (--p < 0)
+			p = MAXBUF - 1;
+		if (chan[CH_MAIN].buf0[p] != chan[CH_MAIN].buf1[p] / 2)
+			return false;
+	}
+	return true;
+}
+
+// a lost ADC0 DMA transfer is found, DMA restarted, pairs stay in step
+TEST(blockDmaSkew)
+{
+	hostAdcFn = [](int pin, uint64_t ns) {
+		int v = 1000 + ns / (1000000000 / BLOCK_RATE) % 2000;	// new value every conversion
+		return pin == chan[CH_MAIN].fwdPin ? v : v / 2;
+	};
+	hostBoot();
+	hostRun(200);
+	CHECK(blkCount > 0);
+	CHECK_EQ(blkSkew, 0);
+	CHECK(blockPairsSame(WIN_MAX));
+
+	hostDmaDrop = 1;
+	hostRun(200);
+	CHECK_EQ(blkSkew, 1);
+	CHECK(blockPairsSame(BLOCK_RATE / 10));					// since the restart
+}
+#endif
+
+// block pipeline on the host: synthetic SSB blocks through addADCBlock(), chanCalc() every 2 mSecs
+// and interrupts per second in the sketch, mock timings
+BENCH(adcThroughput)
+{
+	const int rate = BLOCK_MODE ? BLOCK_RATE : 1000000 / SAMPLE_INTERVAL;
+	const int total = 4000000;
+	ssbEnvelope sig(rate);
+	std::vector<uint16_t> in1(total), in0(total);
+	uint32_t irqs;
+
+	for (int i = 0; i < total; i++)
+		sig.next(in1[i], in0[i]);
+	hostBoot();
+	samplesDefPar.val = 100;
+	hostCarrier(3000, 300);
+	hostRun(10);
+	irqs = hostIrqs;
+	uint32_t count = sampleCount;
+	hostRun(1000);
+	printf("%s, %u pairs/s, %u interrupts/s\n", BLOCK_MODE ? "block mode" : "getADC() per sample",
+		sampleCount - count, hostIrqs - irqs);
+
+	hostTimersOff = true;
+	double wall = hostWall();
+	for (int i = 0, next = 0; i < total; i += BLOCK_SIZE)
+	{
+		addADCBlock(&in1[i], &in0[i], BLOCK_SIZE);
+		if (i >= next)
+		{
+			chanCalc(CH_MAIN);
+			next += rate / 500;
+		}
+	}
+	wall = hostWall() - wall;
+	printf("pipeline %.1f M pairs/s, %.0fx %d Hz, host\n", total / wall / 1e6, total / wall / rate, rate);
+}
+
+// blockStats() before user-025 review: min / max kept in s, reloaded every pair
+static void blockStatsOld(const uint16_t* b1, const uint16_t* b0, int n, blockStat& s)
+{
+	uint32_t sum1 = s.sum1, sum0 = s.sum0;
+	uint64_t sq1 = s.sq1, sq0 = s.sq0;
+
+	if (!s.n)
+	{
+		s.min1 = s.min0 = 0xFFFF;
+		s.max1 = s.max0 = 0;
+	}
+	s.n += n;
+	for (int i = 0; i < n; i++)
+	{
+		uint32_t v1 = b1[i], v0 = b0[i];
+
+		sum1 += v1;
+		sum0 += v0;
+		sq1 += v1 * v1;
+		sq0 += v0 * v0;
+		if (v1 < s.min1)
+			s.min1 = v1;
+		if (v1 > s.max1)
+			s.max1 = v1;
+		if (v0 < s.min0)
+			s.min0 = v0;
+		if (v0 > s.max0)
+			s.max0 = v0;
+	}
+	s.sum1 = sum1;
+	s.sum0 = sum0;
+	s.sq1 = sq1;
+	s.sq0 = sq0;
+}
+
+static bool blockSame(const blockStat& a, const blockStat& b)
+{
+	return a.n == b.n && a.sum1 == b.sum1 && a.sum0 == b.sum0 && a.sq1 == b.sq1 && a.sq0 == b.sq0
+		&& a.min1 == b.min1 && a.max1 == b.max1 && a.min0 == b.min0 && a.max0 == b.max0;
+}
+
+// kernel against sums from first principles, any length and start, two segments same as one
+TEST(blockStatsMatch)
+{
+	static uint16_t b1[WIN_MAX + 1], b0[WIN_MAX + 1];
+	ssbEnvelope sig(2000);
+
+	for (int i = 0; i <= WIN_MAX; i++)
+		sig.next(b1[i], b0[i]);
+	for (int off : { 0, 1 })
+		for (int n : { 1, 2, 3, 15, 16, 17, 1000, WIN_MAX })
+		{
+			blockStat s = {}, t = {}, o = {}, ref = {};
+
+			ref.n = n;
+			ref.min1 = ref.min0 = 0xFFFF;
+			for (int i = off; i < off + n; i++)
+			{
+				ref.sum1 += b1[i];
+				ref.sum0 += b0[i];
+				ref.sq1 += b1[i] * b1[i];
+				ref.sq0 += b0[i] * b0[i];
+				ref.min1 = std::min(ref.min1, b1[i]);
+				ref.max1 = std::max(ref.max1, b1[i]);
+				ref.min0 = std::min(ref.min0, b0[i]);
+				ref.max0 = std::max(ref.max0, b0[i]);
+			}
+			blockStats(b1 + off, b0 + off, n, s);
+			blockStats(b1 + off, b0 + off, n / 3, t);
+			blockStats(b1 + off + n / 3, b0 + off + n / 3, n - n / 3, t);
+			blockStatsOld(b1 + off, b0 + off, n, o);
+			CHECK(blockSame(s, ref));
+			CHECK(blockSame(t, ref));
+			CHECK(blockSame(o, ref));
+		}
+}
+
+// samples are detector DC: steady carrier crest about 100, SSB envelope higher. 'k' line
+TEST(blockCrest)
+{
+	hostBoot();
+	hostCarrier(3000, 300);
+	hostRun(500);
+	CHECK_NEAR(chan[CH_MAIN].crest, 100, 1);
+	CHECK_EQ(chan[CH_MAIN].rms1, 3000u << ADC_FRAC_BITS);
+
+	ssbEnvelope sig(BLOCK_MODE ? BLOCK_RATE : 1000000 / SAMPLE_INTERVAL);
+	hostAdcFn = [&sig](int pin, uint64_t) {
+		static uint16_t f, r;
+		if (pin == chan[CH_MAIN].fwdPin)
+			sig.next(f, r);
+		return pin == chan[CH_MAIN].fwdPin ? f : (pin == chan[CH_MAIN].refPin ? r : 0);
+	};
+	samplesAvg = samplesDefPar.val = 100;
+	int hi = 0;
+	for (int i = 0; i < 20; i++)
+	{
+		hostRun(50);
+		hi = std::max(hi, chan[CH_MAIN].crest);
+	}
+	printf("SSB envelope crest factor up to %.2f\n", hi / 100.0);
+	CHECK(hi > 130);
+
+	size_t from = Serial.tx.size();
+	hostCmd("k");
+	hostRun(100);
+	CHECK(hostUsb(from).find(std::string("PROF,BLK,") + std::to_string(WIN_MAX) + ",") != std::string::npos);
+}
+
+// cycles per sample pair, WIN_MAX window. host has no DSP kernel, blockStats() is the plain loop.
+// on target 'k' gives DSP kernel and plain loop, DWT cycles
+BENCH(blockStatsCost)
+{
+	static uint16_t b1[WIN_MAX], b0[WIN_MAX];
+	ssbEnvelope sig(2000);
+	const char* name[] = { "blockStats()", "blockStatsPlain()", "old, min / max in s" };
+	const int reps = 2000;
+
+	for (int i = 0; i < WIN_MAX; i++)
+		sig.next(b1[i], b0[i]);
+	printf("%d pairs, host g++ -O2, plain loop%s\n", WIN_MAX,
+#if defined(__SSE2__)
+		" (SSE2 target, g++ vectorises it)"
+#else
+		""
+#endif
+	);
+	for (int m = 0; m < 3; m++)
+	{
+		blockStat s;
+		uint64_t best = ~0ULL;
+		static volatile uint64_t sink;								// every result used, none optimised out
+
+		for (int r = 0; r < reps; r++)
+		{
+			memset(&s, 0, sizeof(s));
+			uint64_t t = __rdtsc();
+			if (m == 0)
+				blockStats(b1, b0, WIN_MAX, s);
+			else if (m == 1)
+				blockStatsPlain(b1, b0, WIN_MAX, s);
+			else
+				blockStatsOld(b1, b0, WIN_MAX, s);
+			best = std::min(best, (uint64_t)(__rdtsc() - t));
+			sink = s.n + s.sum1 + s.sum0 + s.sq1 + s.sq0 + s.min1 + s.max1 + s.min0 + s.max0;
+		}
+		printf("  %-22s %5.2f TSC cycles per pair (best of %d)\n", name[m], (double)best / WIN_MAX, reps);
+	}
+}
+
+#if NUM_CHANS > 1
+// every coupler read at the same sample position into its own buffers and results, meters on CH_MAIN
+TEST(chanSecond)
+{
+	hostAdcFn = [](int pin, uint64_t) {
+		if (pin == chanPin[1][0])
+			return 2000;
+		if (pin == chanPin[1][1])
+			return 1000;
+		return pin == chan[CH_MAIN].fwdPin ? 3000 : (pin == chan[CH_MAIN].refPin ? 300 : 0);
+	};
+	hostBoot();
+	hostRun(500);
+	for (int i = 1; i <= 100; i++)
+	{
+		int p = (sample - i + MAXBUF) % MAXBUF;
+		CHECK_EQ(chan[CH_MAIN].buf1[p], 3000);
+		CHECK_EQ(chan[1].buf1[p], 2000);
+		CHECK_EQ(chan[1].buf0[p], 1000);
+	}
+	CHECK_EQ(chan[1].avg1, 2000u << ADC_FRAC_BITS);
+	CHECK(chan[1].fwdTbl == fwdPwrTbl.mW);						// compiled tables
+	CHECK(chan[1].fmW > 0 && chan[1].fmW < chan[CH_MAIN].fmW);
+	CHECK(chan[1].swr > chan[CH_MAIN].swr);
+
+	size_t from = Serial.tx.size();
+	hostCmd("c");
+	hostRun(100);
+	std::string s = hostUsb(from);
+	CHECK(s.find("CH,0,") != std::string::npos);
+	CHECK(s.find("CH,1,") != std::string::npos);
+}
+#endif
+
+#if !BLOCK_MODE
+// getADC() interrupt per channel count. conversion is the mock's synced pair time, window update
+// measured. make bench runs pmhost and pmhost_chan2 for the full getADC() at 1 and 2 channels
+BENCH(isrChans)
+{
+	static adcChan cs[4];
+	const int n = 200000;
+	ssbEnvelope sig(1000000 / SAMPLE_INTERVAL);
+	std::vector<uint16_t> in1(n), in0(n);
+
+	for (int i = 0; i < n; i++)
+		sig.next(in1[i], in0[i]);
+	hostBoot();
+	hostRun(100);
+	hostTimersOff = true;
+	uint64_t ns = hostNs;
+	double wall = hostWall();
+	for (int i = 0; i < n; i++)
+		getADC();
+	double conv = double(hostNs - ns) / n / NUM_CHANS;
+	printf("getADC(), NUM_CHANS %d: %.2f uSecs conversion + %.0f ns host per interrupt\n", NUM_CHANS,
+		conv * NUM_CHANS / 1000, (hostWall() - wall) * 1e9 / n);
+
+	printf("window update (add(), %d windows) and conversion %.1f uSecs per channel, %d uSecs interval\n",
+		NUM_WIN, conv / 1000, SAMPLE_INTERVAL);
+	for (int k = 1; k <= 4; k++)
+	{
+		for (int c = 0; c < k; c++)
+		{
+			memset((void*)&cs[c], 0, sizeof(cs[c]));
+			for (int w = 0; w < NUM_WIN; w++)
+				cs[c].setWindow(w, chan[CH_MAIN].winSize[w], 0);
+		}
+		wall = hostWall();
+		for (int i = 0, pos = 0; i < n; i++)
+		{
+			for (int c = 0; c < k; c++)
+				cs[c].add(pos, in1[i], in0[i]);
+			if (++pos >= MAXBUF)
+				pos = 0;
+		}
+		double upd = (hostWall() - wall) * 1e9 / n;
+		printf("  %d channels  update %5.1f ns host  interrupt %5.1f uSecs  %4.1f%% of interval\n",
+			k, upd, (k * conv + upd) / 1000, (k * conv + upd) / 10.0 / SAMPLE_INTERVAL);
+	}
+}
+#endif
+
+// samples params from EEPROM over SAMPLES_MAX (larger buffer, other sample mode) limited at boot,
+// so samplesAvg has a window. saved back
+TEST(samplesClamp)
+{
+	samplesDefPar.val = SAMPLES_MAX + 500;						// EEPROM image with a too large window
+	eeDirty = 0xFFFFFFFF;
+	eeFlush();
+	samplesDefPar.val = 5;										// compiled value
+	hostBoot();
+	hostRun(100);
+	CHECK_EQ(samplesDefPar.val, SAMPLES_MAX);
+	CHECK_EQ(samplesAvg, SAMPLES_MAX);
+	CHECK_EQ(adcWin(samplesAvg), WIN_DEF);
+	CHECK_EQ(chan[CH_MAIN].winSize[WIN_DEF], SAMPLES_MAX * WIN_MULT);
+	hostRun(200);
+	param p;
+	CHECK(eeRead(samplesDefPar.eeAddr, &p, sizeof(p), false));
+	CHECK_EQ(p.val, SAMPLES_MAX);
+}
+
+// cal point is the window average ADC code, both sample modes, and the reference power entered.
+// frame blink does not hold the loop, frame back after CAL_BLINK
+TEST(calPointCode)
+{
+	hostBoot();
+	hostCarrier(3000, 300);
+	samplesAvg = samplesCalPar.val;
+	lab[civ].stat = false;										// cal mode, band from radio
+	hostRun(500);
+	calPwrPar.val = 473;										// 47.3 W on the reference meter
+	uint64_t t = hostNs;
+	calButton(fwdVolts, 2);
+	calButton(refVolts, 2);
+	printf("2 cal points %.1f mSecs, frame fills only\n", (hostNs - t) / 1e6);
+	CHECK(hostNs - t < 2 * CAL_BLINK * 1000000ULL / 4);
+	CHECK(!frs.isEnable[refVolts]);
+	CHECK(frs.isEnable[fwdVolts]);								// second blink restores the first
+	CHECK_EQ(calCurr.fwd.n, 1);
+	CHECK_EQ(calCurr.fwd.pt[0].code, 3000);
+	CHECK_EQ(calCurr.fwd.pt[0].mW, 47300);
+	CHECK_EQ(calCurr.ref.pt[0].code, 300);
+	CHECK(hostRunUntil([] { return calBlink < 0; }, CAL_BLINK + 1000 / DISP_FPS + 5));
+	CHECK(frs.isEnable[refVolts]);
+}
+
+// reference power steps, up and down through each range back to the same values
+TEST(calPwrSteps)
+{
+	std::vector<int> up = { 1 };
+
+	hostBoot();
+	while (up.back() < CAL_MAX_PWR * 10)
+		up.push_back(calPwrStep(up.back(), 1));
+	CHECK_EQ(calPwrStep(up.back(), 1), CAL_MAX_PWR * 10);
+	CHECK_EQ(calPwrStep(1, -1), 1);
+	for (size_t i = 1; i < up.size(); i++)
+		CHECK_EQ(calPwrStep(up[i], -1), up[i - 1]);
+	CHECK_EQ(calPwrStep(203, 1), 210);							// off step, to the next multiple
+	CHECK_EQ(calPwrStep(203, -1), 200);
+	printf("%d steps 0.1 - %d W\n", (int)up.size() - 1, CAL_MAX_PWR);
+}
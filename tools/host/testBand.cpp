@@ -0,0 +1,124 @@
+// band lookup and CI-V BCD: initBands(), bandFind(), decodeFreq(), encodeFreq()
+
+// band lookup before user-019: hfBand[] in table order, first band containing freq
+static int bandScan(uint32_t freq)
+{
+	for (int i = 0; i < NUM_BANDS; i++)
+		if (freq >= hfBand[i].bandStart && freq <= hfBand[i].bandEnd)
+			return i;
+	return -1;
+}
+
+// each band edge, either side of it, and between bands. binary search gives the scan's band
+static void bandEdgesCheck()
+{
+	for (int i = 0; i < NUM_BANDS; i++)
+	{
+		const freqband& b = hfBand[i];
+
+		for (uint32_t f : { b.bandStart - 1, b.bandStart, b.bandStart + 1, (b.bandStart + b.bandEnd) / 2,
+			b.bandEnd - 1, b.bandEnd, b.bandEnd + 1, b.ft8Freq })
+			if (bandFind(f) != bandScan(f))
+			{
+				printf("band %d freq %u find %d scan %d\n", i, f, bandFind(f), bandScan(f));
+				CHECK(false);
+			}
+		CHECK_EQ(bandFind(b.bandStart), i);
+		CHECK_EQ(bandFind(b.bandEnd), i);
+	}
+	for (uint32_t f : { 0u, 1u, 0xFFFFFFFFu })
+		CHECK_EQ(bandFind(f), -1);
+
+	uint32_t seed = 1;
+	for (int i = 0; i < 100000; i++)
+	{
+		seed = seed * 1664525 + 1013904223;
+		uint32_t f = seed % 60000000;
+		CHECK_EQ(bandFind(f), bandScan(f));
+	}
+}
+
+// edges from the compiled table, then from the table reversed: initBands() sorts any order
+TEST(bandEdges)
+{
+	hostBoot();
+	bandEdgesCheck();
+
+	std::reverse(hfBand, hfBand + NUM_BANDS);
+	initBands();
+	bandEdgesCheck();
+}
+
+// radio dialled to each band edge and just outside: freq decoded from the transceive frame, band from it
+TEST(bandDial)
+{
+	hostBoot();
+	hostRun(1000);
+	for (int i = 0; i < NUM_BANDS; i++)
+		for (uint32_t f : { hfBand[i].bandStart - 1, hfBand[i].bandStart, hfBand[i].bandEnd, hfBand[i].bandEnd + 1 })
+		{
+			radio.dial(f);
+			hostRun(100);
+			CHECK_EQ(getFreq(), f);
+			CHECK_EQ(getBand(getFreq()), bandScan(f));
+		}
+}
+
+// tables against nibble arithmetic, every byte. freq through encodeFreq() and decodeFreq() and the sim
+TEST(bcdRoundTrip)
+{
+	for (int n = 0; n < 256; n++)
+		CHECK_EQ(getBCD(n), (n >> 4) * 10 + (n & 0x0F));
+	CHECK_EQ(getBCD(0x159), 59);									// char sign extended, low byte only
+	for (int n = 0; n < 100; n++)
+	{
+		CHECK_EQ(putBCD(n), (n / 10) << 4 | n % 10);
+		CHECK_EQ(getBCD(putBCD(n)), n);
+	}
+
+	std::vector<uint32_t> freqs = { 0, 1, 9, 10, 99, 100, 99999999, 50313000, 1234567 };
+	for (int i = 0; i < NUM_BANDS; i++)
+		for (uint32_t f : { hfBand[i].bandStart, hfBand[i].bandEnd, hfBand[i].ft8Freq })
+			freqs.push_back(f);
+	for (uint32_t f : freqs)
+	{
+		char cmd[CIV_BUFF] = {}, reply[CIV_BUFF] = {};
+		std::vector<uint8_t> sim;
+
+		encodeFreq(cmd, f);											// write freq: data in [1] - [5]
+		civSim::bcd(sim, f, 5, true);
+		for (int i = 0; i < 5; i++)
+		{
+			CHECK_EQ((uint8_t)cmd[1 + i], sim[i]);
+			reply[5 + i] = cmd[1 + i];								// reply frame: data in [5] - [9]
+		}
+		CHECK_EQ(civSim::unbcd((uint8_t*)cmd + 1, 5, true), f);
+		CHECK_EQ(decodeFreq(reply), f);
+	}
+}
+
+// lookups per freq, binary search vs scan of NUM_BANDS. host
+BENCH(bandLookup)
+{
+	const int n = 2000000;
+	std::vector<uint32_t> fs(n);
+	uint32_t seed = 1;
+	long sum[2] = {};
+	double t[2];
+
+	hostBoot();
+	for (int i = 0; i < n; i++)
+	{
+		seed = seed * 1664525 + 1013904223;
+		fs[i] = seed % 60000000;
+	}
+	for (int m = 0; m < 2; m++)
+	{
+		double wall = hostWall();
+		for (int i = 0; i < n; i++)
+			sum[m] += m ? bandScan(fs[i]) : bandFind(fs[i]);
+		t[m] = (hostWall() - wall) * 1e9 / n;
+	}
+	printf("random freqs 0 - 60 MHz, %d bands: binary %.1f ns, scan %.1f ns per lookup, host. same bands %s\n",
+		NUM_BANDS, t[0], t[1], sum[0] == sum[1] ? "yes" : "NO");
+}
@@ -0,0 +1,346 @@
+// CI-V transport: 4_civ.ino parser, retries, write read back. autoband.ino
+
+// bytes into the parser, as from the bus
+static void civIn(std::initializer_list<int> bytes)
+{
+	for (int c : bytes)
+		civParse(c);
+}
+
+// transceive frame from the radio, 14.074 MHz
+#define CIV_BCST_14074 0xFE, 0xFE, 0x00, CIVRADIO, 0x00, 0x00, 0x40, 0x07, 0x14, 0x00, 0xFD
+
+// frames found after noise, extra preamble, broken frames. others' frames ignored
+TEST(civParser)
+{
+	hostBoot(false);
+	civState = CIV_IDLE;										// no command of ours in progress
+	civQueN = 0;
+	civSlots[CIV_FREQ].n = 0;
+
+	civIn({ 0x12, 0xFD, 0xFE, 0x00, CIV_BCST_14074 });			// noise, lone preamble byte
+	CHECK_EQ(getFreq(), 14074000);
+	CHECK(isCivTransceive);
+
+	civSlots[CIV_FREQ].n = 0;
+	civIn({ 0xFE, 0xFE, CIV_BCST_14074 });						// extra preamble
+	CHECK_EQ(getFreq(), 14074000);
+
+	civSlots[CIV_FREQ].n = 0;
+	civIn({ 0xFE, 0xFE, 0x00, CIVRADIO, 0x00, 0x00, 0x00, 0x00, 0x21 });	// cut short, new frame
+	civIn({ 0xFE, 0xFE, CIVADDR, CIVRADIO, 0x03, 0x00, 0x00, 0x10, 0x18, 0x00, 0xFD });
+	CHECK_EQ(getFreq(), 18100000);
+
+	civIn({ 0xFE, 0xFE, 0xE0, CIVRADIO, 0x03, 0x00, 0x00, 0x07, 0x07, 0x00, 0xFD });	// reply to another controller
+	CHECK_EQ(getFreq(), 18100000);
+	civIn({ 0xFE, 0xFE, 0x00, 0xE0, 0x00, 0x00, 0x00, 0x07, 0x07, 0x00, 0xFD });	// not from radio
+	CHECK_EQ(getFreq(), 18100000);
+
+	civIn({ 0xFE, 0xFE, 0x00, CIVRADIO, 0x00, 0x00, 0x00, 0x07 });	// jammed by collision
+	civIn({ 0xFC, 0x07, 0x00, 0xFD });
+	CHECK_EQ(getFreq(), 18100000);
+	CHECK_EQ(civRxN, 0);
+
+	civIn({ 0xFE, 0xFE });										// longer than any frame
+	for (int i = 0; i < CIV_BUFF; i++)
+		civParse(0x00);
+	CHECK_EQ(civRxN, 0);
+	civIn({ 0xFD });
+	CHECK_EQ(getFreq(), 18100000);
+}
+
+// collision during our command: resent, then completes
+TEST(civCollision)
+{
+	hostBoot();
+	hostRun(500);
+	hostRunUntil([] { return civQueN == 0 && civState == CIV_IDLE; }, 1000);
+	unsigned long resends = civResends, ok = civCmdsOk;
+
+	radio.isOn = false;											// bus jammed while command sent
+	radio.txPwr = 77;
+	civStale(CIV_TXPWR);
+	hostRunUntil([] { return civState == CIV_ECHO; }, 1000);
+	civParse(0xFC);
+	CHECK_EQ(civResends, resends + 1);
+	CHECK_EQ(civState, CIV_IDLE);
+
+	radio.isOn = true;
+	hostRunUntil([] { return !civSettling(CIV_TXPWR); }, 1000);
+	CHECK_EQ(civCmdsOk, ok + 1);
+	CHECK_EQ(civGet(CIV_TXPWR)->n, 9);
+	CHECK_EQ(getBCD(civGet(CIV_TXPWR)->buff[7]), 77);
+}
+
+// radio off: each read sent 1 + CIV_RETRIES times, then slot cleared. back on, values return
+TEST(civTimeout)
+{
+	hostBoot();
+	hostRun(500);
+	CHECK_EQ(getFreq(), 14074000);
+	hostRunUntil([] { return civQueN == 0 && civState == CIV_IDLE; }, 1000);
+	unsigned long fails = civCmdsFail, resends = civResends;
+	uint32_t start = hostMs();
+
+	radio.isOn = false;
+	civStale(CIV_FREQ);
+	CHECK(hostRunUntil([] { return getFreq() == 0; }, 2000));
+	CHECK_NEAR(hostMs() - start, CIVTIMEOUT * (CIV_RETRIES + 1), 2 * CIVTIMEOUT);
+	CHECK_EQ(civCmdsFail, fails + 1);
+	CHECK_EQ(civResends, resends + CIV_RETRIES);
+
+	radio.isOn = true;
+	CHECK(hostRunUntil([] { return getFreq() == 14074000; }, 5000));
+}
+
+// write then read back: slot settling until the new value is read, not just until written
+TEST(civWriteRead)
+{
+	hostBoot();
+	radio.replyUs = 80000;										// slow radio, inside CIVTIMEOUT
+	hostRun(2000);
+	hostRunUntil([] { return civQueN == 0 && civState == CIV_IDLE; }, 2000);
+
+	encodeFreq(civWriteFreq, 7074000);
+	civWriteBack(civWriteFreq, CIV_FREQ);
+	CHECK(civSettling(CIV_FREQ));
+	hostRunUntil([] { return radio.freqNow() == 7074000; }, 1000);
+	CHECK(civSettling(CIV_FREQ));								// written, old value in slot
+	CHECK_EQ(getFreq(), 14074000);
+	CHECK(hostRunUntil([] { return !civSettling(CIV_FREQ); }, 2000));
+	CHECK_EQ(getFreq(), 7074000);
+}
+
+// autoband moves to the next band and stays on, although freq reads are in flight when it
+// writes, and the radio is slow to read back. freq changed at the radio turns it off
+TEST(autobandOwnWrite)
+{
+	hostBoot();
+	radio.replyUs = 60000;
+	civRates[CIV_FREQ].interval = 1;							// freq read always in progress
+	aBandPar.val = 2;
+	hostRun(1000);
+	CHECK(frs.isEnable[aBand]);
+	aBandButton(1);
+	CHECK(lab[aBand].stat);
+
+	CHECK(hostRunUntil([] { return radio.freqNow() == 18100000; }, 4000));
+	hostRun(1000);
+	CHECK_EQ(getFreq(), 18100000);
+	CHECK(lab[aBand].stat);
+
+	CHECK(hostRunUntil([] { return radio.freqNow() == 21074000; }, 3000));	// and on, next band
+	hostRun(1000);
+	CHECK(lab[aBand].stat);
+
+	radio.dial(7100000);
+	hostRun(300);
+	CHECK(!lab[aBand].stat);
+	hostRun(3000);
+	CHECK_EQ(radio.freqNow(), 7100000);
+}
+
+#if CIV_STATS
+// bus report only when asked, never into a sample stream or trace
+TEST(civStatsCmd)
+{
+	hostBoot();
+	size_t from = Serial.tx.size();
+	hostRun(25000);
+	CHECK(hostUsb(from).find("CIV") == std::string::npos);
+
+	hostCmd("b");
+	hostRun(100);
+	std::string s = hostUsb(from);
+	CHECK(s.find("CIV bus: ") != std::string::npos);
+	CHECK(s.find("freq: ") != std::string::npos);
+	CHECK(s.find("CIV cmds: ") != std::string::npos);
+}
+#endif
+
+// every polled value requested, as civRequest() did each loop() pass before the cache
+static void civRequestAll()
+{
+	for (int slot : { CIV_FREQ, CIV_TUNER, CIV_REF, CIV_TXPWR })
+		if (!civSlots[slot].isPending && civQueue(civSlotCmd[slot], slot))
+			civSlots[slot].isPending = true;
+}
+
+// bus load and freq follow time, from the present state. mode 0: every value requested each loop()
+// pass, as civRequest() did before the cache (user-006). 1: cache and poll scheduler.
+// tuning: VFO turned every 200 mSecs
+struct civLoad
+{
+	double bytesSec;								// bus bytes / sec, echo and replies
+	double readsSec;								// radio reads / sec
+	double followMs;								// dial to getFreq(), mean
+	double followMax;
+};
+
+static civLoad civLoadRun(int mode, bool isTuning, int secs)
+{
+	civLoad r = {};
+	uint32_t f = 14074000;
+	int turns = 0;
+	uint32_t bytes = radio.busBytes, reads = radio.reads;
+	uint64_t end = hostNs + secs * 1000000000ULL;
+
+	while (hostNs < end)
+	{
+		uint64_t turnNs = hostNs;
+		uint64_t next = hostNs + 200000000ULL;
+		bool isFollowed = !isTuning;
+
+		if (isTuning)
+			radio.dial(f += 500);
+		while (hostNs < next)
+		{
+			if (mode == 0)
+				civRequestAll();
+			loop();
+			hostTick(hostLoopNs);
+			if (!isFollowed && getFreq() == f)
+			{
+				double ms = (hostNs - turnNs) / 1e6;
+				r.followMs += ms;
+				r.followMax = std::max(r.followMax, ms);
+				turns++;
+				isFollowed = true;
+			}
+		}
+	}
+	r.bytesSec = double(radio.busBytes - bytes) / secs;
+	r.readsSec = double(radio.reads - reads) / secs;
+	if (turns)
+		r.followMs /= turns;
+	return r;
+}
+
+// cache: bus well under budget, dial followed from transceive frames
+TEST(civBusBudget)
+{
+	hostBoot();
+	hostRun(1000);
+	civLoad idle = civLoadRun(1, false, 10);
+	CHECK(idle.bytesSec < CIV_BUS_BYTES * CIV_BUS_BUDGET / 100);
+
+	civLoad tune = civLoadRun(1, true, 10);
+	CHECK(tune.bytesSec < CIV_BUS_BYTES * CIV_BUS_BUDGET / 100);
+	CHECK(tune.followMax < 20);
+}
+
+BENCH(civBusLoad)
+{
+	const char* name[] = { "request every pass (before)", "cache, poll scheduler (now)" };
+
+	printf("CI-V bus, 19200 baud, %d bytes/s. IC-7300 sim reply %d uSecs\n", CIV_BUS_BYTES, (int)radio.replyUs);
+	hostBoot();
+	hostRun(1000);
+	for (int mode = 1; mode >= 0; mode--)			// now first, before leaves requests queued
+		for (int tuning = 0; tuning < 2; tuning++)
+		{
+			civLoad r = civLoadRun(mode, tuning, 20);
+			printf("  %-6s %-28s %5.0f bytes/s %4.0f%%  %5.1f reads/s", tuning ? "tuning" : "idle", name[mode],
+				r.bytesSec, r.bytesSec * 100 / CIV_BUS_BYTES, r.readsSec);
+			if (tuning && mode)						// before parsed no transceive frames, not comparable
+				printf("  freq follow %5.1f ms, max %5.1f", r.followMs, r.followMax);
+			printf("\n");
+		}
+}
+
+// transport under faults: reads back to back for secs, firmware latency histogram and counters
+struct civFault
+{
+	const char* name;
+	uint64_t replyUs, jitterUs;
+	int collidePm, dropPm;
+};
+
+struct civLat
+{
+	double cmdsSec;
+	int p50, p99;									// mSecs, histogram bucket edges
+	double timeoutPc;								// commands given up
+	double resendsPc;
+	uint32_t collisions, drops;						// injected
+	uint32_t badFreqs;								// loop() passes with a wrong getFreq(), not 0
+};
+
+static civLat civFaultRun(const civFault& f, int secs)
+{
+	civLat r = {};
+	uint32_t freq = radio.freqNow();
+
+	hostBoot();
+	hostRun(1000);
+	radio.replyUs = f.replyUs;
+	radio.jitterUs = f.jitterUs;
+	radio.collidePm = f.collidePm;
+	radio.dropPm = f.dropPm;
+	hostRunUntil([] { return civQueN == 0 && civState == CIV_IDLE; }, 1000);
+	memset(civLatHist, 0, sizeof(civLatHist));
+	civCmdsOk = civCmdsFail = civResends = 0;
+
+	uint64_t end = hostNs + secs * 1000000000ULL;
+	while (hostNs < end)
+	{
+		civRequestAll();
+		loop();
+		hostTick(hostLoopNs);
+		r.badFreqs += getFreq() && getFreq() != freq;
+	}
+	unsigned long cmds = civCmdsOk + civCmdsFail;
+	r.cmdsSec = double(cmds) / secs;
+	r.p50 = civLatPercent(50);
+	r.p99 = civLatPercent(99);
+	r.timeoutPc = cmds ? civCmdsFail * 100.0 / cmds : 0;
+	r.resendsPc = cmds ? civResends * 100.0 / cmds : 0;
+	r.collisions = radio.collisions;
+	r.drops = radio.drops;
+	return r;
+}
+
+static const civFault civFaults[] = {
+	{ "clean",				5000,	0,		0,		0 },
+	{ "jitter 0-40 ms",		5000,	40000,	0,		0 },
+	{ "slow 60-100 ms",		60000,	40000,	0,		0 },
+	{ "collisions 5%",		5000,	0,		50,		0 },
+	{ "bytes lost 0.5%",	5000,	0,		0,		5 },
+	{ "jitter, coll, lost",	5000,	40000,	50,		5 },
+};
+
+// collisions and lost bytes resent, few commands given up. every value still read
+TEST(civFaultRecovery)
+{
+	civLat r = civFaultRun(civFaults[5], 20);
+
+	CHECK(r.collisions > 0 && r.drops > 0);
+	CHECK(r.cmdsSec > 20);
+	CHECK(r.timeoutPc < 2);
+	CHECK(r.p50 <= 40);
+	CHECK_EQ(r.badFreqs, 0);
+	for (int slot : { CIV_FREQ, CIV_TUNER, CIV_REF, CIV_TXPWR })
+		CHECK(millis() - civSlots[slot].time < 1000);
+	CHECK_EQ(getFreq(), 14074000);
+}
+
+BENCH(civLatency)
+{
+	printf("CI-V reads back to back, 30 s each, IC-7300 sim. latency first send to reply, resends included\n");
+	printf("  %-20s %8s %6s %6s %9s %8s %6s %6s\n", "faults", "cmds/s", "p50", "p99", "timeouts", "resends", "coll", "lost");
+	for (const civFault& f : civFaults)
+	{
+		pid_t pid;
+
+		fflush(stdout);
+		if ((pid = fork()) == 0)					// each from power on
+		{
+			civLat r = civFaultRun(f, 30);
+			printf("  %-20s %8.1f %3d ms %3d ms %8.2f%% %7.1f%% %6u %6u\n", f.name, r.cmdsSec, r.p50, r.p99,
+				r.timeoutPc, r.resendsPc, r.collisions, r.drops);
+			fflush(stdout);
+			_exit(0);
+		}
+		waitpid(pid, nullptr, 0);
+	}
+}
@@ -0,0 +1,131 @@
+// value display: 1_display.ino glyph cache, cells
+
+// glyph cells off, every font drawn from font data as before user-010's cells
+static void glyphCellsOff()
+{
+	for (int i = 0; i < NUM_GLYPH_FONTS; i++)
+		glyphs[i].bmp = NULL;
+}
+
+// region of the frame buffer
+static std::vector<uint16_t> tftRegion(int x, int y, int w, int h)
+{
+	std::vector<uint16_t> r;
+
+	for (int j = y; j < y + h; j++)
+		for (int i = x; i < x + w; i++)
+			r.push_back(tft.fb[j][i]);
+	return r;
+}
+
+// cells give the same pixels as the font. nettPwr, peakPwr, swr fonts have cells, first used at boot
+TEST(glyphCells)
+{
+	hostBoot();
+	for (int posn : { nettPwr, peakPwr, swr })
+	for (const char* str : { "-01234", "56789." })			// fits across the screen
+	{
+		const ILI9341_t3_font_t& font = *val[posn].font;
+		glyphCache* gPtr = glyphFind(font);
+		int x = 10, y = 100;
+
+		CHECK(gPtr && gPtr->bmp);
+		tft.fillRect(0, y - 10, 320, gPtr->h + 20, BLUE);
+		int len = glyphDraw(gPtr, str, x, y, ORANGE, BLACK);
+		CHECK_EQ(len, glyphLen(gPtr, str, VAL_DIGITS));
+		std::vector<uint16_t> cells = tftRegion(0, y - 10, 320, gPtr->h + 20);
+
+		tft.fillRect(0, y - 10, 320, gPtr->h + 20, BLUE);
+		tft.fillRect(x, y - 2, len, gPtr->h, BLACK);
+		tft.setFont(font);
+		tft.setTextColor(ORANGE);
+		tft.setCursor(x, y);
+		tft.print(str);
+		CHECK(cells == tftRegion(0, y - 10, 320, gPtr->h + 20));
+	}
+	CHECK(glyphPoolUsed <= GLYPH_POOL);
+	glyphCache* gPtr = glyphFind(*val[dBm].font);			// FONT48, pool full, drawn from font data
+	CHECK(gPtr && gPtr->bmp == NULL);
+	CHECK(glyphFind(*val[fwdPwr].font)->bmp == NULL);			// small font, drawn from font data
+}
+
+// value changes: same frame buffer with cells as from font data. width changes, shorter, forced
+TEST(displayValueCells)
+{
+	const float seq[] = { 0, 5, 12, 99, 100, 87, 88, 1000, 7, -3, -12, 0, 1.5, 150, 151 };
+	uint32_t digest[2];
+
+	hostBoot();
+	hostRun(500);
+	std::vector<uint16_t> fb(&tft.fb[0][0], &tft.fb[0][0] + 240 * 320);
+	std::vector<value> vals(val, val + NUM_FRAMES);
+	for (int pass = 0; pass < 2; pass++)
+	{
+		std::copy(fb.begin(), fb.end(), &tft.fb[0][0]);
+		std::copy(vals.begin(), vals.end(), val);
+		if (pass)
+			glyphCellsOff();
+		for (int i = 0; i < (int)(sizeof(seq) / sizeof(seq[0])); i++)
+		{
+			if (i == 9)
+				val[swr].isUpdate = true;
+			displayValue(nettPwr, seq[i]);
+			displayValue(swr, seq[i] / 10);
+			displayValue(dBm, seq[i] / 3);
+		}
+		digest[pass] = tft.digest();
+	}
+	CHECK_EQ(digest[0], digest[1]);
+}
+
+// nettPwr, peakPwr, swr at the display frame rate. SSB voice power, peak held 500 mSecs, swr 1.1 - 1.3
+// SPI time from the mock ILI9341 model. before: every glyph decoded and drawn from font data
+BENCH(valueUpdates)
+{
+	const int frames = 5000;
+	const char* name[] = { "glyph cells (now)", "font data (before)" };
+	ssbEnvelope sig(DISP_FPS);
+	std::vector<float> nett(frames), peak(frames), swrV(frames);
+	float pk = 0;
+
+	for (int i = 0; i < frames; i++)
+	{
+		uint16_t f, r;
+
+		sig.next(f, r);
+		nett[i] = f / 40;									// 0 - 100 W
+		if (i % (DISP_FPS / 2) == 0 || nett[i] > pk)
+			pk = nett[i];
+		peak[i] = pk;
+		swrV[i] = 1.1 + (r % 21) / 100.0;
+	}
+
+	hostBoot();
+	hostRun(500);
+	std::vector<uint16_t> fb(&tft.fb[0][0], &tft.fb[0][0] + 240 * 320);
+	std::vector<value> vals(val, val + NUM_FRAMES);
+
+	printf("displayValue() at %d fps, %d frames. SPI time modelled, %u ns / pixel, %u ns / transaction\n",
+		DISP_FPS, frames, hostPixelNs, hostCallNs2);
+	for (int pass = 0; pass < 2; pass++)
+	{
+		std::copy(fb.begin(), fb.end(), &tft.fb[0][0]);
+		std::copy(vals.begin(), vals.end(), val);
+		if (pass)
+			glyphCellsOff();
+		hostTftStats s0 = hostTft;
+		uint64_t ns = hostNs;
+		double wall = hostWall();
+		for (int i = 0; i < frames; i++)
+		{
+			displayValue(nettPwr, nett[i]);
+			displayValue(peakPwr, peak[i]);
+			displayValue(swr, swrV[i]);
+		}
+		wall = hostWall() - wall;
+		double perFrame = (hostNs - ns) / 1e3 / frames;	// uSecs
+		printf("  %-20s %7.1f uSecs / frame, %6.0f frames/s max, %7.0f pixels, %5.1f transactions / frame, host %.2f uSecs\n",
+			name[pass], perFrame, 1e6 / perFrame, double(hostTft.pixels - s0.pixels) / frames,
+			double(hostTft.calls - s0.calls) / frames, wall * 1e6 / frames);
+	}
+}
@@ -0,0 +1,234 @@
+// EEPROM: eeProm.ino write-back cache, header, record CRCs, A / B slots, migration
+
+// cal curve with one point each way, band b
+static eeCal eeCalCurve(int b)
+{
+	eeCal cal = {};
+
+	cal.fwd.n = 1;
+	cal.fwd.pt[0] = { 50000u + b, 2000 };
+	cal.ref.n = 1;
+	cal.ref.pt[0] = { 5000u + b, 600 };
+	return cal;
+}
+
+// EEPROM image as the current layout, params changed from compiled values
+static void eeImage()
+{
+	samplesDefPar.val = 40;
+	aBandPar.val = 77;
+	hfProm[3].sRef = -12.5;
+	eeDirty = 0xFFFFFFFF;
+	eeFlush();
+	for (int i = 0; i < NUM_BANDS; i++)
+	{
+		eeCal cal = eeCalCurve(i);
+		putCalEEPROM(i, cal);
+	}
+	samplesDefPar.val = 5;										// compiled values, boot reads EEPROM
+	aBandPar.val = 120;
+	hfProm[3].sRef = 0;
+}
+
+static bool eeCalSame(int b)
+{
+	eeCal want = eeCalCurve(b), got;
+
+	return getCalEEPROM(b, got) && got.fwd.n == 1 && got.ref.n == 1
+		&& got.fwd.pt[0].mW == want.fwd.pt[0].mW && got.fwd.pt[0].code == want.fwd.pt[0].code
+		&& got.ref.pt[0].mW == want.ref.pt[0].mW && got.ref.pt[0].code == want.ref.pt[0].code;
+}
+
+// blank EEPROM gets compiled values, header and CRCs. next boot reads them back
+TEST(eeBlank)
+{
+	hostBoot();
+	CHECK_EQ(EEPROM.read(0), EE_MAGIC);
+	CHECK_EQ(EEPROM.read(1), EE_VERSION);
+	param p;
+	CHECK(eeRead(samplesDefPar.eeAddr, &p, sizeof(p), false));
+	CHECK_EQ(p.val, 5);
+	eeCal cal;
+	for (int i = 0; i < NUM_BANDS; i++)
+	{
+		CHECK(getCalEEPROM(i, cal));
+		CHECK_EQ(cal.fwd.n, 0);
+	}
+}
+
+// current layout read as written, nothing rewritten
+TEST(eeReadBack)
+{
+	eeImage();
+	uint32_t writes = EEPROM.writes;
+	hostBoot();
+	CHECK_EQ(samplesDefPar.val, 40);
+	CHECK_EQ(aBandPar.val, 77);
+	CHECK_NEAR(hfProm[3].sRef, -12.5, 0);
+	for (int i = 0; i < NUM_BANDS; i++)
+		CHECK(eeCalSame(i));
+	CHECK_EQ(EEPROM.writes, writes);
+}
+
+// bad CRC: param keeps compiled value and is rewritten, cal record gives no points
+TEST(eeBadCrc)
+{
+	eeImage();
+	EEPROM.write(aBandPar.eeAddr, EEPROM.read(aBandPar.eeAddr) ^ 0x10);
+	EEPROM.write(EEADDR_CAL + sizeof(eeCal) * 4 + 8, 0x55);		// band 4 fwd point
+	hostBoot();
+	CHECK_EQ(aBandPar.val, 120);
+	CHECK_EQ(samplesDefPar.val, 40);
+	param p;
+	CHECK(eeRead(aBandPar.eeAddr, &p, sizeof(p), false));		// rewritten at boot
+	CHECK_EQ(p.val, 120);
+
+	eeCal cal;
+	CHECK(!getCalEEPROM(4, cal));
+	CHECK_EQ(cal.fwd.n, 0);
+	CHECK(eeCalSame(3));
+	calLoad(4);
+	CHECK(chan[CH_MAIN].fwdTbl == fwdPwrTbl.mW);					// compiled table
+	calLoad(3);
+	CHECK(chan[CH_MAIN].fwdTbl == calFwdTbl);
+}
+
+// v004: EEPROM(0) = 1, no CRCs anywhere, no cal records or calPwrPar. values kept, CRCs and header added
+TEST(eeMigrateV004)
+{
+	eeImage();
+	EEPROM.write(0, EE_OLD_FLAG);
+	EEPROM.write(1, 0xFF);
+	for (int i = 0; i < NUM_PARS; i++)
+		EEPROM.write(eePars[i]->eeAddr + EEINCR - 1, 0xFF);		// CRC bytes were unused
+	for (int i = 0; i < NUM_BANDS; i++)
+		EEPROM.write(EEADDR_BAND + EEINCR * i + EEINCR - 1, 0xFF);
+	for (int a = EEADDR_CAL; a < EEADDR_CALCRC + NUM_BANDS; a++)
+		EEPROM.write(a, 0xFF);
+	for (int a = calPwrPar.eeAddr; a < calPwrPar.eeAddr + EEINCR; a++)
+		EEPROM.write(a, 0xFF);
+	hostBoot();
+	CHECK_EQ(EEPROM.read(0), EE_MAGIC);
+	CHECK_EQ(EEPROM.read(1), EE_VERSION);
+	CHECK_EQ(samplesDefPar.val, 40);
+	CHECK_EQ(aBandPar.val, 77);
+	CHECK_EQ(calPwrPar.val, 100);								// compiled value
+	CHECK_EQ(calPwrPar.eeAddr, EEADDR_PARAM2);
+	param p;
+	CHECK(eeRead(aBandPar.eeAddr, &p, sizeof(p), false));
+	CHECK(eeRead(calPwrPar.eeAddr, &p, sizeof(p), false));
+	eeCal cal;
+	for (int i = 0; i < NUM_BANDS; i++)
+	{
+		CHECK(getCalEEPROM(i, cal));
+		CHECK_EQ(cal.fwd.n, 0);
+	}
+}
+
+// each change goes to the other slot, newest read back. unchanged record not written
+TEST(eeSlots)
+{
+	hostBoot();
+	int a = aBandPar.eeAddr;
+	CHECK_EQ(eeSlot(a, sizeof(param)), a);
+	for (int i = 0; i < 6; i++)
+	{
+		aBandPar.val = 200 + i;
+		eeWrite(a, &aBandPar, sizeof(param));
+		CHECK_EQ(eeSlot(a, sizeof(param)), i % 2 ? a : a + EE_ALT);
+		param p;
+		CHECK(eeRead(a, &p, sizeof(p), false));
+		CHECK_EQ(p.val, 200 + i);
+	}
+	uint32_t writes = EEPROM.writes;
+	eeWrite(a, &aBandPar, sizeof(param));
+	CHECK_EQ(EEPROM.writes, writes);
+
+	for (int i = 0; i < 300; i++)								// sequence byte wraps
+	{
+		aBandPar.val = i;
+		eeWrite(a, &aBandPar, sizeof(param));
+	}
+	param p;
+	CHECK(eeRead(a, &p, sizeof(p), false));
+	CHECK_EQ(p.val, 299);
+}
+
+// reset after each byte of a record write: old value read until the sequence byte is written, then new
+TEST(eePowerFail)
+{
+	eeImage();
+	hostBoot();
+	int a = aBandPar.eeAddr;
+	std::vector<uint8_t> image(EEPROM.mem, EEPROM.mem + HOST_EE_SIZE);
+
+	for (int side = 0; side < 2; side++)						// write to B, then to A
+	{
+		aBandPar.val = 1000 + side;
+		uint32_t from = EEPROM.writes;
+		eeWrite(a, &aBandPar, sizeof(param));
+		uint32_t n = EEPROM.writes - from;
+		std::vector<uint8_t> done(EEPROM.mem, EEPROM.mem + HOST_EE_SIZE);
+		CHECK(n > 1);
+
+		for (uint32_t k = 0; k <= n; k++)
+		{
+			param p;
+
+			memcpy(EEPROM.mem, image.data(), HOST_EE_SIZE);
+			EEPROM.writes = 0;
+			EEPROM.powerFail = k;
+			eeWrite(a, &aBandPar, sizeof(param));
+			EEPROM.powerFail = UINT32_MAX;
+			CHECK(eeRead(a, &p, sizeof(p), false));
+			CHECK_EQ(p.val, k < n ? (side ? 1000 : 77) : 1000 + side);
+		}
+		memcpy(image.data(), done.data(), HOST_EE_SIZE);
+		memcpy(EEPROM.mem, done.data(), HOST_EE_SIZE);
+	}
+}
+
+// changes written EE_DELAY after the last one, in one flush
+TEST(eeDelayed)
+{
+	hostBoot();
+	hostRun(100);
+	unsigned long flushes = eeFlushes;
+	for (int i = 0; i < 10; i++)
+	{
+		aBandPar.val = 100 + i;
+		putParEEPROM(aBandPar);
+		hostRun(EE_DELAY / 4);
+	}
+	param p;
+	CHECK(eeRead(aBandPar.eeAddr, &p, sizeof(p), false));
+	CHECK_EQ(p.val, 120);										// not yet
+	hostRun(EE_DELAY + 200);
+	CHECK_EQ(eeFlushes - flushes, 1);
+	CHECK(eeRead(aBandPar.eeAddr, &p, sizeof(p), false));
+	CHECK_EQ(p.val, 109);
+}
+
+// long touch on peak power restarts the meter. waiting changes written first
+TEST(eeRestartFlush)
+{
+	bool isRestart = false;
+
+	hostBoot();
+	hostRun(100);
+	aBandPar.val = 90;
+	putParEEPROM(aBandPar);
+	try
+	{
+		peakPwrButton(2);
+	}
+	catch (hostRestart&)
+	{
+		isRestart = true;
+	}
+	CHECK(isRestart);
+	param p;
+	CHECK(eeRead(aBandPar.eeAddr, &p, sizeof(p), false));
+	CHECK_EQ(p.val, 90);
+	CHECK_EQ(eeDirty, 0);
+}
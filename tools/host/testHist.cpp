@@ -0,0 +1,162 @@
+// power / SWR history: history.ino rings and trend graph
+
+// rings empty, first second ends 1 sec from now
+static void histReset()
+{
+	for (int r = 0; r < NUM_HIST; r++)
+	{
+		hist[r].n = 0;
+		memset(&hist[r].acc, 0, sizeof(histAcc));
+	}
+	histTime = millis() + 1000;
+}
+
+// test signal, steady within a minute: 2 - 20 W, SWR 1.0 - 1.8
+static uint32_t histMinPwr(uint32_t m)
+{
+	return 2000 * (1 + m % 10);
+}
+
+static int histMinSwr(uint32_t m)
+{
+	return 100 + 20 * (m % 5);
+}
+
+// secs of results, 5 per second mid 200 mSec slot, clock only (no measure())
+static void histFeed(uint32_t from, uint32_t secs)
+{
+	for (uint32_t s = from; s < from + secs; s++)
+		for (int i = 0; i < 5; i++)
+		{
+			hostTick(100000000);
+			histAdd(histMinPwr(s / 60), histMinSwr(s / 60));
+			hostTick(100000000);
+		}
+}
+
+// 12 hours and 30 mins: seconds ring holds the last 10 mins, minute ring the last 12 hours,
+// oldest points overwritten, every point min / mean / max of its own second or minute
+TEST(histRings)
+{
+	const uint32_t secs = 750 * 60;
+
+	hostBoot();
+	hostTimersOff = true;
+	histReset();
+	histFeed(0, secs);
+	hostTick(100000000);
+	histAdd(0, 100);												// last second pushed
+	CHECK_EQ(hist[HIST_SEC].n, secs);
+	CHECK_EQ(hist[HIST_MIN].n, secs / 60);
+
+	for (uint32_t s = secs - HIST_SECS; s < secs; s++)
+	{
+		const histPt& p = hist[HIST_SEC].pt[s % HIST_SECS];
+		uint8_t pc = histPwr(histMinPwr(s / 60)), sc = histSwr(histMinSwr(s / 60));
+
+		if (p.pMin != pc || p.pMean != pc || p.pMax != pc || p.sMin != sc || p.sMean != sc || p.sMax != sc)
+		{
+			printf("second %u: %d %d %d  %d %d %d\n", s, p.pMin, p.pMean, p.pMax, p.sMin, p.sMean, p.sMax);
+			CHECK(false);
+		}
+	}
+	for (uint32_t m = secs / 60 - HIST_MINS; m < secs / 60; m++)
+	{
+		const histPt& p = hist[HIST_MIN].pt[m % HIST_MINS];
+		uint8_t pc = histPwr(histMinPwr(m)), sc = histSwr(histMinSwr(m));
+
+		if (p.pMin != pc || p.pMean != pc || p.pMax != pc || p.sMin != sc || p.sMean != sc || p.sMax != sc)
+		{
+			printf("minute %u: %d %d %d  %d %d %d\n", m, p.pMin, p.pMean, p.pMax, p.sMin, p.sMean, p.sMax);
+			CHECK(false);
+		}
+	}
+}
+
+// mean is linear power, min / max from the results, swr from carrier results only
+TEST(histPoint)
+{
+	hostBoot();
+	hostTimersOff = true;
+	histReset();
+	const uint32_t mW[] = { 100000, 0, 0, 0, 0 };					// one 100 W result, rest key up
+	for (uint32_t w : mW)
+	{
+		hostTick(100000000);
+		histAdd(w, w ? 250 : 100);
+		hostTick(100000000);
+	}
+	for (int i = 0; i < 5; i++)										// second with no carrier
+	{
+		hostTick(200000000);
+		histAdd(0, 100);
+	}
+	hostTick(100000000);
+	histAdd(0, 100);
+
+	CHECK_EQ(hist[HIST_SEC].n, 2);
+	const histPt& p = hist[HIST_SEC].pt[0];
+	CHECK_EQ(p.pMin, 0);
+	CHECK_EQ(p.pMax, histPwr(100000));
+	CHECK_EQ(p.pMean, histPwr(20000));								// 43 dBm, not the mean of codes
+	CHECK_EQ(p.sMin, histSwr(250));
+	CHECK_EQ(p.sMean, histSwr(250));
+	const histPt& q = hist[HIST_SEC].pt[1];
+	CHECK_EQ(q.pMax, 0);
+	CHECK_EQ(q.sMax, 0);											// no swr drawn
+}
+
+// graph open: one column drawn per HIST_PPC secs, nothing redrawn
+TEST(histGraph)
+{
+	hostBoot();
+	hostCarrier(3000, 300);
+	hostRun(40000);
+	hostTouchFrame(nettPwrMeter, 900);								// long touch opens the graph
+	hostRun(1000);
+	CHECK_EQ(histView, HIST_SEC);
+	CHECK(hostRunUntil([] { return histCol == hist[HIST_SEC].n / HIST_PPC; }, 2000));
+
+	uint32_t col = histCol;
+	hostRun(HIST_PPC * 1000 * 10);
+	CHECK_NEAR(histCol - col, 10, 1);
+
+	uint64_t px = hostTft.pixels;
+	histColumn(histCol - 1);
+	px = hostTft.pixels - px;
+	uint64_t full = hostTft.pixels;
+	histShow(HIST_SEC);
+	while (histCol < hist[HIST_SEC].n / HIST_PPC)
+		histDraw();
+	full = hostTft.pixels - full;
+	printf("new column %llu pixels, graph redrawn %llu pixels\n", (unsigned long long)px,
+		(unsigned long long)full);
+	CHECK(px * 20 < full);
+}
+
+// histAdd() per measure() result as the rings fill and wrap. host
+BENCH(histAddCost)
+{
+	printf("rings %u bytes (%d + %d points of %u bytes)\n", (unsigned)(sizeof(histSecs) + sizeof(histMins)),
+		HIST_SECS, HIST_MINS, (unsigned)sizeof(histPt));
+	hostBoot();
+	hostTimersOff = true;
+	histReset();
+	for (int hour = 0; hour < 14; hour++)
+	{
+		uint64_t tsc = 0, calls = 0;
+
+		for (int s = 0; s < 3600; s++)
+			for (int i = 0; i < 500; i++)								// measure() every 2 mSecs
+			{
+				hostTick(2000000);
+				uint64_t t = __rdtsc();
+				histAdd(histMinPwr(hour * 60 + s / 60), histMinSwr(s / 60));
+				tsc += __rdtsc() - t;
+				calls++;
+			}
+		if (hour == 0 || hour == 1 || hour == 11 || hour == 12 || hour == 13)
+			printf("  hour %2d  %5.1f TSC cycles per histAdd() (rdtsc pair included), minute ring %s\n",
+				hour, (double)tsc / calls, hist[HIST_MIN].n > HIST_MINS ? "wrapped" : "filling");
+	}
+}
@@ -0,0 +1,80 @@
+// fixed point power, dBm, swr: pwrTables.h, 3_measure.ino. float path is pwrCalc() and the
+// FIXED_PWR false code in measure()
+
+// float path for ADC code of direction 'F' or 'R', milliWatts
+static double floatmW(double code, char dir)
+{
+	double v = code * 3.3 / 4095 + (dir == 'F' ? FV_ZEROADJ : RV_ZEROADJ);	// as measure()
+
+	return pwrCalc(v, dir) * 1000.0;
+}
+
+// every 12 bit code, both directions: table against pwrCalc()
+TEST(powerTables)
+{
+	for (char dir : { 'F', 'R' })
+	{
+		const uint32_t* tbl = dir == 'F' ? fwdPwrTbl.mW : refPwrTbl.mW;
+		double maxErr = 0, maxInterp = 0;
+		int maxCode = 0;
+
+		for (int code = 0; code < ADC_CODES; code++)
+		{
+			double f = floatmW(code, dir);
+			double err = fabs(pwrLookup(tbl, 0, code << ADC_FRAC_BITS) - f);
+
+			if (err > maxErr)
+			{
+				maxErr = err;
+				maxCode = code;
+			}
+			// averaged codes between table entries, linear interpolation
+			double half = code + 0.5;
+			double fh = floatmW(half, dir);
+			if (fh >= 1000 && code + 1 < ADC_CODES)
+				maxInterp = std::max(maxInterp, fabs(pwrLookup(tbl, 0, (code << ADC_FRAC_BITS) + (1 << (ADC_FRAC_BITS - 1))) - fh) / fh);
+		}
+		printf("%c: 4096 codes, max error %.3f mW at code %d, half codes over 1 W %.2e relative\n",
+			dir, maxErr, maxCode, maxInterp);
+		CHECK(maxErr <= 1.0);								// table rounds to 1 mW, float has ~7 digits
+		CHECK(maxInterp < 1e-3);
+	}
+}
+
+// dBm x 10 against 10 log10(mW), every mW to 200 W
+TEST(dbmFixed)
+{
+	double maxErr = 0;
+	uint32_t at = 0;
+
+	for (uint32_t mW = 2; mW <= 200000; mW++)
+	{
+		double err = fabs(dbmCalc(mW) * 0.1 - 10 * log10((double)mW));
+		if (err > maxErr)
+		{
+			maxErr = err;
+			at = mW;
+		}
+	}
+	printf("dBm: max error %.3f dB at %u mW\n", maxErr, at);
+	CHECK(maxErr < 0.07);
+}
+
+// swr x 100 against the float formula, peak powers 1 W - 150 W, swr 1.0 - 10
+TEST(swrFixed)
+{
+	double maxErr = 0;
+
+	for (uint32_t f = 1000; f <= 150000; f += 997)
+		for (double rc = 0; rc < 0.82; rc += 0.01)
+		{
+			uint32_t r = f * rc * rc;
+			double rcf = sqrt((double)r / f);
+			double swr = (1 + rcf) / (1 - rcf);
+			double err = fabs(swrCalc(f, r) * 0.01 - swr) / swr;
+
+			maxErr = std::max(maxErr, err);
+		}
+	printf("swr: max error %.3f%%\n", maxErr * 100);
+	CHECK(maxErr < 0.0051);								// 0.005 at swr 1.00, rounding to 0.01
+}
@@ -0,0 +1,41 @@
+// cooperative scheduler: scheduler.ino
+
+#if SCHED_STATS
+// task timing only on 't', nothing printed unasked
+TEST(schedStatsCmd)
+{
+	hostBoot();
+	size_t from = Serial.tx.size();
+	hostRun(25000);
+	CHECK(hostUsb(from).find("TASK") == std::string::npos);
+
+	hostCmd("t");
+	hostRun(100);
+	std::string s = hostUsb(from);
+	CHECK(s.find("LOAD ") != std::string::npos);
+	CHECK(s.find("TASK ") != std::string::npos);
+	CHECK(s.find("measure ") != std::string::npos);
+	CHECK(hostTask(measureTask)->runs <= 100 * MS / hostTask(measureTask)->period);	// cleared by the report
+}
+#endif
+
+// periodic tasks run at their rates with a carrier, none late, measure() inside its budget
+TEST(schedRates)
+{
+	hostBoot();
+	hostCarrier(3000, 300);
+	hostRun(1000);
+	for (int i = 0; i < NUM_TASKS; i++)
+		tasks[i].runs = tasks[i].late = tasks[i].worst = tasks[i].overruns = 0;
+
+	hostRun(5000);
+	for (void (*fn)() : { measureTask, displayTask, radioTask, touchTask })
+	{
+		task* t = hostTask(fn);
+
+		CHECK_NEAR(t->runs, 5000 * MS / t->period, 5000 * MS / t->period / 50 + 1);
+		CHECK_EQ(t->late, 0);
+	}
+	CHECK(hostTask(measureTask)->worst <= hostTask(measureTask)->budget);
+	CHECK(hostTask(civTask)->runs > 5000);						// every pass
+}
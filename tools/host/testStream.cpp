@@ -0,0 +1,63 @@
+// raw sample stream: stream.ino, decoded by tools/strmDecode.py
+
+struct strmResult
+{
+	int frames, pairs, crcs, gaps, drops;
+};
+
+// USB bytes since from through strmDecode.py
+static strmResult strmDecode(size_t from)
+{
+	const char* bin = "build/strm.bin";
+	strmResult r = { -1, -1, -1, -1, -1 };
+	char line[256];
+
+	FILE* f = fopen(bin, "wb");
+	fwrite(Serial.tx.data() + from, 1, Serial.tx.size() - from, f);
+	fclose(f);
+	FILE* p = popen("python3 ../strmDecode.py build/strm.bin", "r");
+	while (p && fgets(line, sizeof(line), p))
+		sscanf(line, "frames %d pairs %d crc errors %d seq gaps %d meter drops %d",
+			&r.frames, &r.pairs, &r.crcs, &r.gaps, &r.drops);
+	if (p)
+		pclose(p);
+	return r;
+}
+
+// frames through a 64 byte USB packet reach the decoder whole, every pair sent or counted as dropped
+TEST(strmFrames)
+{
+	hostAdcFn = [](int pin, uint64_t ns) {						// ramps, small and escaped deltas
+		int t = ns / 1000000;
+		return pin == chan[CH_MAIN].fwdPin ? (t * 37) % 4096 : (t * 3) % 1000;
+	};
+	hostBoot();
+	hostRun(200);
+	CHECK_EQ(Serial.availableForWrite(), 64);
+
+	const int rate = BLOCK_MODE ? BLOCK_RATE : 1000000 / SAMPLE_INTERVAL;
+	size_t from = Serial.tx.size();
+	uint32_t over = Serial.overWrites;
+	hostCmd("s");
+	CHECK(hostRunUntil([] { return isStreaming; }, 100));
+	uint32_t count = strmCount;
+	hostRun(1000);
+	Serial.txRoom = 0;											// link busy, more than MAXBUF / 2 pairs dropped
+	hostRun(1000);
+	Serial.txRoom = 64;
+	hostRun(1000);
+	hostCmd("x");
+	CHECK(hostRunUntil([] { return !isStreaming; }, 100));
+	count = sampleCount - count;
+
+	strmResult r = strmDecode(from);
+	printf("frames %d, pairs %d, crc errors %d, drops %d, pairs sampled %u\n", r.frames, r.pairs, r.crcs,
+		r.drops, count);
+	CHECK(r.frames >= 2 * rate / STRM_PAIRS);
+	CHECK_EQ(r.crcs, 0);
+	CHECK_EQ(r.gaps, 0);
+	CHECK(r.drops > 0);
+	CHECK_NEAR(r.pairs + r.drops, count, rate / 100 + BLOCK_SIZE);	// pairs since the last stream task
+	CHECK(hostUsb(from).find("STRM,END,") != std::string::npos);
+	CHECK_EQ(Serial.overWrites, over);							// never more than USB takes
+}
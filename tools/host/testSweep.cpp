@@ -0,0 +1,93 @@
+// SWR sweep: sweep.ino against the IC-7300 sim
+
+// antenna resonant at band centre, ref from radio freq: fwd / 2 at band edges
+static void sweepAntenna(int band)
+{
+	hostAdcFn = [band](int pin, uint64_t) {
+		const freqband& b = hfBand[band];
+		long half = (b.bandEnd - b.bandStart) / 2, off = labs((long)radio.freqNow() - (long)(b.bandStart + half));
+		int fwd = 2000;
+
+		return pin == chan[CH_MAIN].fwdPin ? fwd : (pin == chan[CH_MAIN].refPin ? 50 + fwd / 2 * off / half : 0);
+	};
+}
+
+// sweep time, ms per point. Returns: sweep mSecs, 0 if not done in 30 secs
+static uint64_t sweepTimed(int samples)
+{
+	hostBoot();
+	hostRun(1000);
+	sweepAntenna(getBand(getFreq()));
+	samplesDefPar.val = samples;									// window for samplesAvg
+	samplesAvg = samples;
+	hostRun(200);
+
+	uint64_t start = hostMs();
+	sweepStart();
+	if (!hostRunUntil([] { return sweepState == SWEEP_DONE; }, 30000))
+		return 0;
+	return hostMs() - start;
+}
+
+// 100 points in seconds, each point read at its own freq, radio back on its freq
+TEST(sweepCurve)
+{
+	uint32_t writes = radio.freqWrites;
+	uint64_t ms = sweepTimed(100);								// 50 mSecs window, longer than settle
+	unsigned long perPoint = SWEEP_SETTLE + sweepWinMs() + sweepFrameMs() + 2;
+
+	printf("sweep %llu mSecs, %.1f mSecs / point\n", (unsigned long long)ms, ms / (double)SWEEP_POINTS);
+	CHECK(ms > 0);
+	CHECK(ms < SWEEP_POINTS * perPoint);
+	long winUs = chan[CH_MAIN].winSize[adcWin(samplesAvg)] * (long)(BLOCK_MODE ? 1000000 / BLOCK_RATE : SAMPLE_INTERVAL);
+	CHECK(sweepWinMs() * 1000 >= winUs);							// point read once window is all new freq
+	int lo = 0;
+	for (int i = 0; i < SWEEP_POINTS; i++)
+	{
+		CHECK(sweepSwr[i] >= 100);
+		CHECK_NEAR(sweepSwr[i], sweepSwr[SWEEP_POINTS - 1 - i], 1);	// symmetric, no point read a step late
+		if (sweepSwr[i] < sweepSwr[lo])
+			lo = i;
+	}
+	CHECK_NEAR(lo, SWEEP_POINTS / 2, 1);
+	CHECK(sweepSwr[0] > 250);
+
+	hostRun(500);
+	CHECK(radio.freqWrites - writes >= SWEEP_POINTS + 1);		// points and restore
+	CHECK_EQ(radio.freqNow(), 14074000);
+	CHECK_EQ(getFreq(), 14074000);
+}
+
+// no echo, sweep stops with radio off
+TEST(sweepNoRadio)
+{
+	hostBoot();
+	hostRun(1000);
+	radio.isOn = false;
+	sweepStart();
+	CHECK(hostRunUntil([] { return sweepState == SWEEP_DONE; }, SWEEP_TIMEOUT + 200));
+	CHECK(sweepN == 0);
+}
+
+BENCH(sweepPoints)
+{
+	printf("%d point sweep, IC-7300 sim, SWEEP_SETTLE %d mSecs. per point: settle + window + measure() pass,\n"
+		"next freq write overlaps the window\n", SWEEP_POINTS, SWEEP_SETTLE);
+	for (int samples : { 5, 20, 100, 200 })
+	{
+		fflush(stdout);
+		pid_t pid = fork();										// one boot per process
+
+		if (pid == 0)
+		{
+			uint64_t ms = sweepTimed(samples);
+			unsigned long serial = SWEEP_SETTLE + sweepWinMs() + sweepFrameMs() + 1;	// write after read
+
+			printf("  samples %3d  %5.2f secs  %5.1f mSecs / point  (write after each read %5.2f secs)\n",
+				samples, ms / 1000.0, ms / (double)SWEEP_POINTS, SWEEP_POINTS * serial / 1000.0);
+			fflush(stdout);
+			_exit(0);
+		}
+		waitpid(pid, NULL, 0);
+	}
+}
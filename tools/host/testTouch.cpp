@@ -0,0 +1,143 @@
+// touch: 2_touch.ino gesture state machine, hit test grid
+
+// hit test before user-011: every frame in turn, first touch enabled frame containing x, y
+static int touchScan(int x, int y)
+{
+	for (int i = 0; i < NUM_FRAMES; i++)
+		if (x > fr[i].x && x < (fr[i].x + fr[i].w) && y > fr[i].y && (y < fr[i].y + fr[i].h) && frs.isTouch[i])
+			return i;
+	return -1;
+}
+
+struct touchEv
+{
+	int ev, frame;
+	uint64_t ms;
+};
+
+// touchPoll() every mSec for ms, events from it
+static std::vector<touchEv> touchRun(uint64_t ms)
+{
+	std::vector<touchEv> evs;
+	uint64_t end = hostNs + ms * 1000000ULL;
+
+	while (hostNs < end)
+	{
+		int ev = touchPoll();
+
+		if (ev != TOUCH_NONE)
+			evs.push_back({ ev, touchFrame, hostMs() });
+		hostTick(1000000);
+	}
+	return evs;
+}
+
+// grid gives the same frame as the scan, every pixel, after a layout change too
+TEST(touchGridHits)
+{
+	hostBoot();
+	hostRun(200);
+	for (int pass = 0; pass < 2; pass++)
+	{
+		if (pass)
+		{
+			touchActions(nettPwrMeter, 1);					// swap to SWR meter, other touch flags
+			touchGrid();
+		}
+		for (int y = -1; y <= 240; y++)
+			for (int x = -1; x <= 320; x++)
+				if (touchHit(x, y) != touchScan(x, y))
+				{
+					printf("x %d y %d grid %d scan %d\n", x, y, touchHit(x, y), touchScan(x, y));
+					CHECK(false);
+				}
+	}
+}
+
+// press, then tap on release, or long when longTouchTimer expires and nothing on release
+TEST(touchGestures)
+{
+	hostBoot();
+	hostRun(200);
+	touchRun(10);												// boot wake cleared
+
+	hostTouchFrame(nettPwrMeter, 100);
+	std::vector<touchEv> evs = touchRun(300);
+	CHECK_EQ(evs.size(), 2);
+	CHECK_EQ(evs[0].ev, TOUCH_PRESS);
+	CHECK_EQ(evs[0].frame, nettPwrMeter);
+	CHECK_EQ(evs[1].ev, TOUCH_TAP);
+	CHECK_NEAR(evs[1].ms - evs[0].ms, 100, 2);
+
+	hostTouchFrame(swr, 800);
+	evs = touchRun(1000);
+	CHECK_EQ(evs.size(), 2);
+	CHECK_EQ(evs[0].ev, TOUCH_PRESS);
+	CHECK_EQ(evs[0].frame, swr);
+	CHECK_EQ(evs[1].ev, TOUCH_LONG);
+	CHECK_NEAR(evs[1].ms - evs[0].ms, longTouchTimer.interval_millis, 2);
+	CHECK_EQ(touchState, TOUCH_IDLE);
+
+	hostTouch(0, 0, 50);										// corner, no frame
+	evs = touchRun(100);
+	CHECK_EQ(evs.size(), 2);
+	CHECK_EQ(evs[0].frame, -1);
+}
+
+// measurement runs while the screen is held. longest loop() pass during a touch held 440 mSecs
+TEST(touchNoBlock)
+{
+	uint64_t maxNs = 0;
+	task* meas = NULL;
+
+	hostBoot();
+	hostCarrier(3000, 300);
+	hostRun(500);
+	for (int i = 0; i < NUM_TASKS; i++)
+		if (tasks[i].fn == measureTask)
+			meas = &tasks[i];
+	unsigned long count = meas->runs;
+
+	hostTouchFrame(nettPwr, 450);								// held, not long
+	uint64_t end = hostNs + 440 * 1000000ULL;
+	while (hostNs < end)
+	{
+		uint64_t t = hostNs;
+
+		loop();
+		hostTick(hostLoopNs);
+		maxNs = std::max(maxNs, hostNs - t);
+	}
+	printf("longest loop() pass while touched %.2f mSecs, measure() %u times in 440 mSecs\n",
+		maxNs / 1e6, meas->runs - count);
+	CHECK(maxNs < 20000000ULL);
+	CHECK(meas->runs - count >= 440 / 4);						// 2 mSecs period
+}
+
+// hit test per touch, grid vs scan of NUM_FRAMES. host
+BENCH(touchHitTest)
+{
+	const int n = 2000000;
+	std::vector<int> xs(n), ys(n);
+	uint32_t seed = 1;
+	int sum[2] = {};
+	double t[2];
+
+	hostBoot();
+	hostRun(200);
+	for (int i = 0; i < n; i++)
+	{
+		seed = seed * 1664525 + 1013904223;
+		xs[i] = (seed >> 8) % 320;
+		ys[i] = (seed >> 20) % 240;
+	}
+	for (int m = 0; m < 2; m++)
+	{
+		double wall = hostWall();
+		for (int i = 0; i < n; i++)
+			sum[m] += m ? touchScan(xs[i], ys[i]) : touchHit(xs[i], ys[i]);
+		t[m] = (hostWall() - wall) * 1e9 / n;
+	}
+	printf("random points, %d frames: grid %.1f ns, scan %.1f ns per hit test, host. same frames %s\n",
+		NUM_FRAMES, t[0], t[1], sum[0] == sum[1] ? "yes" : "NO");
+}
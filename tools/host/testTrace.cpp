@@ -0,0 +1,390 @@
+// session trace record / replay, trace.ino
+//   pmhost record <file> [secs]     scripted session on the host, trace written to file
+//   pmhost replay <file>            replay a TRACE_BOOT trace, compare display digest
+#include <fstream>
+
+struct trcRecord
+{
+	int type;
+	std::vector<uint8_t> d;
+
+	uint32_t u32(int i) const { uint32_t v; memcpy(&v, &d[i], 4); return v; }
+	uint16_t u16(int i) const { return d[i] | d[i + 1] << 8; }
+};
+
+// framed records from raw USB bytes. other text and bad CRCs skipped
+static std::vector<trcRecord> traceParse(const std::vector<uint8_t>& b, uint32_t* bad = nullptr)
+{
+	std::vector<trcRecord> recs;
+
+	for (size_t i = 0; i + 6 <= b.size(); )
+	{
+		if (b[i] != TRC_SYNC0 || b[i + 1] != TRC_SYNC1)
+		{
+			i++;
+			continue;
+		}
+		size_t n = b[i + 3];
+		if (i + 6 + n > b.size())
+			break;
+		uint16_t crc = crcAdd(crcAdd(0xFFFF, &b[i + 2], 2), &b[i + 4], n);
+		if ((b[i + 4 + n] | b[i + 5 + n] << 8) != crc)
+		{
+			if (bad)
+				(*bad)++;
+			i++;
+			continue;
+		}
+		recs.push_back({ b[i + 2], std::vector<uint8_t>(b.begin() + i + 4, b.begin() + i + 4 + n) });
+		i += 6 + n;
+	}
+	return recs;
+}
+
+static std::vector<uint8_t> traceLoad(const char* path)
+{
+	std::ifstream f(path, std::ios::binary);
+
+	return std::vector<uint8_t>(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+/*------------------------------ traceRecord() -------------------------------------------------
+scripted session: idle, carrier with meter swap taps, VFO turned at the radio, idle
+fb: frame buffer digest when the trace stopped
+*/
+static void traceRecord(const char* path, uint32_t secs, uint32_t* fb)
+{
+	size_t from;
+
+	hostBoot();
+	from = Serial.tx.size();
+	traceStart(true);											// as TRACE_BOOT
+
+	for (uint32_t s = 0; s < secs; s += 8)
+	{
+		hostRun(500);
+		hostCarrier(2600, 400);
+		hostRun(800);
+		hostTouchFrame(nettPwrMeter, 100);						// swap to SWR meter
+		hostRun(1200);
+		hostAdcFn = nullptr;
+		hostRun(1500);
+		radio.dial(s % 16 ? 14074000 : 7074000);
+		hostRun(2000);
+		hostTouchFrame(swrMeter, 100);							// swap back
+		hostRun(2000);
+	}
+
+	hostCmd("x");
+	CHECK(hostRunUntil([] { return !isTracing; }, 1000));
+	*fb = tft.digest();
+	CHECK(hostRunUntil([] { return trcHead == trcTail; }, 1000));
+
+	std::ofstream f(path, std::ios::binary);
+	f.write((const char*)&Serial.tx[from], Serial.tx.size() - from);
+}
+
+/*------------------------------ traceReplay() -------------------------------------------------
+power on from the trace start state, then run the recorded tasks on the recorded samples
+*/
+struct replayResult
+{
+	bool isBoot = false, isEnd = false;
+	uint32_t recs = 0, bad = 0, ticks = 0, pairs = 0, gaps = 0;
+	uint32_t civTx = 0, civMiss = 0, touches = 0, skipped = 0, drops = 0;
+	uint16_t digest = 0, devDigest = 0;
+	uint32_t fb = 0;
+	uint64_t virtUs = 0;
+	double wall = 0;
+};
+
+static replayResult traceReplay(const char* path, std::function<void(std::vector<trcRecord>&)> edit = nullptr)
+{
+	replayResult r;
+	std::vector<trcRecord> recs = traceParse(traceLoad(path), &r.bad);
+	std::vector<uint16_t> fwd, ref;								// pairs from start count
+	std::vector<bool> isPair;
+	uint32_t first = 0, fed, startUs = 0;
+	size_t i = 0;
+
+	if (edit)
+		edit(recs);
+	r.recs = recs.size();
+	while (i < recs.size() && recs[i].type != TRC_START)
+		i++;
+	if (i == recs.size())
+		return r;
+	startUs = recs[i].u32(0);
+	first = recs[i].u32(4);
+	r.isBoot = recs[i].d[8] & TRC_BOOT;
+
+	// samples, EEPROM image, radio state
+	for (const trcRecord& t : recs)
+		if (t.type == TRC_ADC)
+			for (size_t p = 4, c = t.u32(0) - first; p + 4 <= t.d.size(); p += 4, c++)
+			{
+				if (c >= fwd.size())
+				{
+					fwd.resize(c + 1);
+					ref.resize(c + 1);
+					isPair.resize(c + 1);
+				}
+				fwd[c] = t.u16(p);
+				ref[c] = t.u16(p + 2);
+				isPair[c] = true;
+			}
+		else if (t.type == TRC_EE)
+			for (size_t p = 2; p < t.d.size(); p++)
+				EEPROM.mem[(t.u16(0) + p - 2) & (HOST_EE_SIZE - 1)] = t.d[p];
+		else if (t.type == TRC_CIV_RX && t.d.size() == 11 && t.d[4] == 0x03)
+			radio.freq = civSim::unbcd(&t.d[5], 5, true);		// frequency slot, boot handshake
+
+	double wall = hostWall();
+
+	// start state. samples before the trace are all zero, buffers and window totals agree
+	hostBoot();
+	Serial1.onTx = nullptr;										// bus from the trace now
+	Serial1.rx.clear();
+	hostTimersOff = true;
+	traceStart(true);											// digest from here
+	for (i++; i < recs.size() && recs[i].type == TRC_EE; i++)
+		;
+	for (; i < recs.size() && recs[i].type == TRC_CIV_RX; i++)	// slot frames, if boot got other values
+	{
+		bool isSame = false;
+
+		for (int s = 0; s < NUM_CIV_SLOTS; s++)
+			isSame |= civSlots[s].n == (int)recs[i].d.size() && !memcmp(civSlots[s].buff, recs[i].d.data(), civSlots[s].n);
+		if (!isSame)
+			civRxFrame((char*)recs[i].d.data(), recs[i].d.size());
+	}
+	hostSetUs(startUs);
+	sample = first % MAXBUF;
+	sampleCount = first;
+	fed = first;
+
+	for (; i < recs.size(); i++)
+	{
+		const trcRecord& t = recs[i];
+
+		if (t.type == TRC_TICK)
+		{
+			uint32_t count = t.u32(4);
+			int task = t.d[8];
+			uint16_t b1[TRC_PAIRS], b0[TRC_PAIRS];
+			int n = 0;
+
+			r.ticks++;
+			for (; fed != count; fed++)							// samples taken before the task ran
+			{
+				uint32_t c = fed - first;
+
+				b1[n] = c < isPair.size() && isPair[c] ? fwd[c] : 0;
+				b0[n] = c < isPair.size() && isPair[c] ? ref[c] : 0;
+				r.gaps += !(c < isPair.size() && isPair[c]);
+				if (++n == TRC_PAIRS)
+				{
+					addADCBlock(b1, b0, n);
+					n = 0;
+				}
+				r.pairs++;
+			}
+			if (n)
+				addADCBlock(b1, b0, n);
+			hostSetUs(t.u32(0));
+			actCheck();											// act task, every pass on the device
+
+			if (task == TRC_TASK_CIV)
+			{
+				std::vector<uint8_t> tx;
+				size_t from = Serial1.tx.size();
+
+				for (size_t j = i + 1; j < recs.size() && recs[j].type != TRC_TICK; j++)
+					if (recs[j].type == TRC_CIV_RX)
+						Serial1.in(recs[j].d.data(), recs[j].d.size(), hostNs);
+					else if (recs[j].type == TRC_CIV_TX)
+						tx.insert(tx.end(), recs[j].d.begin(), recs[j].d.end());
+				civService();
+				r.civTx += tx.size() != 0;
+				r.civMiss += tx != std::vector<uint8_t>(Serial1.tx.begin() + from, Serial1.tx.end());
+			}
+			else if (task < NUM_TASKS)
+			{
+				const char* name = tasks[task].name;
+
+				if (strcmp(name, "touch") && strcmp(name, "usb") && strcmp(name, "bt")	// inputs, replayed as events
+					&& strcmp(name, "stream") && strcmp(name, "trace"))					// outputs
+					tasks[task].fn();
+			}
+		}
+		else if (t.type == TRC_TOUCH)
+		{
+			int frame = (int8_t)t.d[0], ev = t.d[1];
+
+			// long touch on other frames opens an option screen, waits for touch
+			if (ev == TOUCH_LONG && frame != nettPwrMeter && frame != swrMeter)
+				r.skipped++;
+			else
+			{
+				touchEvent(frame, ev);
+				r.touches++;
+			}
+		}
+		else if (t.type == TRC_END)
+		{
+			r.devDigest = t.u16(0);
+			r.drops = t.u32(6);
+			r.isEnd = true;
+			break;
+		}
+	}
+
+	r.wall = hostWall() - wall;
+	r.virtUs = hostNs / 1000 - startUs;
+	r.digest = dispDigest;
+	r.fb = tft.digest();
+	return r;
+}
+
+static void replayPrint(const replayResult& r)
+{
+	printf("records %u, bad %u, ticks %u, pairs %u, gaps %u, drops %u\n", r.recs, r.bad, r.ticks, r.pairs, r.gaps, r.drops);
+	printf("civ sends %u, mismatched %u, touches %u, skipped %u\n", r.civTx, r.civMiss, r.touches, r.skipped);
+	printf("%.2f s of trace in %.3f s, %.0fx real time, %.2f M pairs/s\n", r.virtUs / 1e6, r.wall,
+		r.virtUs / 1e6 / r.wall, r.pairs / r.wall / 1e6);
+	if (!r.isBoot)
+		printf("digest not comparable, trace not started at boot (TRACE_BOOT)\n");
+	else if (!r.isEnd)
+		printf("digest not comparable, no end record\n");
+	else
+		printf("display digest %04X, device %04X %s\n", r.digest, r.devDigest, r.digest == r.devDigest ? "match" : "DIFFER");
+	printf("frame buffer %08X\n", r.fb);
+}
+
+TOOL(record)
+{
+	uint32_t fb;
+
+	if (hostArgs.empty())
+	{
+		fprintf(stderr, "pmhost record <file> [secs]\n");
+		exit(2);
+	}
+	traceRecord(hostArgs[0].c_str(), hostArgs.size() > 1 ? atoi(hostArgs[1].c_str()) : 16, &fb);
+	printf("frame buffer %08X\n", fb);
+}
+
+TOOL(replay)
+{
+	if (hostArgs.empty())
+	{
+		fprintf(stderr, "pmhost replay <file>\n");
+		exit(2);
+	}
+	replayResult r = traceReplay(hostArgs[0].c_str());
+	replayPrint(r);
+	exit(r.isEnd && r.digest == r.devDigest ? 0 : 1);
+}
+
+// record in a child process, the replay starts from power on
+static uint32_t traceRecordChild(const char* path, uint32_t secs)
+{
+	int fd[2];
+	uint32_t fb = 0;
+	pid_t pid;
+
+	CHECK(pipe(fd) == 0);
+	if ((pid = fork()) == 0)
+	{
+		traceRecord(path, secs, &fb);
+		CHECK(write(fd[1], &fb, 4) == 4);
+		_exit(0);
+	}
+	int status;
+	waitpid(pid, &status, 0);
+	CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+	CHECK(read(fd[0], &fb, 4) == 4);
+	close(fd[0]);
+	close(fd[1]);
+	return fb;
+}
+
+TEST(boot)
+{
+	hostBoot();
+	hostRun(1000);
+	CHECK(isCivEnable);
+	CHECK_EQ(getFreq(), 14074000);
+}
+
+// record, replay: same values drawn, same frame buffer, same CI-V commands
+TEST(traceRoundTrip)
+{
+	char path[] = "/tmp/pmtraceXXXXXX";
+	close(mkstemp(path));
+	uint32_t fb = traceRecordChild(path, 16);
+	replayResult r = traceReplay(path);
+
+	unlink(path);
+	replayPrint(r);
+	CHECK(r.isBoot && r.isEnd);
+	CHECK_EQ(r.bad, 0);
+	CHECK_EQ(r.drops, 0);
+	CHECK_EQ(r.gaps, 0);
+	CHECK(r.pairs > 16 * 1000);
+	CHECK(r.civTx > 0);
+	CHECK_EQ(r.civMiss, 0);
+	CHECK_EQ(r.touches, 8);							// press, tap x 4
+	CHECK_EQ(r.digest, r.devDigest);
+	CHECK_EQ(r.fb, fb);
+}
+
+// replay sees a changed sample
+TEST(traceDetects)
+{
+	char path[] = "/tmp/pmtraceXXXXXX";
+	close(mkstemp(path));
+	traceRecordChild(path, 8);
+	replayResult r = traceReplay(path, [](std::vector<trcRecord>& recs) {
+		int n = 0;
+		for (trcRecord& t : recs)
+			if (t.type == TRC_ADC && t.u16(4) > 2000 && ++n == 20)
+				for (size_t p = 4; p < t.d.size(); p += 4)
+					t.d[p + 1] -= 2;							// forward 512 codes lower
+	});
+
+	unlink(path);
+	CHECK(r.isEnd);
+	CHECK(r.digest != r.devDigest);
+}
+
+// a trace started by 'r' has no start state, replay runs but says so
+TEST(traceNotBoot)
+{
+	char path[] = "/tmp/pmtraceXXXXXX";
+	close(mkstemp(path));
+	hostBoot();
+	size_t from = Serial.tx.size();
+	hostCmd("r");
+	hostRun(500);
+	hostCmd("x");
+	hostRun(200);
+	std::ofstream(path, std::ios::binary).write((const char*)&Serial.tx[from], Serial.tx.size() - from);
+
+	std::vector<trcRecord> recs = traceParse(traceLoad(path));
+	unlink(path);
+	CHECK(!recs.empty());
+	CHECK_EQ(recs.front().type, TRC_START);
+	CHECK_EQ(recs.front().d[8] & TRC_BOOT, 0);
+	CHECK_EQ(recs.back().type, TRC_END);
+}
+
+BENCH(traceReplay)
+{
+	char path[] = "/tmp/pmtraceXXXXXX";
+	close(mkstemp(path));
+	traceRecordChild(path, 64);
+	replayResult r = traceReplay(path);
+	unlink(path);
+	replayPrint(r);
+}
@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""
+PowerMeter III raw sample stream decoder, see stream.ino for the frame format.
+
+  strmDecode.py /dev/ttyACM0 -s 10 -o samples.csv     start stream, record 10 secs, CSV
+  strmDecode.py capture.bin -o samples.npy            decode a saved capture, NumPy (n x 2, fwd ref)
+
+A device path is put in raw mode (stty), sent 's' to start and 'x' to stop.
+Prints frames, sample pairs, CRC errors, sequence gaps, pairs dropped by the meter
+and the achieved sample rate.
+"""
+import argparse, os, struct, subprocess, sys, time
+
+SYNC = b'\xA5\x5A'
+ESC = 0x80
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def frames(buf, stats):
+    """yield (seq, drops, [(fwd, ref), ...]) for each good frame in buf"""
+    i = 0
+    while True:
+        i = buf.find(SYNC, i)
+        if i < 0 or len(buf) - i < 13:
+            return
+        seq, n, drops, fwd, ref = struct.unpack_from('<HBHHH', buf, i + 2)
+        j = i + 11
+        pairs = [(fwd, ref)]
+        try:
+            for _ in range(n - 1):
+                vals = []
+                for prev in pairs[-1]:
+                    d = buf[j]
+                    if d == ESC:
+                        vals.append(buf[j + 1] | buf[j + 2] << 8)
+                        j += 3
+                    else:
+                        vals.append(prev + (d - 256 if d > 127 else d))
+                        j += 1
+                pairs.append(tuple(vals))
+            crc = buf[j] | buf[j + 1] << 8
+        except IndexError:
+            return
+        if n == 0 or crc16(buf[i + 2:j]) != crc:
+            stats['crc'] += 1
+            i += 1                                  # resync on next sync bytes
+            continue
+        yield seq, drops, pairs
+        i = j + 2
+
+
+def capture(dev, secs):
+    subprocess.run(['stty', '-F', dev, 'raw', '-echo'], check=False)
+    fd = os.open(dev, os.O_RDWR | os.O_NOCTTY)
+    os.write(fd, b's')
+    data = bytearray()
+    start = time.time()
+    while time.time() - start < secs:
+        data += os.read(fd, 65536)
+    os.write(fd, b'x')
+    os.close(fd)
+    return bytes(data), time.time() - start
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('src', help='serial device or capture file')
+    ap.add_argument('-s', '--secs', type=float, default=5.0, help='capture time, device only')
+    ap.add_argument('-o', '--out', help='output .csv or .npy')
+    ap.add_argument('--raw', help='also save raw capture to this file')
+    a = ap.parse_args()
+
+    if os.path.exists(a.src) and not a.src.startswith('/dev/'):
+        data, secs = open(a.src, 'rb').read(), None
+    else:
+        data, secs = capture(a.src, a.secs)
+    if a.raw:
+        open(a.raw, 'wb').write(data)
+
+    stats = {'crc': 0}
+    samples, nFrames, gaps, drops, last = [], 0, 0, 0, None
+    for seq, d, pairs in frames(data, stats):
+        if last is not None and seq != (last + 1) & 0xFFFF:
+            gaps += 1
+        last = seq
+        nFrames += 1
+        drops += d
+        samples.extend(pairs)
+
+    if a.out and a.out.endswith('.npy'):
+        import numpy as np
+        np.save(a.out, np.array(samples, dtype=np.uint16).reshape(-1, 2))
+    elif a.out:
+        with open(a.out, 'w') as f:
+            f.write('fwd,ref\n')
+            f.writelines('%d,%d\n' % p for p in samples)
+
+    print('frames %d  pairs %d  crc errors %d  seq gaps %d  meter drops %d'
+          % (nFrames, len(samples), stats['crc'], gaps, drops))
+    if secs:
+        print('sample rate %.0f pairs/s (incl drops %.0f)' % (len(samples) / secs, (len(samples) + drops) / secs))
+
+
+if __name__ == '__main__':
+    main()
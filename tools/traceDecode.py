@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+"""
+PowerMeter III session trace decoder, see trace.ino for the record format.
+
+  traceDecode.py /dev/ttyACM0 -s 30 --raw session.trc     start trace, record 30 secs, save
+  traceDecode.py session.trc -o events.csv                 decode a saved trace, one line per record
+  traceDecode.py session.trc --adc samples.csv             ADC sample pairs only
+  traceDecode.py new.trc --compare old.trc                 same inputs, compare display digests
+
+A device path is put in raw mode (stty), sent 'r' to start and 'x' to stop.
+Prints records per type, CRC errors, sample count gaps, CI-V frames, touches,
+task runs per tick, trace duration from ticks and the display digest from the end record.
+Replay on the host: tools/host, pmhost replay <file> (TRACE_BOOT traces only).
+Text lines printed by the meter (stats) between records are skipped.
+"""
+import argparse, os, struct, subprocess, time
+
+SYNC = b'\xA7\x7A'
+TICK, ADC, CIV_RX, CIV_TX, TOUCH, END, START, EE = 1, 2, 3, 4, 5, 6, 7, 8
+NAMES = {TICK: 'tick', ADC: 'adc', CIV_RX: 'civRx', CIV_TX: 'civTx', TOUCH: 'touch', END: 'end',
+         START: 'start', EE: 'eeprom'}
+EVENTS = {1: 'tap', 2: 'long', 3: 'press'}
+TASK_CIV = 0xFF                                     # tick task, civService() pass
+
+
+def crc16(data, crc=0xFFFF):
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def records(buf, stats):
+    """yield (type, payload) for each good record in buf"""
+    i = 0
+    while True:
+        i = buf.find(SYNC, i)
+        if i < 0 or len(buf) - i < 6:
+            return
+        t, n = buf[i + 2], buf[i + 3]
+        if len(buf) - i < n + 6:
+            return
+        body = buf[i + 2:i + 4 + n]
+        crc = buf[i + 4 + n] | buf[i + 5 + n] << 8
+        if t not in NAMES or crc16(body) != crc:
+            stats['crc'] += 1
+            i += 1                                  # resync on next sync bytes
+            continue
+        yield t, bytes(buf[i + 4:i + 4 + n])
+        i += n + 6
+
+
+def decode(data):
+    stats = {'crc': 0}
+    out = {'counts': dict.fromkeys(NAMES, 0), 'events': [], 'pairs': [], 'gaps': 0,
+           'ticks': [], 'tasks': {}, 'start': None, 'end': None, 'stats': stats}
+    nextCount = None
+    for t, p in records(data, stats):
+        out['counts'][t] += 1
+        if t == TICK:
+            us, count, task = struct.unpack('<IIB', p)
+            out['ticks'].append(us)
+            out['tasks'][task] = out['tasks'].get(task, 0) + 1
+            out['events'].append((t, '%d %d %s' % (us, count, 'civ' if task == TASK_CIV else task)))
+        elif t == START:
+            out['start'] = struct.unpack('<IIB', p)
+            out['events'].append((t, '%d %d %s' % (out['start'][0], out['start'][1],
+                                  'boot' if out['start'][2] & 1 else 'usb')))
+        elif t == EE:
+            addr, = struct.unpack_from('<H', p)
+            out['events'].append((t, '%d+%d' % (addr, len(p) - 2)))
+        elif t == ADC:
+            count, = struct.unpack_from('<I', p)
+            pairs = list(struct.iter_unpack('<HH', p[4:]))
+            if nextCount is not None and count != nextCount:
+                out['gaps'] += 1
+            nextCount = (count + len(pairs)) & 0xFFFFFFFF
+            out['pairs'].extend(pairs)
+            out['events'].append((t, '%d+%d' % (count, len(pairs))))
+        elif t in (CIV_RX, CIV_TX):
+            out['events'].append((t, p.hex(' ')))
+        elif t == TOUCH:
+            frame = p[0] - 256 if p[0] > 127 else p[0]
+            out['events'].append((t, '%d %s' % (frame, EVENTS.get(p[1], p[1]))))
+        elif t == END:
+            out['end'] = struct.unpack('<HII', p)
+            out['events'].append((t, '%04X' % out['end'][0]))
+    return out
+
+
+def capture(dev, secs):
+    subprocess.run(['stty', '-F', dev, 'raw', '-echo'], check=False)
+    fd = os.open(dev, os.O_RDWR | os.O_NOCTTY)
+    os.write(fd, b'r')
+    data = bytearray()
+    start = time.time()
+    while time.time() - start < secs:
+        data += os.read(fd, 65536)
+    os.write(fd, b'x')
+    end = time.time() + 1.0                         # rest of buffer and end record
+    while time.time() < end:
+        data += os.read(fd, 65536)
+    os.close(fd)
+    return bytes(data)
+
+
+def load(src, secs):
+    if os.path.exists(src) and not src.startswith('/dev/'):
+        return open(src, 'rb').read()
+    return capture(src, secs)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('src', help='serial device or trace file')
+    ap.add_argument('-s', '--secs', type=float, default=10.0, help='capture time, device only')
+    ap.add_argument('-o', '--out', help='events .csv, one line per record')
+    ap.add_argument('--adc', help='ADC sample pairs .csv')
+    ap.add_argument('--raw', help='also save raw capture to this file')
+    ap.add_argument('--compare', help='trace file, compare display digest')
+    a = ap.parse_args()
+
+    data = load(a.src, a.secs)
+    if a.raw:
+        open(a.raw, 'wb').write(data)
+    tr = decode(data)
+
+    if a.out:
+        with open(a.out, 'w') as f:
+            f.write('type,data\n')
+            f.writelines('%s,%s\n' % (NAMES[t], v) for t, v in tr['events'])
+    if a.adc:
+        with open(a.adc, 'w') as f:
+            f.write('fwd,ref\n')
+            f.writelines('%d,%d\n' % p for p in tr['pairs'])
+
+    c = tr['counts']
+    print('records ' + '  '.join('%s %d' % (NAMES[t], c[t]) for t in NAMES)
+          + '  crc errors %d' % tr['stats']['crc'])
+    print('pairs %d  sample gaps %d' % (len(tr['pairs']), tr['gaps']))
+    if tr['start']:
+        print('started %s at %d us, sample %d' % ('at boot' if tr['start'][2] & 1 else 'by usb',
+                                                   tr['start'][0], tr['start'][1]))
+    if len(tr['ticks']) > 1:
+        secs = (tr['ticks'][-1] - tr['ticks'][0]) / 1e6
+        print('duration %.1f s  task runs %.0f/s' % (secs, len(tr['ticks']) / max(secs, 1e-3)))
+        print('runs per task ' + '  '.join('%s %d' % ('civ' if k == TASK_CIV else k, v)
+                                           for k, v in sorted(tr['tasks'].items())))
+    if tr['end']:
+        print('display digest %04X  records %d  drops %d' % tr['end'])
+    else:
+        print('no end record, trace not stopped or end lost')
+
+    if a.compare:
+        ref = decode(load(a.compare, a.secs))
+        if not tr['end'] or not ref['end']:
+            print('compare: end record missing')
+        else:
+            print('compare: digest %s' % ('same' if tr['end'][0] == ref['end'][0] else 'DIFFERENT'))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,257 @@
+/*---------------------------------------------------------
+  POWERMETER III + ICOM 7300 CONTROLLER
+   Copyright 2018-2020  Roger Mawhinney, GI8GZM.
+  No publication with acknowledgement to author
+*/
+
+/*
+session trace over USB Serial, for offline replay of the measure / display pipeline
+records every input: ADC sample pairs, CI-V bytes both ways, touch events, and a tick for each
+scheduler task run, so a replay runs the same tasks on the same samples in the same order.
+display digest is a CRC of every value string and meter bar drawn, so a replay can be checked.
+records are buffered in trcBuf[] and sent by the trace task, never waits for USB.
+decoder: tools/traceDecode.py, replay: tools/host (pmhost replay)
+
+replay starts from the state after setup(), so only TRACE_BOOT traces can be replayed.
+the start record is followed by the EEPROM image and the CI-V result slots, and the first
+pairs recorded are the largest averaging window (and a peak block) before the start, so a
+replay's windows are full when the first tick runs.
+option / calibrate screens wait for touch() and are not replayed.
+
+record, little endian:
+	A7 7A | type u8 | len u8 | payload (len bytes) | crc u16
+	crc: CRC-16/CCITT (0x1021, init 0xFFFF) of type, len, payload
+	TRC_START	micros u32, sampleCount of first pair u32, flags u8 (TRC_BOOT, TRC_CIV_ON)
+	TRC_EE		address u16, EEPROM bytes
+	TRC_TICK	micros u32, sampleCount u32, task u8 (tasks[] index, TRC_TASK_CIV)
+	TRC_ADC		sampleCount of first pair u32, pairs (fwd u16, ref u16)
+	TRC_CIV_RX	bus bytes			TRC_CIV_TX	frame sent, preamble to 0xFD
+	TRC_TOUCH	frame i8, event u8 (TOUCH_PRESS, TOUCH_TAP, TOUCH_LONG)
+	TRC_END		digest u16, records u32, drops u32
+*/
+
+/*------------------------------ traceStart() -------------------------------------------------
+start trace, stops raw sample stream (same USB Serial)
+isBoot: called at end of setup(), TRACE_BOOT. start state recorded for replay
+*/
+void traceStart(bool isBoot)
+{
+	uint8_t p[4 + TRC_EE_CHUNK];
+	uint32_t us = micros(), count, hist = WIN_BLK;
+	int eeEnd = EEADDR_PARAM2 + EEINCR + EE_ALT;			// EEPROM used, B slots last
+
+	for (int k = 0; k < NUM_WIN; k++)						// window history first
+		if (chan[CH_MAIN].winSize[k] + WIN_BLK > (int)hist)
+			hist = chan[CH_MAIN].winSize[k] + WIN_BLK;
+	if (hist > WIN_MAX)
+		hist = WIN_MAX;
+
+	strmStop();
+	noInterrupts();
+	count = sampleCount;
+	interrupts();
+	trcCount = count - (count < hist ? count : hist);
+	trcHead = trcTail = 0;
+	trcRecs = 0;
+	trcDrops = 0;
+	dispDigest = 0xFFFF;
+	isTracing = true;
+
+	memcpy(&p[0], &us, 4);
+	memcpy(&p[4], &trcCount, 4);
+	p[8] = (isBoot ? TRC_BOOT : 0) | (isCivEnable ? TRC_CIV_ON : 0);
+	traceRec(TRC_START, p, 9);
+	for (int a = 0; a < eeEnd; a += TRC_EE_CHUNK)
+	{
+		int n = eeEnd - a < TRC_EE_CHUNK ? eeEnd - a : TRC_EE_CHUNK;
+
+		p[0] = a;
+		p[1] = a >> 8;
+		for (int i = 0; i < n; i++)
+			p[2 + i] = EEPROM.read(a + i);
+		traceRec(TRC_EE, p, 2 + n);
+	}
+	for (int i = 0; i < NUM_CIV_SLOTS; i++)				// radio state cache, as received
+		if (civSlots[i].n)
+			traceRec(TRC_CIV_RX, civSlots[i].buff, civSlots[i].n);
+}
+
+/*------------------------------ traceStop() -------------------------------------------------
+adds end record, buffer is still sent by traceSend()
+*/
+void traceStop()
+{
+	uint8_t p[10];
+
+	if (!isTracing)
+		return;
+	tracePairs();											// every pair up to the end record
+	memcpy(&p[0], &dispDigest, 2);
+	memcpy(&p[2], &trcRecs, 4);
+	memcpy(&p[6], &trcDrops, 4);
+	traceRec(TRC_END, p, sizeof(p));
+	isTracing = false;
+}
+
+/*------------------------------ traceRec() -------------------------------------------------
+adds one record to trcBuf[]. lost if buffer full, counted in trcDrops
+*/
+void traceRec(int type, const void* payload, int n)
+{
+	const uint8_t* p = (const uint8_t*)payload;
+	uint8_t hdr[2] = { (uint8_t)type, (uint8_t)n };
+	uint16_t crc;
+	int used = trcHead - trcTail;
+
+	if (!isTracing)
+		return;
+	if (used < 0)
+		used += TRC_BUF;
+	if (TRC_BUF - 1 - used < n + 6)
+	{
+		trcDrops++;
+		return;
+	}
+
+	crc = crcAdd(crcAdd(0xFFFF, hdr, 2), p, n);
+	tracePut(TRC_SYNC0);
+	tracePut(TRC_SYNC1);
+	tracePut(hdr[0]);
+	tracePut(hdr[1]);
+	for (int i = 0; i < n; i++)
+		tracePut(p[i]);
+	tracePut(crc);
+	tracePut(crc >> 8);
+	trcRecs++;
+}
+
+/*------------------------------ traceTick() -------------------------------------------------
+task about to run, replay runs it with the clock and samples as here
+Called by: schedRun(), civService()
+*/
+void traceTick(int task)
+{
+	uint8_t p[9];
+	uint32_t us = micros(), count;
+
+	if (!isTracing)
+		return;
+	noInterrupts();
+	count = sampleCount;
+	interrupts();
+	memcpy(&p[0], &us, 4);
+	memcpy(&p[4], &count, 4);
+	p[8] = task;
+	traceRec(TRC_TICK, p, 9);
+}
+
+/*------------------------------ traceTickOnce() -------------------------------------------------
+tick at first record of a pass that may record several times. *isTick set when written
+*/
+void traceTickOnce(bool* isTick, int task)
+{
+	if (*isTick)
+		return;
+	*isTick = true;
+	traceTick(task);
+}
+
+/*------------------------------ tracePut() -------------------------------------------------
+one byte into trcBuf[], space checked by traceRec()
+*/
+void tracePut(uint8_t b)
+{
+	trcBuf[trcHead] = b;
+	if (++trcHead >= TRC_BUF)
+		trcHead = 0;
+}
+
+/*------------------------------ traceDigest() -------------------------------------------------
+adds drawn value or meter bar to display digest
+Called by: displayValue(), displayMeter()
+*/
+void traceDigest(int posn, const void* data, int n)
+{
+	uint8_t p = posn;
+
+	if (!isTracing)
+		return;
+	dispDigest = crcAdd(crcAdd(dispDigest, &p, 1), (const uint8_t*)data, n);
+}
+
+/*------------------------------ tracePairs() -------------------------------------------------
+records new CH_MAIN sample pairs
+pairs more than WIN_MAX behind getADC() are dropped, getADC() may be overwriting them
+Called by: traceSend(), traceStop()
+*/
+void tracePairs()
+{
+	uint32_t count, avail;
+	int head;
+
+	noInterrupts();
+	count = sampleCount;
+	head = sample;
+	interrupts();
+
+	avail = count - trcCount;
+	if (avail > WIN_MAX)								// too far behind, skip oldest
+	{
+		trcDrops += avail - WIN_MAX;
+		trcCount = count - WIN_MAX;
+		avail = WIN_MAX;
+	}
+
+	while (avail)
+	{
+		uint8_t p[4 + TRC_PAIRS * 4];
+		int n = avail < TRC_PAIRS ? avail : TRC_PAIRS;
+		int pos = head - (int)avail;					// oldest unrecorded pair
+		uint32_t drops = trcDrops;
+
+		if (pos < 0)
+			pos += MAXBUF;
+		memcpy(p, &trcCount, 4);
+		for (int i = 0; i < n; i++)
+		{
+			uint16_t pair[2] = { chan[CH_MAIN].buf1[pos], chan[CH_MAIN].buf0[pos] };
+			memcpy(&p[4 + i * 4], pair, 4);
+			if (++pos >= MAXBUF)
+				pos = 0;
+		}
+		traceRec(TRC_ADC, p, 4 + n * 4);
+		if (trcDrops != drops)
+		{
+			trcDrops = drops;							// buffer full, pairs not lost, recorded next time
+			break;
+		}
+		trcCount += n;
+		avail -= n;
+	}
+}
+
+/*------------------------------ traceSend() -------------------------------------------------
+records new CH_MAIN sample pairs, then sends as much of trcBuf[] as USB takes
+Called by: trace task
+*/
+void traceSend()
+{
+	if (isTracing)
+		tracePairs();
+
+	// send, buffer may wrap
+	while (trcTail != trcHead)
+	{
+		int n = (trcHead > trcTail ? trcHead : TRC_BUF) - trcTail;
+		int room = Serial.availableForWrite();
+
+		if (room <= 0)
+			return;										// link busy, rest next time
+		if (n > room)
+			n = room;
+		Serial.write(&trcBuf[trcTail], n);
+		trcTail += n;
+		if (trcTail >= TRC_BUF)
+			trcTail = 0;
+	}
+}
@@ -63,26 +63,22 @@ void displayTxPwr()
 }
 
 /*-------------------------------- getTxPwr() --------------------------------------------------------
-reads RF Power setting from radio
+reads RF Power setting from radio. last value received
 Returns pwr = 0-255 (0-100%)
 int	civReadTxPwr[] =    { 0x14, 0x0A, 0xFD };			// read RF Power setting
 */
 int getTxPwr()
 {
-	int n;												// chars read into budder
 	unsigned int h = 0, u = 0;							// hundreds, units
-	char inBuff[12];										// civ frequency inBuff buffer
-	int pwr = 0;
+	civSlot* sPtr = civGet(CIV_TXPWR);					// last power setting from radio
+	int n = sPtr->n;									// chars in last reply (9)
 
-	civWrite(civReadTxPwr);								// request read power setting from radio
-	n = civRead(inBuff);								// get number of characters in buffer (9)
-	if (inBuff[3] == CIVRADIO && inBuff[n - 1] == 0xFD)	// check format of serial stream
+	if (n)
 	{
-		h = getBCD(inBuff[n - 3]);						// hundreds, convert from BCD
-		u = getBCD(inBuff[n - 2]);						// units
+		h = getBCD(sPtr->buff[n - 3]);					// hundreds, convert from BCD
+		u = getBCD(sPtr->buff[n - 2]);					// units
 	}
-	pwr = h * 100 + u;									// add hundreds and units to get power
-	return pwr;
+	return h * 100 + u;									// add hundreds and units to get power
 }
 
 /*------------------------------ putTxPwr() -------------------------------
@@ -103,7 +99,7 @@ void putTxPwr(int pwr)
 	civWriteTxPwr[2] = putBCD(h);						// constant expression
 	civWriteTxPwr[3] = putBCD(u);						
 
-	civWrite(civWriteTxPwr);							// write it, 0-255
+	civWriteBack(civWriteTxPwr, CIV_TXPWR);				// write it, 0-255, read back new setting
 }
 
 